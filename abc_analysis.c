@@ -0,0 +1,218 @@
+#include "abc_analysis.h"
+#include <string.h>
+
+// ============================================================================
+// Pitch statistics
+// ============================================================================
+
+void abc_pitch_stats_clear(AbcPitchStats *stats) {
+    if (stats) memset(stats, 0, sizeof(*stats));
+}
+
+int abc_pitch_stats_add(AbcPitchStats *stats, const NotePool *pool) {
+    if (!stats || !pool) return -1;
+
+    // Histogram by MIDI pitch first; rests count in bin 0, which is dropped.
+    // The chord loop's trip count is almost always 1, so it predicts well and
+    // beats a branch-free pass over all ABC_MAX_CHORD_NOTES slots.
+    uint32_t ticks[128];
+    uint32_t counts[128];
+    memset(ticks, 0, sizeof(ticks));
+    memset(counts, 0, sizeof(counts));
+
+    // Follow the list: an edited pool's array also holds spliced-out notes
+    const struct note *notes = pool->notes;
+    uint32_t listed = 0, sounding = 0, total = 0;
+    for (int16_t i = pool->head_index; i >= 0 && i < pool->count; i = notes[i].next_index, listed++) {
+        uint8_t size = notes[i].chord_size;
+        uint8_t duration = notes[i].duration;
+        uint32_t pitched = 0;
+        for (uint8_t j = 0; j < size && j < ABC_MAX_CHORD_NOTES; j++) {
+            uint8_t midi = notes[i].midi_note[j] & 0x7F;
+            ticks[midi] += duration;
+            counts[midi]++;
+            pitched |= midi;
+        }
+        sounding += pitched != 0;
+        total += duration;
+    }
+
+    // Fold into pitch classes and find the ambitus
+    for (uint8_t midi = 1; midi < 128; midi++) {
+        stats->pc_ticks[midi % 12] += ticks[midi];
+        stats->pc_notes[midi % 12] += counts[midi];
+        if (counts[midi] == 0) continue;
+        if (stats->lowest == 0 || midi < stats->lowest) stats->lowest = midi;
+        if (midi > stats->highest) stats->highest = midi;
+    }
+    stats->notes += sounding;
+    stats->rests += listed - sounding;
+    stats->ticks += total;
+    return 0;
+}
+
+int32_t abc_note_density(const NotePool *pool, uint32_t window_ticks, uint16_t *curve, uint32_t max_windows) {
+    if (!pool || window_ticks == 0 || (!curve && max_windows > 0)) return -1;
+    uint16_t spill = 0;
+    if (max_windows > 0) memset(curve, 0, max_windows * sizeof(uint16_t));
+    else curve = &spill;
+
+    // Onsets past max_windows (and rests) add 0 to curve[0]
+    const struct note *notes = pool->notes;
+    uint32_t onset = 0, window = 0, window_end = window_ticks;
+    for (int16_t i = pool->head_index; i >= 0 && i < pool->count; i = notes[i].next_index) {
+        uint8_t size = notes[i].chord_size;
+        uint32_t pitched = 0;
+        for (uint8_t j = 0; j < size && j < ABC_MAX_CHORD_NOTES; j++) pitched |= notes[i].midi_note[j] & 0x7F;
+        uint32_t hit = (pitched != 0) & (window < max_windows);
+        curve[hit ? window : 0] += (uint16_t)hit;
+
+        // Step windows instead of dividing per note
+        onset += notes[i].duration;
+        while (onset >= window_end) {
+            window_end += window_ticks;
+            window++;
+        }
+    }
+    return (int32_t)((onset + window_ticks - 1) / window_ticks);
+}
+
+// ============================================================================
+// Key estimation
+// ============================================================================
+
+// Krumhansl-Kessler probe-tone ratings, tonic first
+static const float major_profile[12] = {
+    6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f
+};
+static const float minor_profile[12] = {
+    6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f
+};
+
+// Newton's method, so the library needs no libm (v > 0)
+static float square_root(float v) {
+    float r = v > 1.0f ? v : 1.0f;
+    for (int i = 0; i < 64; i++) {
+        float next = 0.5f * (r + v / r);
+        if (next >= r) break;               // Converged (iterates fall until then)
+        r = next;
+    }
+    return r;
+}
+
+// Profile minus its mean, and the square root of its sum of squares
+static float center_profile(const float *profile, float *centered) {
+    float mean = 0.0f, squares = 0.0f;
+    for (int i = 0; i < 12; i++) mean += profile[i];
+    mean /= 12.0f;
+    for (int i = 0; i < 12; i++) {
+        centered[i] = profile[i] - mean;
+        squares += centered[i] * centered[i];
+    }
+    return square_root(squares);
+}
+
+int abc_estimate_key(const uint32_t histogram[12], AbcKeyEstimate *key) {
+    if (!histogram || !key) return -1;
+    memset(key, 0, sizeof(*key));
+
+    // Pearson correlation: the histogram's mean and spread are the same for
+    // every key, so only the cross products change with the rotation.
+    // Shares of the total keep the sums near 1 for square_root().
+    // x holds the shares twice so every rotation is a contiguous run.
+    float x[24], total = 0.0f, squares = 0.0f;
+    for (int i = 0; i < 12; i++) total += (float)histogram[i];
+    if (total == 0.0f) return -1;
+    for (int i = 0; i < 12; i++) {
+        x[i] = x[i + 12] = (float)histogram[i] / total - 1.0f / 12.0f;
+        squares += x[i] * x[i];
+    }
+    if (squares < 1e-9f) return -1;     // Every pitch class equally
+
+    float profiles[2][12], norms[2];
+    float spread = square_root(squares);
+    norms[0] = center_profile(major_profile, profiles[0]) * spread;
+    norms[1] = center_profile(minor_profile, profiles[1]) * spread;
+
+    float best = -2.0f, second = -2.0f;
+    for (uint8_t minor = 0; minor < 2; minor++) {
+        for (uint8_t tonic = 0; tonic < 12; tonic++) {
+            float sum = 0.0f;
+            for (uint8_t i = 0; i < 12; i++) sum += x[tonic + i] * profiles[minor][i];
+            float r = sum / norms[minor];
+            if (r > best) {
+                second = best;
+                best = r;
+                key->tonic = tonic;
+                key->minor = minor;
+            } else if (r > second) {
+                second = r;
+            }
+        }
+    }
+    key->correlation = best;
+    key->margin = best - second;
+    return 0;
+}
+
+// ============================================================================
+// Key names
+// ============================================================================
+
+int abc_key_parse(const char *key, uint8_t *tonic, uint8_t *minor) {
+    // Semitones above C of the letters A to G
+    static const uint8_t letter_pc[7] = { 9, 11, 0, 2, 4, 5, 7 };
+    if (!key || !tonic || !minor) return -1;
+    while (*key == ' ') key++;
+
+    char letter = *key;
+    if (letter >= 'a' && letter <= 'g') letter = (char)(letter - 'a' + 'A');
+    if (letter < 'A' || letter > 'G') return -1;
+    int pc = letter_pc[letter - 'A'];
+    key++;
+    if (*key == '#') { pc++; key++; }
+    else if (*key == 'b') { pc--; key++; }
+    while (*key == ' ') key++;
+
+    // Mode: first three letters, any case ("m" alone is minor)
+    char mode[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3 && key[i] != '\0'; i++) {
+        char c = key[i];
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if (c < 'a' || c > 'z') break;
+        mode[i] = c;
+    }
+    *minor = 0;
+    if (mode[0] == 'm' && (mode[1] == '\0' || (mode[1] == 'i' && mode[2] == 'n'))) *minor = 1;
+    if (strncmp(mode, "aeo", 3) == 0 || strncmp(mode, "dor", 3) == 0 ||
+        strncmp(mode, "phr", 3) == 0 || strncmp(mode, "loc", 3) == 0) *minor = 1;
+
+    *tonic = (uint8_t)((pc + 12) % 12);
+    return 0;
+}
+
+const char *abc_key_name(uint8_t tonic, uint8_t minor) {
+    static const char *const major_names[12] = {
+        "C", "Db", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B"
+    };
+    static const char *const minor_names[12] = {
+        "Cm", "C#m", "Dm", "Ebm", "Em", "Fm", "F#m", "Gm", "G#m", "Am", "Bbm", "Bm"
+    };
+    return minor ? minor_names[tonic % 12] : major_names[tonic % 12];
+}
+
+// ============================================================================
+// Batch
+// ============================================================================
+
+int abc_analyze_sheets(const struct sheet *sheets, uint32_t count, AbcPitchStats *stats, AbcKeyEstimate *keys) {
+    if (count > 0 && (!sheets || !stats)) return -1;
+    for (uint32_t s = 0; s < count; s++) {
+        abc_pitch_stats_clear(&stats[s]);
+        uint8_t voices = sheets[s].voice_count;
+        if (voices > sheets[s].pool_count) voices = sheets[s].pool_count;
+        for (uint8_t v = 0; v < voices; v++) abc_pitch_stats_add(&stats[s], &sheets[s].pools[v]);
+        if (keys) abc_estimate_key(stats[s].pc_ticks, &keys[s]);
+    }
+    return 0;
+}
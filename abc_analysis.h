@@ -0,0 +1,68 @@
+#ifndef ABC_ANALYSIS_H
+#define ABC_ANALYSIS_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Analysis - pitch histograms, ambitus, note density and key estimation
+// ============================================================================
+//
+// Like the bulk transforms, the kernels make one tight pass over a pool,
+// following the notes' next_index links in play order with no per-note
+// function calls (pools edited with abc_editor keep spliced-out notes in the
+// array, off the list). They are cheap enough to run over whole collections:
+// parse each tune, then add its pools.
+//
+// Key estimation correlates a duration-weighted pitch-class histogram with
+// the Krumhansl-Kessler major and minor key profiles in all twelve
+// transpositions, and picks the best of the 24 keys. Compare the result with
+// the tune's K: field through abc_key_parse().
+
+typedef struct {
+    uint32_t pc_ticks[12];      // Ticks sounding per pitch class (C = 0); every chord note counts
+    uint32_t pc_notes[12];      // Notes per pitch class
+    uint32_t notes;             // Notes and chords
+    uint32_t rests;
+    uint32_t ticks;             // Total duration, rests included
+    uint8_t lowest;             // Ambitus: lowest and highest MIDI pitch (0 = no pitches yet)
+    uint8_t highest;
+} AbcPitchStats;
+
+typedef struct {
+    uint8_t tonic;              // Pitch class (C = 0)
+    uint8_t minor;              // 1 = minor, 0 = major
+    float correlation;          // Best key profile's correlation with the histogram (-1 to 1)
+    float margin;               // Lead over the second-best key (small = ambiguous)
+} AbcKeyEstimate;
+
+// Reset stats to empty
+void abc_pitch_stats_clear(AbcPitchStats *stats);
+
+// Add a pool's notes to stats (add every voice of a tune to combine them)
+// Returns 0 on success, -1 on invalid arguments
+int abc_pitch_stats_add(AbcPitchStats *stats, const NotePool *pool);
+
+// Density curve: note and chord onsets in each window of window_ticks
+// (rests not counted). Fills up to max_windows entries of curve.
+// Returns the number of windows the pool spans, or -1 on invalid arguments
+int32_t abc_note_density(const NotePool *pool, uint32_t window_ticks, uint16_t *curve, uint32_t max_windows);
+
+// Most likely key for a pitch-class histogram (usually stats.pc_ticks)
+// Returns 0 on success, -1 on invalid arguments or an empty histogram
+int abc_estimate_key(const uint32_t histogram[12], AbcKeyEstimate *key);
+
+// Tonic and major/minor of a K: value ("G", "F#m", "Bb", "Ador", "Emin", ...)
+// Modes with a minor third (aeolian, dorian, phrygian, locrian) count as minor.
+// Returns 0 on success, -1 if the text does not start with a key letter
+int abc_key_parse(const char *key, uint8_t *tonic, uint8_t *minor);
+
+// Conventional name of a key ("C", "F#", "Bb", "Am", "C#m", ...)
+const char *abc_key_name(uint8_t tonic, uint8_t minor);
+
+// Batch: stats (all voices) and, if keys is not NULL, the key estimate of
+// each sheet. A sheet without pitches gets a zeroed estimate.
+// Returns 0 on success, -1 on invalid arguments
+int abc_analyze_sheets(const struct sheet *sheets, uint32_t count, AbcPitchStats *stats, AbcKeyEstimate *keys);
+
+#endif // ABC_ANALYSIS_H
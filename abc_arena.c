@@ -0,0 +1,74 @@
+#include "abc_arena.h"
+#include <stdint.h>
+#include <string.h>
+
+#define ARENA_MIN_NOTES 16
+
+// Offset of the first 8-byte aligned address at or after base + offset
+static uint32_t arena_align(const AbcArena *arena, uint32_t offset) {
+    uintptr_t addr = (uintptr_t)(arena->base + offset);
+    return offset + (uint32_t)((8 - (addr & 7)) & 7);
+}
+
+// Pool growth: extend the newest block in place, otherwise move to a new block
+// with doubled capacity (the old block is reclaimed by the next reset)
+static struct note *arena_grow(void *ctx, struct note *old, uint16_t used,
+                               uint16_t min_capacity, uint16_t *capacity) {
+    AbcArena *arena = (AbcArena *)ctx;
+    uint32_t want = (uint32_t)used * 2;
+    if (want < ARENA_MIN_NOTES) want = ARENA_MIN_NOTES;
+    if (want < min_capacity) want = min_capacity;
+    if (want > 0x7FFF) want = 0x7FFF;
+
+    uint32_t bytes = want * (uint32_t)sizeof(struct note);
+    if (old && (uint8_t *)old == arena->base + arena->last &&
+        arena->last + bytes <= arena->size) {
+        arena->used = arena->last + bytes;
+        *capacity = (uint16_t)want;
+        return old;
+    }
+
+    struct note *notes = (struct note *)abc_arena_alloc(arena, bytes);
+    if (!notes) return NULL;
+    if (old && used > 0) memcpy(notes, old, (size_t)used * sizeof(struct note));
+    *capacity = (uint16_t)want;
+    return notes;
+}
+
+void abc_arena_init(AbcArena *arena, void *buffer, uint32_t size) {
+    if (!arena) return;
+    arena->base = (uint8_t *)buffer;
+    arena->size = buffer ? size : 0;
+    arena->used = 0;
+    arena->last = 0;
+    arena->allocator.grow = arena_grow;
+    arena->allocator.ctx = arena;
+}
+
+void *abc_arena_alloc(AbcArena *arena, uint32_t size) {
+    if (!arena || !arena->base) return NULL;
+    uint32_t start = arena_align(arena, arena->used);
+    if (start > arena->size || size > arena->size - start) return NULL;
+    arena->last = start;
+    arena->used = start + size;
+    return arena->base + start;
+}
+
+void abc_arena_reset(AbcArena *arena) {
+    if (!arena) return;
+    arena->used = 0;
+    arena->last = 0;
+}
+
+int abc_arena_sheet_init(AbcArena *arena, struct sheet *sheet, uint8_t pool_count,
+                         uint8_t max_chord_notes) {
+    if (!arena || !sheet || pool_count == 0) return -1;
+    NotePool *pools = (NotePool *)abc_arena_alloc(arena, (uint32_t)pool_count * sizeof(NotePool));
+    if (!pools) return -2;
+    for (uint8_t i = 0; i < pool_count; i++) {
+        note_pool_init(&pools[i], NULL, 0, max_chord_notes);
+        note_pool_set_allocator(&pools[i], &arena->allocator);
+    }
+    sheet_init(sheet, pools, pool_count);
+    return 0;
+}
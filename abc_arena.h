@@ -0,0 +1,40 @@
+#ifndef ABC_ARENA_H
+#define ABC_ARENA_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Arena allocator
+// ============================================================================
+//
+// Bump allocator over one caller-provided buffer. Sheets whose pool headers
+// and notes live in an arena are released all at once with abc_arena_reset(),
+// which makes it a good fit for per-request parsing in a server: allocate one
+// large buffer up front, parse into it, reset after the request.
+// No malloc is involved; the library still never allocates on its own.
+
+typedef struct {
+    uint8_t *base;          // Caller-provided buffer
+    uint32_t size;          // Buffer size in bytes
+    uint32_t used;          // Bytes handed out so far
+    uint32_t last;          // Offset of the most recent allocation (grown in place)
+    AbcAllocator allocator; // Pool allocator backed by this arena
+} AbcArena;
+
+// Initialize an arena over buffer (any alignment; allocations are 8-byte aligned)
+void abc_arena_init(AbcArena *arena, void *buffer, uint32_t size);
+
+// Allocate size bytes (8-byte aligned), NULL when the arena is full
+void *abc_arena_alloc(AbcArena *arena, uint32_t size);
+
+// Release everything allocated from the arena in O(1)
+void abc_arena_reset(AbcArena *arena);
+
+// Set up a sheet whose pool headers and notes are all allocated from the arena
+// Pools start empty and grow on demand while parsing
+// Returns 0 on success, -1 on NULL input, -2 if the arena is full
+int abc_arena_sheet_init(AbcArena *arena, struct sheet *sheet, uint8_t pool_count,
+                         uint8_t max_chord_notes);
+
+#endif // ABC_ARENA_H
@@ -0,0 +1,331 @@
+#include "abc_cache.h"
+#include <string.h>
+
+#define NIL 0xFFFF
+
+// ============================================================================
+// Hashing
+// ============================================================================
+
+static uint64_t load_u64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// MurmurHash64A: eight bytes per step, good avalanche, no tables
+uint64_t abc_hash64(const void *data, uint32_t len, uint64_t seed) {
+    const uint64_t m = 0xC6A4A7935BD1E995ull;
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t h = seed ^ ((uint64_t)len * m);
+
+    for (uint32_t blocks = len / 8; blocks > 0; blocks--, p += 8) {
+        uint64_t k = load_u64(p);
+        k *= m;
+        k ^= k >> 47;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    switch (len & 7) {
+        case 7: h ^= (uint64_t)p[6] << 48; // fall through
+        case 6: h ^= (uint64_t)p[5] << 40; // fall through
+        case 5: h ^= (uint64_t)p[4] << 32; // fall through
+        case 4: h ^= (uint64_t)p[3] << 24; // fall through
+        case 3: h ^= (uint64_t)p[2] << 16; // fall through
+        case 2: h ^= (uint64_t)p[1] << 8;  // fall through
+        case 1: h ^= (uint64_t)p[0];
+                h *= m;
+                break;
+        default: break;
+    }
+
+    h ^= h >> 47;
+    h *= m;
+    h ^= h >> 47;
+    return h;
+}
+
+// The parser reads at most 0xFFFF bytes, so the key covers exactly those
+static uint16_t input_length(const char *abc) {
+    uint16_t len = 0;
+    while (abc[len] && len < 0xFFFF) len++;
+    return len;
+}
+
+static uint64_t cache_key(const char *abc, uint16_t len, uint8_t max_chord_notes, uint8_t pool_count) {
+    return abc_hash64(abc, len, ((uint64_t)pool_count << 8) | max_chord_notes);
+}
+
+// ============================================================================
+// Locking, hash index and LRU list (all called with the lock held)
+// ============================================================================
+
+static void cache_lock(AbcCache *cache) {
+    if (cache->lock.lock) cache->lock.lock(cache->lock.ctx);
+}
+
+static void cache_unlock(AbcCache *cache) {
+    if (cache->lock.unlock) cache->lock.unlock(cache->lock.ctx);
+}
+
+static uint16_t home_bucket(const AbcCache *cache, uint64_t hash) {
+    return (uint16_t)(hash & (uint64_t)(cache->capacity - 1));
+}
+
+// Hashes can collide, so a match also compares the stored input text
+static uint16_t index_find(const AbcCache *cache, uint64_t hash, const char *abc, uint16_t len) {
+    uint16_t mask = (uint16_t)(cache->capacity - 1);
+    for (uint16_t b = home_bucket(cache, hash); cache->entries[b].bucket != NIL; b = (uint16_t)((b + 1) & mask)) {
+        const AbcCacheEntry *e = &cache->entries[cache->entries[b].bucket];
+        if (e->hash != hash || e->len != len) continue;
+        const char *text = abc_store_string(cache->store, e->text, NULL);
+        if (len == 0 || memcmp(text, abc, len) == 0) return cache->entries[b].bucket;
+    }
+    return NIL;
+}
+
+static void index_insert(AbcCache *cache, uint16_t slot) {
+    uint16_t mask = (uint16_t)(cache->capacity - 1);
+    uint16_t b = home_bucket(cache, cache->entries[slot].hash);
+    while (cache->entries[b].bucket != NIL) b = (uint16_t)((b + 1) & mask);
+    cache->entries[b].bucket = slot;
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+static void index_remove(AbcCache *cache, uint16_t slot) {
+    uint16_t mask = (uint16_t)(cache->capacity - 1);
+    uint16_t i = home_bucket(cache, cache->entries[slot].hash);
+    while (cache->entries[i].bucket != slot) i = (uint16_t)((i + 1) & mask);
+
+    for (uint16_t j = (uint16_t)((i + 1) & mask); cache->entries[j].bucket != NIL; j = (uint16_t)((j + 1) & mask)) {
+        uint16_t k = home_bucket(cache, cache->entries[cache->entries[j].bucket].hash);
+        // Move j back into the hole unless its home lies cyclically in (i, j]
+        int stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            cache->entries[i].bucket = cache->entries[j].bucket;
+            i = j;
+        }
+    }
+    cache->entries[i].bucket = NIL;
+}
+
+static void lru_unlink(AbcCache *cache, uint16_t slot) {
+    AbcCacheEntry *e = &cache->entries[slot];
+    if (e->prev != NIL) cache->entries[e->prev].next = e->next;
+    else cache->lru_head = e->next;
+    if (e->next != NIL) cache->entries[e->next].prev = e->prev;
+    else cache->lru_tail = e->prev;
+}
+
+static void lru_push_front(AbcCache *cache, uint16_t slot) {
+    AbcCacheEntry *e = &cache->entries[slot];
+    e->prev = NIL;
+    e->next = cache->lru_head;
+    if (cache->lru_head != NIL) cache->entries[cache->lru_head].prev = slot;
+    else cache->lru_tail = slot;
+    cache->lru_head = slot;
+}
+
+static void lru_touch(AbcCache *cache, uint16_t slot) {
+    if (cache->lru_head == slot) return;
+    lru_unlink(cache, slot);
+    lru_push_front(cache, slot);
+}
+
+static void entry_drop(AbcCache *cache, uint16_t slot) {
+    AbcCacheEntry *e = &cache->entries[slot];
+    index_remove(cache, slot);
+    lru_unlink(cache, slot);
+    abc_store_remove(cache->store, e->handle);
+    abc_store_release(cache->store, e->text);
+    cache->bytes -= e->bytes;
+    cache->count--;
+
+    e->handle = ABC_STORE_INVALID;
+    e->next = cache->free_head;
+    cache->free_head = slot;
+}
+
+static uint16_t lru_victim(const AbcCache *cache) {
+    uint16_t slot = cache->lru_tail;
+    while (slot != NIL && cache->entries[slot].pins > 0) slot = cache->entries[slot].prev;
+    return slot;
+}
+
+// Evict the least recently used unpinned entry; returns 0 if there was none
+static int evict_one(AbcCache *cache) {
+    uint16_t slot = lru_victim(cache);
+    if (slot == NIL) return 0;
+    entry_drop(cache, slot);
+    cache->evictions++;
+    return 1;
+}
+
+static void cache_insert(AbcCache *cache, uint64_t hash, const char *abc, uint16_t len, const struct sheet *sheet) {
+    if (index_find(cache, hash, abc, len) != NIL) return;  // Another thread got there first
+
+    // Keep the index at most 3/4 full so probe chains stay short
+    while (cache->count >= cache->capacity - cache->capacity / 4) {
+        if (!evict_one(cache)) return;
+    }
+
+    uint16_t text = abc_store_intern(cache->store, abc, len);
+    while (text == ABC_STORE_NO_STRING) {
+        if (!evict_one(cache)) return;
+        text = abc_store_intern(cache->store, abc, len);
+    }
+    AbcStoreHandle handle = abc_store_add(cache->store, sheet);
+    while (handle == ABC_STORE_INVALID) {
+        if (!evict_one(cache)) {
+            abc_store_release(cache->store, text);
+            return;
+        }
+        handle = abc_store_add(cache->store, sheet);
+    }
+
+    uint16_t slot = cache->free_head;
+    AbcCacheEntry *e = &cache->entries[slot];
+    cache->free_head = e->next;
+    e->hash = hash;
+    e->len = len;
+    e->text = text;
+    e->handle = handle;
+    e->bytes = abc_store_sheet_bytes(cache->store, handle) + len;
+    e->pins = 0;
+    index_insert(cache, slot);
+    lru_push_front(cache, slot);
+    cache->count++;
+    cache->bytes += e->bytes;
+
+    while (cache->budget > 0 && cache->bytes > cache->budget) {
+        if (!evict_one(cache)) break;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+int abc_cache_init(AbcCache *cache, AbcStore *store, AbcCacheEntry *entries,
+                   uint16_t capacity, uint32_t budget, const AbcCacheLock *lock) {
+    if (!cache || !store || !entries || capacity < 4 || (capacity & (capacity - 1)) != 0) return -1;
+
+    cache->store = store;
+    cache->entries = entries;
+    cache->capacity = capacity;
+    cache->count = 0;
+    cache->lru_head = NIL;
+    cache->lru_tail = NIL;
+    cache->budget = budget;
+    cache->bytes = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    cache->lock = lock ? *lock : (AbcCacheLock){ NULL, NULL, NULL };
+
+    // Every slot starts on the free list with an empty bucket
+    for (uint16_t i = 0; i < capacity; i++) {
+        entries[i].handle = ABC_STORE_INVALID;
+        entries[i].bucket = NIL;
+        entries[i].pins = 0;
+        entries[i].next = (uint16_t)(i + 1 < capacity ? i + 1 : NIL);
+    }
+    cache->free_head = 0;
+    return 0;
+}
+
+int abc_cache_parse(AbcCache *cache, struct sheet *sheet, const char *abc) {
+    if (!cache || !sheet || !abc || !sheet->pools || sheet->pool_count == 0) return -1;
+
+    sheet_reset(sheet);
+    uint8_t max_chord = sheet->pools[0].max_chord_notes;
+    for (uint8_t v = 1; v < sheet->pool_count; v++) {
+        if (sheet->pools[v].max_chord_notes != max_chord) return abc_parse(sheet, abc);
+    }
+
+    // Longer inputs are truncated by the parser and cannot be stored as keys
+    uint16_t len = input_length(abc);
+    if (len == 0xFFFF) return abc_parse(sheet, abc);
+    uint64_t hash = cache_key(abc, len, max_chord, sheet->pool_count);
+
+    cache_lock(cache);
+    uint16_t slot = index_find(cache, hash, abc, len);
+    if (slot != NIL && abc_store_copy(cache->store, cache->entries[slot].handle, sheet) == 0) {
+        lru_touch(cache, slot);
+        cache->hits++;
+        cache_unlock(cache);
+        return 0;
+    }
+    cache->misses++;
+    cache_unlock(cache);
+
+    // Parse outside the lock so other threads keep hitting meanwhile
+    int result = abc_parse(sheet, abc);
+    if (result < 0) return result;
+
+    cache_lock(cache);
+    cache_insert(cache, hash, abc, len, sheet);
+    cache_unlock(cache);
+    return result;
+}
+
+int32_t abc_cache_acquire(AbcCache *cache, const char *abc, uint8_t max_chord_notes,
+                          struct sheet *view, NotePool *pools, uint8_t pool_count) {
+    if (!cache || !abc || !view || !pools || pool_count == 0) return -1;
+
+    uint16_t len = input_length(abc);
+    if (len == 0xFFFF) return -1;
+    uint64_t hash = cache_key(abc, len, max_chord_notes, pool_count);
+
+    cache_lock(cache);
+    uint16_t slot = index_find(cache, hash, abc, len);
+    if (slot == NIL) {
+        cache->misses++;
+        cache_unlock(cache);
+        return -1;
+    }
+    if (abc_store_view(cache->store, cache->entries[slot].handle, view, pools, pool_count) < 0) {
+        cache_unlock(cache);
+        return -2;
+    }
+    // Pinned: not evicted, and the store may not compact under the view
+    cache->entries[slot].pins++;
+    cache->store->compact_locks++;
+    lru_touch(cache, slot);
+    cache->hits++;
+    cache_unlock(cache);
+    return (int32_t)slot + 1;
+}
+
+void abc_cache_release(AbcCache *cache, int32_t token) {
+    if (!cache || token <= 0 || token > cache->capacity) return;
+    cache_lock(cache);
+    AbcCacheEntry *e = &cache->entries[token - 1];
+    if (e->handle != ABC_STORE_INVALID && e->pins > 0) {
+        e->pins--;
+        cache->store->compact_locks--;
+    }
+    cache_unlock(cache);
+}
+
+void abc_cache_clear(AbcCache *cache) {
+    if (!cache) return;
+    cache_lock(cache);
+    for (uint16_t slot = lru_victim(cache); slot != NIL; slot = lru_victim(cache)) {
+        entry_drop(cache, slot);
+    }
+    cache_unlock(cache);
+}
+
+void abc_cache_stats(AbcCache *cache, AbcCacheStats *stats) {
+    if (!cache || !stats) return;
+    cache_lock(cache);
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->evictions = cache->evictions;
+    stats->entries = cache->count;
+    stats->bytes = cache->bytes;
+    cache_unlock(cache);
+}
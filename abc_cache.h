@@ -0,0 +1,112 @@
+#ifndef ABC_CACHE_H
+#define ABC_CACHE_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+#include "abc_store.h"
+
+// ============================================================================
+// Parse cache - content-addressed, LRU, built on the sheet store
+// ============================================================================
+//
+// Many requests parse the same few tunes. The cache keys parsed sheets by a
+// 64-bit hash of the input bytes and the parse options (chord limit and pool
+// count), so a repeated parse costs one hash over the text plus one memcpy
+// per voice instead of a full parse. Each entry also keeps its input text as
+// an interned string in the store, and a hit requires the bytes to match, so
+// hash collisions cost a miss, never a wrong sheet. Inputs of 0xFFFF bytes
+// or more bypass the cache.
+//
+//   - results live in a caller-provided AbcStore; entries are evicted least
+//     recently used first once the bytes they occupy exceed the budget
+//   - abc_cache_parse() copies the result into the caller's pools
+//   - abc_cache_acquire() returns a read-only view straight into the store;
+//     acquired entries are pinned (never evicted or moved) until released
+//
+// For use from several threads, pass lock callbacks: every operation on the
+// shared tables runs under the lock, while hashing, parsing on a miss and
+// reading acquired views run outside it.
+
+// Optional mutual exclusion (e.g. a pthread mutex or a spinlock)
+typedef struct {
+    void (*lock)(void *ctx);
+    void (*unlock)(void *ctx);
+    void *ctx;
+} AbcCacheLock;
+
+// One slot of the caller-provided table. Slot i holds an entry and, separately,
+// bucket i of the hash index, so entries never move while they are pinned.
+typedef struct {
+    uint64_t hash;              // Key: hash of input bytes and parse options
+    AbcStoreHandle handle;      // Stored sheet (ABC_STORE_INVALID = free slot)
+    uint32_t bytes;             // Note block and input text bytes charged to the budget
+    uint16_t len;               // Input length (checked along with the hash)
+    uint16_t text;              // Interned input text, compared on a hit
+    uint16_t prev;              // LRU neighbours, or free list link (0xFFFF = none)
+    uint16_t next;
+    uint16_t pins;              // Outstanding acquires
+    uint16_t bucket;            // Hash index: slot of the entry in bucket i (0xFFFF = empty)
+} AbcCacheEntry;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t entries;           // Live entries
+    uint32_t bytes;             // Note block and input text bytes held by live entries
+} AbcCacheStats;
+
+typedef struct {
+    AbcStore *store;
+    AbcCacheEntry *entries;     // Entries plus a linear-probing index over them
+    uint16_t capacity;          // Power of two; at most 3/4 of it is used
+    uint16_t count;
+    uint16_t free_head;
+    uint16_t lru_head;          // Most recently used
+    uint16_t lru_tail;          // Least recently used
+    uint32_t budget;            // Byte budget for stored sheets
+    uint32_t bytes;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    AbcCacheLock lock;
+} AbcCache;
+
+// Initialize a cache over an initialized, empty store
+// entries: caller-provided table, capacity a power of two
+// budget: maximum note block and input text bytes to keep (0 = limited only
+//         by the store); header strings are shared and not charged
+// The store's string table holds one input text per entry on top of the
+// sheets' header strings; size string_capacity for both
+// lock: NULL for single-threaded use
+// Returns 0 on success, -1 on invalid arguments
+int abc_cache_init(AbcCache *cache, AbcStore *store, AbcCacheEntry *entries,
+                   uint16_t capacity, uint32_t budget, const AbcCacheLock *lock);
+
+// Parse through the cache: same return codes as abc_parse()
+// The sheet is reset first. On a hit the stored result is copied into the
+// sheet's pools; on a miss the tune is parsed into them and then added to the
+// cache (if it fits). Sheets whose pools differ in max_chord_notes bypass it.
+int abc_cache_parse(AbcCache *cache, struct sheet *sheet, const char *abc);
+
+// Look up a cached tune without parsing
+// max_chord_notes, pool_count: as the sheet it was parsed with
+// On a hit fills a read-only view (pools point into the store, capacity 0)
+// and pins the entry. Returns a token > 0 for abc_cache_release(), -1 on a
+// miss, -2 if pool_count is too small for the cached sheet.
+int32_t abc_cache_acquire(AbcCache *cache, const char *abc, uint8_t max_chord_notes,
+                          struct sheet *view, NotePool *pools, uint8_t pool_count);
+
+// Unpin an acquired entry; the view must not be used afterwards
+void abc_cache_release(AbcCache *cache, int32_t token);
+
+// Drop every unpinned entry
+void abc_cache_clear(AbcCache *cache);
+
+// Snapshot of the counters
+void abc_cache_stats(AbcCache *cache, AbcCacheStats *stats);
+
+// Fast 64-bit hash used for cache keys
+uint64_t abc_hash64(const void *data, uint32_t len, uint64_t seed);
+
+#endif // ABC_CACHE_H
@@ -0,0 +1,158 @@
+#include "abc_corpus.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Random numbers and output
+// ============================================================================
+
+typedef struct {
+    char *buf;
+    uint32_t size;
+    uint32_t len;
+    int overflow;
+    uint32_t rng;
+} Writer;
+
+// xorshift32: tiny, fast and identical on every platform
+static uint32_t next_random(Writer *w) {
+    uint32_t x = w->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return w->rng = x;
+}
+
+static uint32_t pick(Writer *w, uint32_t n) {
+    return next_random(w) % n;
+}
+
+static int chance(Writer *w, uint8_t pct) {
+    return pick(w, 100) < pct;
+}
+
+static void put(Writer *w, const char *text) {
+    size_t n = strlen(text);
+    if (w->len + n >= w->size) {
+        w->overflow = 1;
+        return;
+    }
+    memcpy(w->buf + w->len, text, n + 1);
+    w->len += (uint32_t)n;
+}
+
+// ============================================================================
+// Music
+// ============================================================================
+
+static void put_pitch(Writer *w, const AbcCorpusConfig *config) {
+    static const char *accidentals[] = { "^", "_", "=", "^^", "__" };
+    static const char *octaves[] = { "", "", "", "'", "," };
+    char letter[2] = { "CDEFGABcdefgab"[pick(w, 14)], '\0' };
+
+    if (chance(w, config->accidental_pct)) put(w, accidentals[pick(w, 5)]);
+    put(w, letter);
+    put(w, octaves[pick(w, 5)]);
+}
+
+// One note, rest or chord lasting `units` eighths
+static void put_note(Writer *w, const AbcCorpusConfig *config, int units) {
+    static const char *annotations[] = { "\"Am\"", "\"G7\"", "\"^rit.\"", "~", ".", "(" };
+
+    int noisy = chance(w, config->noise_pct);
+    if (noisy) put(w, annotations[pick(w, 6)]);
+
+    if (pick(w, 20) == 0) {
+        put(w, "z");
+    } else if (chance(w, config->chord_pct)) {
+        int size = 2 + (int)pick(w, (uint32_t)(config->max_chord - 1));
+        put(w, "[");
+        for (int i = 0; i < size; i++) put_pitch(w, config);
+        put(w, "]");
+    } else {
+        put_pitch(w, config);
+    }
+
+    if (units == 2) put(w, "2");
+    if (noisy) put(w, pick(w, 2) ? ")" : "-");  // Close the slur or tie into the next note
+    put(w, " ");
+}
+
+// One 4/4 bar of eighths (L:1/8)
+static void put_bar(Writer *w, const AbcCorpusConfig *config) {
+    for (int units = 8; units > 0;) {
+        if (units >= 2 && chance(w, config->tuplet_pct)) {
+            put(w, "(3");
+            for (int i = 0; i < 3; i++) put_note(w, config, 1);
+            units -= 2;
+        } else {
+            int length = (units >= 2 && pick(w, 3) == 0) ? 2 : 1;
+            put_note(w, config, length);
+            units -= length;
+        }
+    }
+    put(w, "| ");
+}
+
+static void put_voice(Writer *w, const AbcCorpusConfig *config) {
+    uint16_t section = config->repeat_bars ? config->repeat_bars : 1;
+    for (uint16_t bar = 0; bar < config->bars;) {
+        int repeat = chance(w, config->repeat_pct);
+        if (repeat) put(w, "|: ");
+        for (uint16_t i = 0; i < section && bar < config->bars; i++, bar++) {
+            put_bar(w, config);
+            if (bar % 4 == 3) put(w, "\n");
+        }
+        if (repeat) put(w, ":| ");
+    }
+    put(w, "|]\n");
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void abc_corpus_defaults(AbcCorpusConfig *config) {
+    if (!config) return;
+    config->seed = 1;
+    config->tunes = 0;
+    config->voices = 1;
+    config->bars = 32;
+    config->chord_pct = 10;
+    config->max_chord = 3;
+    config->tuplet_pct = 5;
+    config->accidental_pct = 10;
+    config->repeat_pct = 25;
+    config->repeat_bars = 4;
+    config->noise_pct = 5;
+}
+
+int32_t abc_corpus_tune(const AbcCorpusConfig *config, uint32_t index, char *buf, uint32_t size) {
+    if (!config || !buf || size == 0) return -1;
+    if (config->voices == 0 || config->voices > ABC_CORPUS_MAX_VOICES) return -1;
+    if (config->max_chord < 2 || config->max_chord > 4) return -1;
+    if (config->tunes != 0 && index >= config->tunes) return -1;
+
+    // Mix seed and index so neighbouring tunes are unrelated (never 0 for xorshift)
+    uint32_t mixed = config->seed * 0x9E3779B9u ^ (index + 1) * 0x85EBCA6Bu;
+    mixed ^= mixed >> 16;
+    Writer w = { buf, size, 0, 0, mixed ? mixed : 1 };
+    buf[0] = '\0';
+
+    static const char *keys[] = { "C", "G", "D", "F", "Bb", "Am", "Em", "Dm" };
+    char header[96];
+    snprintf(header, sizeof(header), "X:%lu\nT:Corpus %lu-%lu\nM:4/4\nL:1/8\nQ:1/4=%u\nK:%s\n",
+             (unsigned long)(index + 1), (unsigned long)config->seed, (unsigned long)index,
+             80 + pick(&w, 100), keys[pick(&w, 8)]);
+    put(&w, header);
+
+    for (uint8_t v = 0; v < config->voices; v++) {
+        if (config->voices > 1) {
+            char voice[16];
+            snprintf(voice, sizeof(voice), "V:%u\n", v + 1);
+            put(&w, voice);
+        }
+        put_voice(&w, config);
+    }
+    return w.overflow ? -2 : (int32_t)w.len;
+}
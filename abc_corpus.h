@@ -0,0 +1,40 @@
+#ifndef ABC_CORPUS_H
+#define ABC_CORPUS_H
+
+#include <stdint.h>
+
+// ============================================================================
+// Synthetic corpus generator - deterministic ABC tunes for tests and benchmarks
+// ============================================================================
+//
+// Produces valid ABC text with tunable voices, chord density, tuplets,
+// accidentals, repeats and annotation noise. Tune i of a corpus depends only
+// on (seed, i) and the knobs, so any tune can be regenerated on its own and
+// results are reproducible across machines. Host-side tooling only: it is
+// not part of the abc_parser library.
+
+#define ABC_CORPUS_MAX_VOICES 16
+
+typedef struct {
+    uint32_t seed;
+    uint32_t tunes;             // Tunes in the corpus: indexes 0..tunes-1 (0 = no limit)
+    uint8_t voices;             // Voices per tune (1..ABC_CORPUS_MAX_VOICES)
+    uint16_t bars;              // Bars per voice, before repeats
+    uint8_t chord_pct;          // Notes that are chords (percent)
+    uint8_t max_chord;          // Notes per chord (2..4)
+    uint8_t tuplet_pct;         // Beats played as triplets (percent)
+    uint8_t accidental_pct;     // Notes with an explicit accidental (percent)
+    uint8_t repeat_pct;         // Sections wrapped in |: :| (percent)
+    uint8_t repeat_bars;        // Bars per section (longer = deeper repeats)
+    uint8_t noise_pct;          // Notes with annotations, slurs or decorations (percent)
+} AbcCorpusConfig;
+
+// Fill in moderate defaults: one 32-bar voice, a little of everything, no tune limit
+void abc_corpus_defaults(AbcCorpusConfig *config);
+
+// Write tune `index` into buf (NUL-terminated)
+// Returns its length, -1 on invalid arguments or an index past config->tunes,
+// -2 if it does not fit in size
+int32_t abc_corpus_tune(const AbcCorpusConfig *config, uint32_t index, char *buf, uint32_t size);
+
+#endif // ABC_CORPUS_H
@@ -0,0 +1,187 @@
+// abcembed - build-time ABC to C compiler
+//
+// Parses an .abc file on the host and writes a C source/header pair with
+// const note arrays (placed in flash on most toolchains) and a ready-to-use
+// struct sheet. The firmware then needs no parser call and no note storage
+// beyond what the tune actually uses.
+//
+// Usage: abcembed <input.abc> <output.c> <output.h> <symbol>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "abc_parser.h"
+
+#define EMBED_MAX_VOICES 32
+#define EMBED_MAX_NOTES 32767  // Largest pool addressable by int16_t indices
+
+static char *read_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < 0 || size >= 0xFFFF) { fclose(f); return NULL; }
+
+    char *buf = malloc((size_t)size + 1);
+    if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size) { free(buf); buf = NULL; }
+    if (buf) buf[size] = '\0';
+    fclose(f);
+    return buf;
+}
+
+// Write a C string literal, escaping anything that is not plain printable ASCII
+static void write_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20 || c > 0x7E) fprintf(out, "\\%03o", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+static void write_header(FILE *out, const char *symbol, const char *source) {
+    char guard[64];
+    size_t i = 0;
+    for (; symbol[i] && i < sizeof(guard) - 3; i++) {
+        guard[i] = (symbol[i] >= 'a' && symbol[i] <= 'z') ? (char)(symbol[i] - 32) : symbol[i];
+    }
+    memcpy(guard + i, "_H", 3);
+
+    fprintf(out, "// Generated by abcembed from %s - do not edit\n", source);
+    fprintf(out, "#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(out, "#include \"abc_parser.h\"\n\n");
+    fprintf(out, "// Pre-parsed sheet; its pools are read-only (capacity 0)\n");
+    fprintf(out, "extern struct sheet %s;\n\n", symbol);
+    fprintf(out, "#endif\n");
+}
+
+static void write_source(FILE *out, const struct sheet *sheet, const char *symbol,
+                         const char *header, const char *source) {
+    uint8_t max_chord = 1;
+    for (uint8_t v = 0; v < sheet->voice_count; v++) {
+        for (struct note *n = pool_first_note(&sheet->pools[v]); n; n = note_next(&sheet->pools[v], n)) {
+            if (n->chord_size > max_chord) max_chord = n->chord_size;
+        }
+    }
+
+    fprintf(out, "// Generated by abcembed from %s - do not edit\n", source);
+    fprintf(out, "#include \"%s\"\n\n", header);
+    fprintf(out, "#if ABC_PPQ != %d\n#error \"%s was compiled with ABC_PPQ=%d\"\n#endif\n",
+            ABC_PPQ, source, ABC_PPQ);
+    fprintf(out, "#if ABC_MAX_CHORD_NOTES < %u\n#error \"%s needs ABC_MAX_CHORD_NOTES >= %u\"\n#endif\n\n",
+            max_chord, source, max_chord);
+
+    // Note arrays, relinked in list order
+    for (uint8_t v = 0; v < sheet->voice_count; v++) {
+        const NotePool *pool = &sheet->pools[v];
+        if (pool->count == 0) continue;
+        fprintf(out, "static const struct note %s_voice%u[%u] = {\n", symbol, v, pool->count);
+        uint16_t i = 0;
+        for (struct note *n = pool_first_note(pool); n; n = note_next(pool, n), i++) {
+            fprintf(out, "    { %d, %u, %u, { ", i + 1 < pool->count ? i + 1 : -1, n->duration, n->chord_size);
+            for (uint8_t j = 0; j < n->chord_size; j++) {
+                fprintf(out, "%s%u", j ? ", " : "", n->midi_note[j]);
+            }
+            if (n->chord_size == 0) fprintf(out, "0");
+            fprintf(out, " } },\n");
+        }
+        fprintf(out, "};\n\n");
+    }
+
+    if (sheet->voice_count > 0) {
+        fprintf(out, "static NotePool %s_pools[%u] = {\n", symbol, sheet->voice_count);
+        for (uint8_t v = 0; v < sheet->voice_count; v++) {
+            const NotePool *pool = &sheet->pools[v];
+            fprintf(out, "    {\n");
+            if (pool->count > 0) {
+                fprintf(out, "        .notes = (struct note *)%s_voice%u,\n", symbol, v);
+            }
+            fprintf(out, "        .voice_id = ");
+            write_string(out, pool->voice_id);
+            fprintf(out, ",\n");
+            fprintf(out, "        .head_index = %d,\n", pool->count > 0 ? 0 : -1);
+            fprintf(out, "        .tail_index = %d,\n", (int)pool->count - 1);
+            fprintf(out, "        .count = %u,\n", pool->count);
+            fprintf(out, "        .capacity = 0,\n");
+            fprintf(out, "        .total_ticks = %luu,\n", (unsigned long)pool->total_ticks);
+            fprintf(out, "        .max_chord_notes = %u\n", pool->max_chord_notes);
+            fprintf(out, "    },\n");
+        }
+        fprintf(out, "};\n\n");
+    }
+
+    fprintf(out, "struct sheet %s = {\n", symbol);
+    if (sheet->voice_count > 0) fprintf(out, "    .pools = %s_pools,\n", symbol);
+    fprintf(out, "    .pool_count = %u,\n", sheet->voice_count);
+    fprintf(out, "    .voice_count = %u,\n", sheet->voice_count);
+    fprintf(out, "    .tempo_bpm = %u,\n", sheet->tempo_bpm);
+    fprintf(out, "    .title = "); write_string(out, sheet->title); fprintf(out, ",\n");
+    fprintf(out, "    .composer = "); write_string(out, sheet->composer); fprintf(out, ",\n");
+    fprintf(out, "    .key = "); write_string(out, sheet->key); fprintf(out, ",\n");
+    fprintf(out, "    .default_note_num = %u,\n", sheet->default_note_num);
+    fprintf(out, "    .default_note_den = %u,\n", sheet->default_note_den);
+    fprintf(out, "    .meter_num = %u,\n", sheet->meter_num);
+    fprintf(out, "    .meter_den = %u,\n", sheet->meter_den);
+    fprintf(out, "    .tempo_note_num = %u,\n", sheet->tempo_note_num);
+    fprintf(out, "    .tempo_note_den = %u\n", sheet->tempo_note_den);
+    fprintf(out, "};\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc != 5) {
+        fprintf(stderr, "usage: %s <input.abc> <output.c> <output.h> <symbol>\n", argv[0]);
+        return 2;
+    }
+    const char *input = argv[1];
+    const char *header_path = argv[3];
+    const char *symbol = argv[4];
+
+    char *abc = read_file(input);
+    if (!abc) {
+        fprintf(stderr, "abcembed: cannot read %s (or larger than 64 KB)\n", input);
+        return 1;
+    }
+
+    static NotePool pools[EMBED_MAX_VOICES];
+    struct note *storage = malloc(sizeof(struct note) * EMBED_MAX_VOICES * EMBED_MAX_NOTES);
+    if (!storage) { free(abc); return 1; }
+    for (int i = 0; i < EMBED_MAX_VOICES; i++) {
+        note_pool_init(&pools[i], storage + (size_t)i * EMBED_MAX_NOTES, EMBED_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    struct sheet sheet;
+    sheet_init(&sheet, pools, EMBED_MAX_VOICES);
+
+    int result = abc_parse(&sheet, abc);
+    if (result < 0) {
+        fprintf(stderr, "abcembed: %s: parse failed (%d)\n", input, result);
+        free(storage); free(abc);
+        return 1;
+    }
+
+    // The generated source includes the header by file name
+    const char *header_name = strrchr(header_path, '/');
+    header_name = header_name ? header_name + 1 : header_path;
+    const char *source_name = strrchr(input, '/');
+    source_name = source_name ? source_name + 1 : input;
+
+    FILE *h = fopen(header_path, "w");
+    FILE *c = fopen(argv[2], "w");
+    if (!h || !c) {
+        fprintf(stderr, "abcembed: cannot write output files\n");
+        if (h) fclose(h);
+        if (c) fclose(c);
+        free(storage); free(abc);
+        return 1;
+    }
+    write_header(h, symbol, source_name);
+    write_source(c, &sheet, symbol, header_name, source_name);
+    fclose(h);
+    fclose(c);
+
+    free(storage);
+    free(abc);
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "abc_fingerprint.h"
+#include <string.h>
+
+#define ROWS (ABC_FP_HASHES / ABC_FP_BANDS)
+#define MAX_LEAP 12
+#define MAX_RATIO 3                 // Duration ratios from 2^-3 to 2^3
+#define HASH_BASE 0x01000193u       // Rolling hash multiplier (odd)
+
+// Finalizer from MurmurHash3: spreads every input bit over the output
+static uint32_t mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// ============================================================================
+// Tokens and shingles
+// ============================================================================
+
+// Top pitch of a note (0 for a rest)
+static uint8_t top_pitch(const struct note *n) {
+    uint8_t top = 0;
+    for (uint8_t i = 0; i < n->chord_size && i < ABC_MAX_CHORD_NOTES; i++) {
+        if (n->midi_note[i] > top) top = n->midi_note[i];
+    }
+    return top;
+}
+
+// log2(duration / prev), rounded at the geometric midpoints and clamped
+static int duration_ratio(uint32_t duration, uint32_t prev) {
+    int r = 0;
+    if (duration == 0 || prev == 0) return 0;
+    while (duration > prev && r < MAX_RATIO && duration * duration >= 2 * prev * prev) { prev *= 2; r++; }
+    while (prev > duration && r > -MAX_RATIO && prev * prev >= 2 * duration * duration) { duration *= 2; r--; }
+    return r;
+}
+
+static uint32_t token(uint8_t pitch, uint8_t duration, uint8_t prev_pitch, uint8_t prev_duration) {
+    int interval = (int)pitch - (int)prev_pitch;
+    if (interval > MAX_LEAP) interval = MAX_LEAP;
+    if (interval < -MAX_LEAP) interval = -MAX_LEAP;
+    int ratio = duration_ratio(duration, prev_duration);
+    // + 1 so no token is 0 and leading tokens still move the rolling hash
+    return (uint32_t)((interval + MAX_LEAP) * (2 * MAX_RATIO + 1) + ratio + MAX_RATIO) + 1;
+}
+
+// Hash function i is x * m_i + a_i (odd m_i: a permutation of 32-bit values)
+// over the well-mixed shingle; the loop has no branches so it vectorizes
+static void minhash(AbcFingerprint *fp, uint32_t shingle) {
+    uint32_t x = mix32(shingle);
+    for (uint32_t i = 0; i < ABC_FP_HASHES; i++) {
+        uint32_t h = x * (0x9E3779B9u * (2 * i + 1) | 1u) + 0x7F4A7C15u * (i + 1);
+        fp->min[i] = h < fp->min[i] ? h : fp->min[i];
+    }
+}
+
+int32_t abc_fingerprint(const NotePool *pool, AbcFingerprint *fp) {
+    if (!pool || !fp) return -1;
+    for (uint32_t i = 0; i < ABC_FP_HASHES; i++) fp->min[i] = UINT32_MAX;
+    fp->shingles = 0;
+
+    // HASH_BASE^ABC_FP_SHINGLE removes the token leaving the window
+    uint32_t out_factor = 1;
+    for (int i = 0; i < ABC_FP_SHINGLE; i++) out_factor *= HASH_BASE;
+
+    uint32_t window[ABC_FP_SHINGLE];
+    uint32_t tokens = 0, hash = 0;
+    uint8_t prev_pitch = 0, prev_duration = 0;
+    for (struct note *n = pool_first_note(pool); n; n = note_next(pool, n)) {
+        uint8_t pitch = top_pitch(n);
+        if (pitch == 0) continue;
+        if (prev_pitch != 0) {
+            uint32_t t = token(pitch, n->duration, prev_pitch, prev_duration);
+            uint32_t slot = tokens % ABC_FP_SHINGLE;
+            hash = hash * HASH_BASE + t;
+            if (tokens >= ABC_FP_SHINGLE) hash -= window[slot] * out_factor;
+            window[slot] = t;
+            tokens++;
+            if (tokens >= ABC_FP_SHINGLE) {
+                minhash(fp, hash);
+                fp->shingles++;
+            }
+        }
+        prev_pitch = pitch;
+        prev_duration = n->duration;
+    }
+    return (int32_t)fp->shingles;
+}
+
+float abc_fingerprint_similarity(const AbcFingerprint *a, const AbcFingerprint *b) {
+    if (!a || !b || a->shingles == 0 || b->shingles == 0) return 0.0f;
+    uint32_t equal = 0;
+    for (uint32_t i = 0; i < ABC_FP_HASHES; i++) equal += a->min[i] == b->min[i];
+    return (float)equal / ABC_FP_HASHES;
+}
+
+// ============================================================================
+// Clustering
+// ============================================================================
+
+// Heapsort: O(n log n) with no extra memory
+static void sift_down(uint64_t *v, uint32_t root, uint32_t n) {
+    for (uint32_t child; (child = 2 * root + 1) < n; root = child) {
+        if (child + 1 < n && v[child] < v[child + 1]) child++;
+        if (v[root] >= v[child]) return;
+        uint64_t t = v[root];
+        v[root] = v[child];
+        v[child] = t;
+    }
+}
+
+static void sort_keys(uint64_t *v, uint32_t n) {
+    for (uint32_t i = n / 2; i > 0; i--) sift_down(v, i - 1, n);
+    for (uint32_t end = n; end > 1; end--) {
+        uint64_t t = v[0];
+        v[0] = v[end - 1];
+        v[end - 1] = t;
+        sift_down(v, 0, end - 1);
+    }
+}
+
+// Union-find over cluster[]: roots are the lowest index of their set
+static uint32_t find_root(uint32_t *parent, uint32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];      // Path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+// Join a's and b's clusters if the tunes are similar; returns 1 if they are
+// (now) in one cluster
+static int join(const AbcFingerprint *fps, float threshold, uint32_t *parent, uint32_t a, uint32_t b) {
+    uint32_t ra = find_root(parent, a), rb = find_root(parent, b);
+    if (ra == rb) return 1;
+    if (abc_fingerprint_similarity(&fps[a], &fps[b]) < threshold) return 0;
+    if (ra < rb) parent[rb] = ra;
+    else parent[ra] = rb;
+    return 1;
+}
+
+int32_t abc_fingerprint_cluster(const AbcFingerprint *fps, uint32_t count, float threshold,
+                                uint64_t *scratch, uint32_t *cluster) {
+    if (count > 0 && (!fps || !scratch || !cluster)) return -1;
+    for (uint32_t i = 0; i < count; i++) cluster[i] = i;
+
+    for (uint32_t band = 0; band < ABC_FP_BANDS; band++) {
+        // Band hash << 32 | tune, so a sort brings each band bucket together
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if (fps[i].shingles == 0) continue;
+            uint32_t h = band;
+            for (uint32_t r = 0; r < ROWS; r++) h = mix32(h ^ fps[i].min[band * ROWS + r]);
+            scratch[n++] = (uint64_t)h << 32 | i;
+        }
+        sort_keys(scratch, n);
+
+        // Within a bucket, compare each tune with one representative of each
+        // cluster seen so far in it, not with every member, and with at most
+        // ABC_FP_BUCKET_REPS of them: a bucket of k tunes costs O(k) however
+        // they group. Representatives are packed at the front of the bucket's
+        // own range of scratch.
+        for (uint32_t start = 0; start < n;) {
+            uint32_t end = start + 1;
+            while (end < n && (scratch[end] >> 32) == (scratch[start] >> 32)) end++;
+            uint32_t reps = 1;
+            for (uint32_t i = start + 1; i < end; i++) {
+                uint32_t tune = (uint32_t)scratch[i];
+                int similar = 0;
+                for (uint32_t r = start; r < start + reps; r++) {
+                    similar |= join(fps, threshold, cluster, (uint32_t)scratch[r], tune);
+                }
+                if (!similar && reps < ABC_FP_BUCKET_REPS) scratch[start + reps++] = scratch[i];
+            }
+            start = end;
+        }
+    }
+
+    int32_t joined = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        cluster[i] = find_root(cluster, i);
+        joined += cluster[i] != i;
+    }
+    return joined;
+}
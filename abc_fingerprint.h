@@ -0,0 +1,60 @@
+#ifndef ABC_FINGERPRINT_H
+#define ABC_FINGERPRINT_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Fingerprints - near-duplicate detection across collections
+// ============================================================================
+//
+// A tune's melody (rests skipped, top note of chords) becomes a stream of
+// tokens, one per note after the first: the interval from the previous note
+// (clamped to an octave) and the duration ratio to it (rounded to a power of
+// two, 1/8 to 8). Tokens are the same in any key and at any tempo or unit
+// length.
+//
+// A rolling hash over every ABC_FP_SHINGLE consecutive tokens gives the
+// tune's shingles. The MinHash signature keeps, for each of ABC_FP_HASHES hash
+// functions, the smallest hash of any shingle. The fraction of equal entries
+// between two signatures estimates the Jaccard similarity of their shingle
+// sets: settings that differ in a few notes still share most shingles.
+//
+// abc_fingerprint_cluster() groups a whole collection without comparing
+// every pair. Signatures are cut into ABC_FP_BANDS bands (locality-sensitive
+// hashing), and only tunes that agree on a whole band are compared: each
+// with the first tune of each cluster already met in that band's bucket, up
+// to ABC_FP_BUCKET_REPS clusters. A bucket holding more distinct tunes than
+// that is a stock phrase; its later tunes still meet their duplicates in
+// other bands. The work is O(n log n) per band.
+
+#define ABC_FP_SHINGLE 5            // Tokens per shingle
+#define ABC_FP_HASHES 64            // Signature entries
+#define ABC_FP_BANDS 16             // LSH bands of ABC_FP_HASHES / ABC_FP_BANDS entries
+#define ABC_FP_BUCKET_REPS 32       // Clusters a tune is compared with per band bucket
+
+typedef struct {
+    uint32_t min[ABC_FP_HASHES];    // Smallest hash per function (all UINT32_MAX if no shingles)
+    uint32_t shingles;              // Shingles hashed (0 = melody too short to compare)
+} AbcFingerprint;
+
+// Fingerprint one voice's pool (usually the melody voice)
+// Returns the number of shingles, or -1 on invalid arguments
+int32_t abc_fingerprint(const NotePool *pool, AbcFingerprint *fp);
+
+// Estimated Jaccard similarity of two tunes' shingle sets (0.0 - 1.0)
+// Returns 0 if either tune has no shingles
+float abc_fingerprint_similarity(const AbcFingerprint *a, const AbcFingerprint *b);
+
+// Group likely duplicates. A tune joins a cluster, transitively, when it
+// shares a band with that cluster's first tune in the band's bucket (one of
+// the bucket's first ABC_FP_BUCKET_REPS clusters) and their similarity is at
+// least `threshold`.
+// scratch: count entries of working memory
+// cluster: count entries; cluster[i] = lowest index in tune i's cluster
+// Returns the number of tunes that joined an earlier tune's cluster
+// (count minus distinct tunes), or -1 on invalid arguments
+int32_t abc_fingerprint_cluster(const AbcFingerprint *fps, uint32_t count, float threshold,
+                                uint64_t *scratch, uint32_t *cluster);
+
+#endif // ABC_FINGERPRINT_H
@@ -0,0 +1,240 @@
+#include "abc_image.h"
+#include <stddef.h>
+#include <string.h>
+
+#define NOTE_RECORD_SIZE (4 + ABC_MAX_CHORD_NOTES)
+
+// ============================================================================
+// Little-endian field access
+// ============================================================================
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t align8(uint32_t v) {
+    return (v + 7u) & ~7u;
+}
+
+static int host_is_little_endian(void) {
+    const uint16_t one = 1;
+    return *(const uint8_t *)&one == 1;
+}
+
+// Alignment requirement of struct note (C99 has no alignof)
+struct note_align_probe { char c; struct note n; };
+#define NOTE_ALIGN offsetof(struct note_align_probe, n)
+
+uint32_t abc_image_checksum(const void *data, uint32_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Count notes reachable from head (bounded by count so corrupt links terminate)
+static uint16_t pool_list_length(const NotePool *pool) {
+    uint16_t n = 0;
+    struct note *cur = pool_first_note(pool);
+    while (cur && n < pool->count) {
+        n++;
+        cur = note_next(pool, cur);
+    }
+    return n;
+}
+
+static uint8_t bounded_strlen(const char *s, uint8_t max) {
+    uint8_t n = 0;
+    while (n < max && s[n]) n++;
+    return n;
+}
+
+// ============================================================================
+// Save
+// ============================================================================
+
+int32_t sheet_save_image(const struct sheet *sheet, void *buffer, uint32_t buffer_size) {
+    if (!sheet || (sheet->voice_count > 0 && !sheet->pools)) return -1;
+    if (sheet->voice_count > sheet->pool_count) return -1;
+
+    uint8_t title_len = bounded_strlen(sheet->title, ABC_MAX_TITLE_LEN);
+    uint8_t composer_len = bounded_strlen(sheet->composer, ABC_MAX_COMPOSER_LEN);
+    uint8_t key_len = bounded_strlen(sheet->key, ABC_MAX_KEY_LEN);
+
+    uint32_t size = ABC_IMAGE_HEADER_SIZE + (uint32_t)sheet->voice_count * ABC_IMAGE_VOICE_SIZE;
+    size += (uint32_t)title_len + composer_len + key_len;
+    for (uint8_t v = 0; v < sheet->voice_count; v++) {
+        size = align8(size) + (uint32_t)pool_list_length(&sheet->pools[v]) * NOTE_RECORD_SIZE;
+    }
+    size = align8(size);
+
+    if (!buffer) return (int32_t)size;
+    if (buffer_size < size) return -2;
+
+    uint8_t *out = (uint8_t *)buffer;
+    memset(out, 0, size);
+
+    // Header
+    memcpy(out, "ABCI", 4);
+    put_u16(out + 4, ABC_IMAGE_VERSION);
+    put_u16(out + 6, ABC_IMAGE_HEADER_SIZE);
+    put_u32(out + 8, size);
+    put_u16(out + 16, ABC_PPQ);
+    put_u16(out + 18, sheet->tempo_bpm);
+    out[20] = sheet->default_note_num;
+    out[21] = sheet->default_note_den;
+    out[22] = sheet->meter_num;
+    out[23] = sheet->meter_den;
+    out[24] = sheet->tempo_note_num;
+    out[25] = sheet->tempo_note_den;
+    out[26] = sheet->voice_count;
+    out[27] = NOTE_RECORD_SIZE;
+    out[28] = title_len;
+    out[29] = composer_len;
+    out[30] = key_len;
+
+    // Metadata strings follow the voice table
+    uint32_t pos = ABC_IMAGE_HEADER_SIZE + (uint32_t)sheet->voice_count * ABC_IMAGE_VOICE_SIZE;
+    memcpy(out + pos, sheet->title, title_len); pos += title_len;
+    memcpy(out + pos, sheet->composer, composer_len); pos += composer_len;
+    memcpy(out + pos, sheet->key, key_len); pos += key_len;
+
+    // Voices: notes are written in list order, relinked as 0, 1, 2, ...
+    for (uint8_t v = 0; v < sheet->voice_count; v++) {
+        const NotePool *pool = &sheet->pools[v];
+        uint16_t count = pool_list_length(pool);
+        uint8_t *rec = out + ABC_IMAGE_HEADER_SIZE + (uint32_t)v * ABC_IMAGE_VOICE_SIZE;
+
+        pos = align8(pos);
+        put_u32(rec, pos);
+        put_u32(rec + 4, pool->total_ticks);
+        put_u16(rec + 8, count);
+        rec[10] = pool->max_chord_notes;
+        memcpy(rec + 12, pool->voice_id, bounded_strlen(pool->voice_id, ABC_IMAGE_VOICE_ID_LEN - 1));
+
+        struct note *n = pool_first_note(pool);
+        for (uint16_t i = 0; i < count; i++) {
+            uint8_t *dst = out + pos;
+            put_u16(dst, (uint16_t)(i + 1 < count ? (int16_t)(i + 1) : -1));
+            dst[2] = n->duration;
+            dst[3] = n->chord_size;
+            for (uint8_t j = 0; j < n->chord_size && j < ABC_MAX_CHORD_NOTES; j++) {
+                dst[4 + j] = n->midi_note[j];
+            }
+            pos += NOTE_RECORD_SIZE;
+            n = note_next(pool, n);
+        }
+    }
+
+    put_u32(out + 12, abc_image_checksum(out + 16, size - 16));
+    return (int32_t)size;
+}
+
+// ============================================================================
+// Load
+// ============================================================================
+
+int abc_load_image(struct sheet *sheet, const void *image, uint32_t image_size) {
+    if (!sheet || !image) return -1;
+
+    const uint8_t *in = (const uint8_t *)image;
+    if (image_size < ABC_IMAGE_HEADER_SIZE || memcmp(in, "ABCI", 4) != 0) return -3;
+    if (get_u16(in + 4) != ABC_IMAGE_VERSION || get_u16(in + 6) != ABC_IMAGE_HEADER_SIZE) return -3;
+
+    uint32_t size = get_u32(in + 8);
+    if (size < ABC_IMAGE_HEADER_SIZE || size > image_size) return -3;
+    if (get_u32(in + 12) != abc_image_checksum(in + 16, size - 16)) return -3;
+
+    uint8_t voice_count = in[26];
+    uint8_t title_len = in[28], composer_len = in[29], key_len = in[30];
+    uint32_t strings = ABC_IMAGE_HEADER_SIZE + (uint32_t)voice_count * ABC_IMAGE_VOICE_SIZE;
+    if (strings + title_len + composer_len + key_len > size) return -3;
+
+    if (!host_is_little_endian() || get_u16(in + 16) != ABC_PPQ ||
+        in[27] != NOTE_RECORD_SIZE || sizeof(struct note) != NOTE_RECORD_SIZE) {
+        return -4;
+    }
+    if (voice_count > sheet->pool_count || (voice_count > 0 && !sheet->pools)) return -2;
+
+    // Validate every voice before touching the sheet
+    for (uint8_t v = 0; v < voice_count; v++) {
+        const uint8_t *rec = in + ABC_IMAGE_HEADER_SIZE + (uint32_t)v * ABC_IMAGE_VOICE_SIZE;
+        uint32_t offset = get_u32(rec);
+        uint16_t count = get_u16(rec + 8);
+        if (count > 0x7FFF || offset > size || (uint32_t)count * NOTE_RECORD_SIZE > size - offset) return -3;
+        if (((uintptr_t)(in + offset)) % NOTE_ALIGN != 0) return -4;
+
+        // The checksum only catches accidents, so check everything the list
+        // walk and pitch lookups rely on: the writer links notes 0, 1, 2, ...
+        // and pitches index 128-entry tables
+        const struct note *notes = (const struct note *)(const void *)(in + offset);
+        for (uint16_t i = 0; i < count; i++) {
+            if (notes[i].chord_size > ABC_MAX_CHORD_NOTES) return -3;
+            if (notes[i].next_index != (i + 1 < count ? (int16_t)(i + 1) : -1)) return -3;
+            for (uint8_t j = 0; j < notes[i].chord_size; j++) {
+                if (notes[i].midi_note[j] > 127) return -3;
+            }
+        }
+    }
+
+    sheet_reset(sheet);
+    sheet->tempo_bpm = get_u16(in + 18);
+    sheet->default_note_num = in[20];
+    sheet->default_note_den = in[21];
+    sheet->meter_num = in[22];
+    sheet->meter_den = in[23];
+    sheet->tempo_note_num = in[24];
+    sheet->tempo_note_den = in[25];
+
+    const char *str = (const char *)(in + strings);
+    uint8_t n;
+    n = title_len < ABC_MAX_TITLE_LEN ? title_len : ABC_MAX_TITLE_LEN - 1;
+    memcpy(sheet->title, str, n); sheet->title[n] = '\0'; str += title_len;
+    n = composer_len < ABC_MAX_COMPOSER_LEN ? composer_len : ABC_MAX_COMPOSER_LEN - 1;
+    memcpy(sheet->composer, str, n); sheet->composer[n] = '\0'; str += composer_len;
+    n = key_len < ABC_MAX_KEY_LEN ? key_len : ABC_MAX_KEY_LEN - 1;
+    memcpy(sheet->key, str, n); sheet->key[n] = '\0';
+
+    for (uint8_t v = 0; v < voice_count; v++) {
+        const uint8_t *rec = in + ABC_IMAGE_HEADER_SIZE + (uint32_t)v * ABC_IMAGE_VOICE_SIZE;
+        uint16_t count = get_u16(rec + 8);
+        NotePool *pool = &sheet->pools[v];
+
+        // Pool points into the image; capacity 0 keeps the parser from writing
+        // to it, and no allocator may grow (realloc or free) the image
+        pool->notes = (struct note *)(uintptr_t)(in + get_u32(rec));
+        pool->count = count;
+        pool->capacity = 0;
+        pool->allocator = NULL;
+        pool->head_index = count > 0 ? 0 : -1;
+        pool->tail_index = (int16_t)count - 1;
+        pool->total_ticks = get_u32(rec + 4);
+        pool->max_chord_notes = rec[10];
+
+        n = bounded_strlen((const char *)(rec + 12), ABC_IMAGE_VOICE_ID_LEN);
+        if (n >= ABC_MAX_VOICE_ID_LEN) n = ABC_MAX_VOICE_ID_LEN - 1;
+        memcpy(pool->voice_id, rec + 12, n);
+        pool->voice_id[n] = '\0';
+    }
+    sheet->voice_count = voice_count;
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef ABC_IMAGE_H
+#define ABC_IMAGE_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Binary sheet images
+// ============================================================================
+//
+// A parsed sheet can be saved as a flat, versioned image and loaded back
+// without re-parsing. All multi-byte fields are little-endian. Note records
+// use the same byte layout as struct note on little-endian hosts, so
+// abc_load_image() points pools straight into the image (flash, mmap, ...)
+// instead of copying notes.
+//
+// Layout (offsets in bytes):
+//   0   header (32 bytes): magic "ABCI", version, sizes, checksum, metadata
+//   32  voice table (32 bytes per voice)
+//   ..  title, composer and key bytes (not NUL-terminated)
+//   ..  note arrays, one per voice, each 8-byte aligned
+//
+// The checksum is FNV-1a over every byte after the checksum field.
+
+#define ABC_IMAGE_VERSION 1
+#define ABC_IMAGE_HEADER_SIZE 32
+#define ABC_IMAGE_VOICE_SIZE 32
+#define ABC_IMAGE_VOICE_ID_LEN 16  // Voice ID bytes stored per voice (NUL-padded)
+
+// Save a parsed sheet as an image
+// buffer: destination (NULL to query the required size)
+// Returns image size in bytes, or negative on error
+//   -1: NULL sheet or invalid sheet
+//   -2: buffer too small
+int32_t sheet_save_image(const struct sheet *sheet, void *buffer, uint32_t buffer_size);
+
+// Load an image into a sheet without copying notes
+// sheet: initialized with sheet_init(); its pools are repointed into the image
+// image: must stay valid (and unmodified) while the sheet is in use, and be
+//        aligned for struct note (8-byte alignment is always sufficient)
+// Loaded pools are read-only: capacity is 0 and any allocator is dropped, so
+// parsing into them fails with -2. Re-initialize pools with note_pool_init()
+// (and note_pool_set_allocator()) before parsing into them again.
+// Returns 0 on success, negative on error
+//   -1: NULL input
+//   -2: sheet has fewer pools than the image has voices
+//   -3: corrupt image (bad magic, version, bounds, checksum, note links or pitches)
+//   -4: image is valid but cannot be mapped on this build
+//       (big-endian host, different ABC_PPQ or ABC_MAX_CHORD_NOTES, misaligned)
+int abc_load_image(struct sheet *sheet, const void *image, uint32_t image_size);
+
+// FNV-1a checksum used by images
+uint32_t abc_image_checksum(const void *data, uint32_t len);
+
+#endif // ABC_IMAGE_H
@@ -0,0 +1,362 @@
+#include "abc_index.h"
+#include "abc_image.h"
+#include <string.h>
+
+#define RECORD_SIZE 40
+
+// ============================================================================
+// Little-endian field access
+// ============================================================================
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int host_is_little_endian(void) {
+    const uint16_t one = 1;
+    return *(const uint8_t *)&one == 1;
+}
+
+uint32_t abc_index_title_hash(const char *title, uint32_t len) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t c = (uint8_t)title[i];
+        if (c >= 'A' && c <= 'Z') c = (uint8_t)(c + 32);
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+// ============================================================================
+// Scanning collection files
+// ============================================================================
+
+static uint32_t line_end(const char *text, uint32_t size, uint32_t pos) {
+    while (pos < size && text[pos] != '\n') pos++;
+    return pos;
+}
+
+static int is_tune_start(const char *text, uint32_t size, uint32_t pos) {
+    return pos + 1 < size && text[pos] == 'X' && text[pos + 1] == ':';
+}
+
+static int is_blank_line(const char *text, uint32_t size, uint32_t pos) {
+    while (pos < size && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')) pos++;
+    return pos >= size || text[pos] == '\n';
+}
+
+// First line at or after pos (a line start) that begins a tune
+static uint32_t next_tune(const char *text, uint32_t size, uint32_t pos) {
+    while (pos < size && !is_tune_start(text, size, pos)) pos = line_end(text, size, pos) + 1;
+    return pos < size ? pos : size;
+}
+
+// End of the tune starting at pos: the next blank or X: line
+static uint32_t tune_end(const char *text, uint32_t size, uint32_t pos) {
+    pos = line_end(text, size, pos) + 1;
+    while (pos < size && !is_tune_start(text, size, pos) && !is_blank_line(text, size, pos)) {
+        pos = line_end(text, size, pos) + 1;
+    }
+    return pos < size ? pos : size;
+}
+
+static uint32_t span_number(const char *text, AbcSpan span) {
+    uint32_t value = 0;
+    for (uint16_t i = 0; i < span.len && text[span.offset + i] >= '0' && text[span.offset + i] <= '9'; i++) {
+        if (value > 99999999u) break;       // Saturate well below overflow
+        value = value * 10 + (uint32_t)(text[span.offset + i] - '0');
+    }
+    return value;
+}
+
+static void span_meter(const char *text, AbcSpan span, AbcIndexRecord *rec) {
+    const char *m = text + span.offset;
+    if (span.len == 1 && m[0] == 'C') { rec->meter_num = 4; rec->meter_den = 4; return; }
+    if (span.len == 2 && m[0] == 'C' && m[1] == '|') { rec->meter_num = 2; rec->meter_den = 2; return; }
+
+    uint16_t slash = 0;
+    while (slash < span.len && m[slash] != '/') slash++;
+    if (slash == span.len) return;
+    uint32_t num = span_number(text, (AbcSpan){ span.offset, slash });
+    uint32_t den = span_number(text, (AbcSpan){ (uint16_t)(span.offset + slash + 1), (uint16_t)(span.len - slash - 1) });
+    if (num == 0 || den == 0 || num > 255 || den > 255) return;
+    rec->meter_num = (uint8_t)num;
+    rec->meter_den = (uint8_t)den;
+}
+
+// Header fields and note counts of one tune, read from a NUL-terminated copy
+static void fill_record(AbcIndexRecord *rec, const char *tune, uint32_t offset, uint32_t length,
+                        uint16_t file_id, char *scratch) {
+    memset(rec, 0, sizeof(*rec));
+    rec->offset = offset;
+    rec->length = length;
+    rec->file_id = file_id;
+    rec->text_hash = abc_image_checksum(tune, length);
+
+    uint16_t len = length > 0xFFFF ? 0xFFFF : (uint16_t)length;
+    if (length > 0xFFFF) rec->flags |= ABC_INDEX_LONG;
+    memcpy(scratch, tune, len);
+    scratch[len] = '\0';
+
+    AbcHeaderScan scan;
+    abc_scan_header(scratch, 0, &scan);
+    rec->number = span_number(scratch, scan.number);
+    if (scan.title.len) rec->title_hash = abc_index_title_hash(scratch + scan.title.offset, scan.title.len);
+    memcpy(rec->key, scratch + scan.key.offset, scan.key.len < ABC_INDEX_KEY_LEN ? scan.key.len : ABC_INDEX_KEY_LEN);
+    span_meter(scratch, scan.meter, rec);
+
+    AbcMeasureReport report;
+    if (abc_measure(scratch, &report) == -2) rec->flags |= ABC_INDEX_OVERSIZE;
+    rec->note_count = report.total_notes;
+    rec->voice_count = report.voice_count;
+}
+
+int32_t abc_index_scan(const char *text, uint32_t size, uint16_t file_id,
+                       AbcIndexRecord *records, uint32_t capacity, char *scratch) {
+    if (!text || !scratch || (!records && capacity > 0)) return -1;
+
+    uint32_t pos = next_tune(text, size, 0);
+    int whole_file = (pos == size);
+    if (whole_file) pos = 0;
+
+    uint32_t count = 0;
+    while (pos < size) {
+        uint32_t end = whole_file ? size : tune_end(text, size, pos);
+        uint32_t trimmed = end;
+        while (trimmed > pos && (text[trimmed - 1] == ' ' || text[trimmed - 1] == '\t' ||
+                                 text[trimmed - 1] == '\r' || text[trimmed - 1] == '\n')) {
+            trimmed--;
+        }
+        if (trimmed > pos) {
+            if (count == capacity) return -2;
+            fill_record(&records[count++], text + pos, pos, trimmed - pos, file_id, scratch);
+        }
+        pos = next_tune(text, size, end);
+    }
+    return (int32_t)count;
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+// Heapsort: O(n log n) with no extra memory, for records and index tables
+typedef int (*Compare)(const uint8_t *a, const uint8_t *b, const void *ctx);
+
+static void swap_bytes(uint8_t *a, uint8_t *b, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) {
+        uint8_t t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+static void sift_down(uint8_t *base, uint32_t size, uint32_t root, uint32_t n, Compare cmp, const void *ctx) {
+    for (uint32_t child; (child = 2 * root + 1) < n; root = child) {
+        if (child + 1 < n && cmp(base + child * size, base + (child + 1) * size, ctx) < 0) child++;
+        if (cmp(base + root * size, base + child * size, ctx) >= 0) return;
+        swap_bytes(base + root * size, base + child * size, size);
+    }
+}
+
+static void heap_sort(void *data, uint32_t n, uint32_t size, Compare cmp, const void *ctx) {
+    uint8_t *base = (uint8_t *)data;
+    for (uint32_t i = n / 2; i > 0; i--) sift_down(base, size, i - 1, n, cmp, ctx);
+    for (uint32_t end = n; end > 1; end--) {
+        swap_bytes(base, base + (end - 1) * size, size);
+        sift_down(base, size, 0, end - 1, cmp, ctx);
+    }
+}
+
+#define ORDER(x, y) if ((x) != (y)) return (x) < (y) ? -1 : 1
+
+static int compare_records(const uint8_t *a, const uint8_t *b, const void *ctx) {
+    const AbcIndexRecord *x = (const AbcIndexRecord *)(const void *)a;
+    const AbcIndexRecord *y = (const AbcIndexRecord *)(const void *)b;
+    (void)ctx;
+    ORDER(x->number, y->number);
+    ORDER(x->file_id, y->file_id);
+    ORDER(x->offset, y->offset);
+    return 0;
+}
+
+// Table entries are little-endian record indices; ties keep index order
+static int compare_titles(const uint8_t *a, const uint8_t *b, const void *ctx) {
+    const AbcIndexRecord *records = (const AbcIndexRecord *)ctx;
+    uint32_t i = get_u32(a), j = get_u32(b);
+    ORDER(records[i].title_hash, records[j].title_hash);
+    ORDER(i, j);
+    return 0;
+}
+
+static int compare_keys(const uint8_t *a, const uint8_t *b, const void *ctx) {
+    const AbcIndexRecord *records = (const AbcIndexRecord *)ctx;
+    uint32_t i = get_u32(a), j = get_u32(b);
+    int c = memcmp(records[i].key, records[j].key, ABC_INDEX_KEY_LEN);
+    if (c != 0) return c;
+    ORDER(i, j);
+    return 0;
+}
+
+static void write_record(uint8_t *out, const AbcIndexRecord *rec) {
+    put_u32(out, rec->offset);
+    put_u32(out + 4, rec->length);
+    put_u32(out + 8, rec->number);
+    put_u32(out + 12, rec->title_hash);
+    put_u32(out + 16, rec->text_hash);
+    put_u32(out + 20, rec->note_count);
+    put_u16(out + 24, rec->file_id);
+    out[26] = rec->meter_num;
+    out[27] = rec->meter_den;
+    memcpy(out + 28, rec->key, ABC_INDEX_KEY_LEN);
+    out[36] = rec->voice_count;
+    out[37] = rec->flags;
+    put_u16(out + 38, 0);
+}
+
+int32_t abc_index_write(AbcIndexRecord *records, uint32_t count, void *buffer, uint32_t buffer_size) {
+    if (!records && count > 0) return -1;
+    uint64_t total = ABC_INDEX_HEADER_SIZE + (uint64_t)count * (RECORD_SIZE + 8);
+    if (total > 0x7FFFFFFF) return -2;
+    uint32_t size = (uint32_t)total;
+    if (!buffer) return (int32_t)size;
+    if (buffer_size < size) return -2;
+
+    heap_sort(records, count, sizeof(AbcIndexRecord), compare_records, NULL);
+
+    uint8_t *out = (uint8_t *)buffer;
+    uint32_t by_title = ABC_INDEX_HEADER_SIZE + count * RECORD_SIZE;
+    uint32_t by_key = by_title + count * 4;
+    memset(out, 0, ABC_INDEX_HEADER_SIZE);
+    memcpy(out, "ABCX", 4);
+    put_u16(out + 4, ABC_INDEX_VERSION);
+    put_u16(out + 6, ABC_INDEX_HEADER_SIZE);
+    put_u32(out + 8, size);
+    put_u32(out + 16, count);
+    put_u16(out + 20, RECORD_SIZE);
+    put_u16(out + 22, ABC_INDEX_KEY_LEN);
+    put_u32(out + 24, by_title);
+    put_u32(out + 28, by_key);
+
+    for (uint32_t i = 0; i < count; i++) {
+        write_record(out + ABC_INDEX_HEADER_SIZE + i * RECORD_SIZE, &records[i]);
+        put_u32(out + by_title + i * 4, i);
+        put_u32(out + by_key + i * 4, i);
+    }
+    heap_sort(out + by_title, count, 4, compare_titles, records);
+    heap_sort(out + by_key, count, 4, compare_keys, records);
+
+    put_u32(out + 12, abc_image_checksum(out + 16, size - 16));
+    return (int32_t)size;
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+int abc_index_open(AbcIndex *index, const void *data, uint32_t size) {
+    if (!index || !data) return -1;
+
+    const uint8_t *in = (const uint8_t *)data;
+    if (size < ABC_INDEX_HEADER_SIZE || memcmp(in, "ABCX", 4) != 0) return -3;
+    if (get_u16(in + 4) != ABC_INDEX_VERSION || get_u16(in + 6) != ABC_INDEX_HEADER_SIZE) return -3;
+    if (get_u16(in + 20) != RECORD_SIZE || get_u16(in + 22) != ABC_INDEX_KEY_LEN) return -3;
+
+    uint32_t total = get_u32(in + 8);
+    uint32_t count = get_u32(in + 16);
+    uint32_t by_title = get_u32(in + 24), by_key = get_u32(in + 28);
+    if (total < ABC_INDEX_HEADER_SIZE || total > size) return -3;
+    if ((uint64_t)count * (RECORD_SIZE + 8) > total - ABC_INDEX_HEADER_SIZE) return -3;
+    if (by_title != ABC_INDEX_HEADER_SIZE + count * RECORD_SIZE || by_key != by_title + count * 4) return -3;
+    if (get_u32(in + 12) != abc_image_checksum(in + 16, total - 16)) return -3;
+
+    // Lookups index records through the tables, so check every entry once
+    for (uint32_t i = 0; i < count; i++) {
+        if (get_u32(in + by_title + i * 4) >= count || get_u32(in + by_key + i * 4) >= count) return -3;
+    }
+
+    if (!host_is_little_endian() || sizeof(AbcIndexRecord) != RECORD_SIZE || (uintptr_t)in % 4 != 0) return -4;
+
+    index->records = (const AbcIndexRecord *)(const void *)(in + ABC_INDEX_HEADER_SIZE);
+    index->by_title = (const uint32_t *)(const void *)(in + by_title);
+    index->by_key = (const uint32_t *)(const void *)(in + by_key);
+    index->count = count;
+    return 0;
+}
+
+// Matches of a sorted run starting at first; copies record indices to out
+static uint32_t collect(const uint32_t *table, uint32_t first, uint32_t end, uint32_t *out, uint32_t max) {
+    for (uint32_t i = first; i < end && i - first < max; i++) out[i - first] = table ? table[i] : i;
+    return end - first;
+}
+
+uint32_t abc_index_find_number(const AbcIndex *index, uint32_t number, uint32_t *out, uint32_t max) {
+    if (!index || (!out && max > 0)) return 0;
+    const AbcIndexRecord *r = index->records;
+    uint32_t lo = 0, hi = index->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (r[mid].number < number) lo = mid + 1;
+        else hi = mid;
+    }
+    uint32_t end = lo;
+    while (end < index->count && r[end].number == number) end++;
+    return collect(NULL, lo, end, out, max);
+}
+
+uint32_t abc_index_find_title(const AbcIndex *index, const char *title, uint32_t *out, uint32_t max) {
+    if (!index || !title || (!out && max > 0)) return 0;
+    uint32_t hash = abc_index_title_hash(title, (uint32_t)strlen(title));
+    const AbcIndexRecord *r = index->records;
+    uint32_t lo = 0, hi = index->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (r[index->by_title[mid]].title_hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+    uint32_t end = lo;
+    while (end < index->count && r[index->by_title[end]].title_hash == hash) end++;
+    return collect(index->by_title, lo, end, out, max);
+}
+
+uint32_t abc_index_find_key(const AbcIndex *index, const char *key, uint32_t *out, uint32_t max) {
+    if (!index || !key || (!out && max > 0)) return 0;
+    char padded[ABC_INDEX_KEY_LEN] = { 0 };
+    for (uint8_t i = 0; i < ABC_INDEX_KEY_LEN && key[i]; i++) padded[i] = key[i];
+
+    const AbcIndexRecord *r = index->records;
+    uint32_t lo = 0, hi = index->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (memcmp(r[index->by_key[mid]].key, padded, ABC_INDEX_KEY_LEN) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    uint32_t end = lo;
+    while (end < index->count && memcmp(r[index->by_key[end]].key, padded, ABC_INDEX_KEY_LEN) == 0) end++;
+    return collect(index->by_key, lo, end, out, max);
+}
+
+int abc_index_parse(const AbcIndexRecord *record, const char *text, uint32_t size, struct sheet *sheet) {
+    if (!record || !text) return -1;
+    if (record->offset > size || record->length > size - record->offset) return -3;
+    const char *tune = text + record->offset;
+    if (abc_image_checksum(tune, record->length) != record->text_hash) return -3;
+    return abc_parse_len(sheet, tune, record->length > 0xFFFF ? 0xFFFF : (uint16_t)record->length);
+}
@@ -0,0 +1,119 @@
+#ifndef ABC_INDEX_H
+#define ABC_INDEX_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Songbook index - tune lookup across large collections
+// ============================================================================
+//
+// A flat, versioned file with one fixed-size record per tune: which file it
+// is in, where, its X: number, title hash, key, meter, voice and note counts.
+// A service maps the index once and then finds a tune by number, title or key
+// with a binary search and parses it in place with abc_index_parse(), without
+// rescanning the collection.
+//
+// Building is split so files can be scanned in parallel: abc_index_scan() is
+// independent per file (give each thread its own slice of the record array),
+// then abc_index_write() sorts all records and writes the index.
+//
+// All multi-byte fields are little-endian. Records use the same byte layout
+// as AbcIndexRecord on little-endian hosts, so abc_index_open() reads them in
+// place (flash, mmap, ...).
+//
+// Layout (offsets in bytes):
+//   0   header (32 bytes): magic "ABCX", version, sizes, checksum, counts
+//   32  records (40 bytes each), sorted by X: number, file and offset
+//   ..  title table: record indices (uint32) sorted by title hash
+//   ..  key table: record indices (uint32) sorted by key text
+//
+// The checksum is FNV-1a (abc_image_checksum) over every byte after the
+// checksum field. Each record also holds the FNV-1a of its tune's text, so a
+// source file edited since the index was built is detected on parse.
+
+#define ABC_INDEX_VERSION 1
+#define ABC_INDEX_HEADER_SIZE 32
+#define ABC_INDEX_KEY_LEN 8         // K: bytes stored per tune (NUL-padded)
+#define ABC_INDEX_SCRATCH 0x10000   // Scratch bytes abc_index_scan() needs
+
+// Record flags
+#define ABC_INDEX_LONG 0x01         // Tune longer than 65535 bytes; only the start is parsed
+#define ABC_INDEX_OVERSIZE 0x02     // A voice needs more notes than a pool can index
+
+typedef struct {
+    uint32_t offset;            // Byte offset of the tune in its file
+    uint32_t length;            // Tune bytes (up to the blank line or next X:)
+    uint32_t number;            // X: number (0 = none)
+    uint32_t title_hash;        // abc_index_title_hash() of T: (0 = no title)
+    uint32_t text_hash;         // FNV-1a of the tune's bytes
+    uint32_t note_count;        // Notes abc_parse() stores, all voices
+    uint16_t file_id;           // Caller's number for the source file
+    uint8_t meter_num;          // 0 = no M: (C and C| read as 4/4 and 2/2)
+    uint8_t meter_den;
+    char key[ABC_INDEX_KEY_LEN];  // K: text, NUL-padded (not terminated if 8 long)
+    uint8_t voice_count;
+    uint8_t flags;              // ABC_INDEX_LONG, ABC_INDEX_OVERSIZE
+    uint16_t reserved;
+} AbcIndexRecord;
+
+// An opened index (points into the caller's data)
+typedef struct {
+    const AbcIndexRecord *records;
+    const uint32_t *by_title;
+    const uint32_t *by_key;
+    uint32_t count;
+} AbcIndex;
+
+// Case-insensitive (ASCII) FNV-1a of a title; never 0
+uint32_t abc_index_title_hash(const char *title, uint32_t len);
+
+// ============================================================================
+// Building
+// ============================================================================
+
+// Append a record for every tune in one collection file
+// A tune starts at an X: line and ends at a blank line or the next X: line;
+// text before the first X: is skipped. A file without X: lines is one tune.
+// scratch: ABC_INDEX_SCRATCH bytes used to measure one tune at a time
+// Returns records written, or negative on error
+//   -1: NULL input
+//   -2: more tunes than capacity (the first `capacity` records are filled)
+int32_t abc_index_scan(const char *text, uint32_t size, uint16_t file_id,
+                       AbcIndexRecord *records, uint32_t capacity, char *scratch);
+
+// Sort records (in place) and write the index
+// buffer: destination (NULL to query the required size)
+// Returns index size in bytes, or negative on error
+//   -1: NULL records with a nonzero count
+//   -2: buffer too small
+int32_t abc_index_write(AbcIndexRecord *records, uint32_t count, void *buffer, uint32_t buffer_size);
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+// Check an index (bounds and checksum) and point `index` into it
+// data must stay valid while the index is used, and be 4-byte aligned
+// Returns 0 on success, negative on error
+//   -1: NULL input
+//   -3: corrupt index (bad magic, version, bounds or checksum)
+//   -4: index is valid but cannot be read in place (big-endian host, misaligned)
+int abc_index_open(AbcIndex *index, const void *data, uint32_t size);
+
+// Find tunes; each writes up to max record indices (into index->records) to
+// out and returns the total number of matches. Matches come in index order
+// (by X: number, then file and offset).
+uint32_t abc_index_find_number(const AbcIndex *index, uint32_t number, uint32_t *out, uint32_t max);
+// Matches share the title's hash; confirm with the parsed title if it matters
+uint32_t abc_index_find_title(const AbcIndex *index, const char *title, uint32_t *out, uint32_t max);
+// Exact K: text, e.g. "Ador" (only the first ABC_INDEX_KEY_LEN bytes compare)
+uint32_t abc_index_find_key(const AbcIndex *index, const char *key, uint32_t *out, uint32_t max);
+
+// Parse a record's tune straight from its file's text
+// text/size: the whole file the record's file_id refers to
+// Returns abc_parse()'s result, or -3 if the tune's bytes no longer match the
+// record (file changed since the index was built)
+int abc_index_parse(const AbcIndexRecord *record, const char *text, uint32_t size, struct sheet *sheet);
+
+#endif // ABC_INDEX_H
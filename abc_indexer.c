@@ -0,0 +1,140 @@
+// abcindex - build and query songbook indexes (host tool)
+//
+// Scans ABC collection files into an index file (abc_index.h) and looks tunes
+// up in it. File ids are the files' positions on the build command line, so
+// pass the same files in the same order to `find` to parse the matches.
+//
+// Usage: abcindex build <out.idx> <file.abc>...
+//        abcindex find <index.idx> number|title|key <value> [<file.abc>...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "abc_index.h"
+
+#define INDEX_MAX_VOICES 16
+#define INDEX_MAX_NOTES 4096
+#define INDEX_MAX_MATCHES 64
+
+static char *read_file(const char *path, uint32_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (len < 0 || len > 0x7FFFFFFF) { fclose(f); return NULL; }
+
+    // Allocated as uint32_t so an index can be read in place
+    char *buf = malloc(((size_t)len + 4) & ~(size_t)3);
+    if (buf && fread(buf, 1, (size_t)len, f) != (size_t)len) { free(buf); buf = NULL; }
+    fclose(f);
+    *size = (uint32_t)len;
+    return buf;
+}
+
+static int build(const char *out_path, char **files, int file_count) {
+    uint32_t capacity = 1024, count = 0;
+    AbcIndexRecord *records = malloc(capacity * sizeof(AbcIndexRecord));
+    char *scratch = malloc(ABC_INDEX_SCRATCH);
+    if (!records || !scratch) return 1;
+
+    for (int f = 0; f < file_count; f++) {
+        uint32_t size;
+        char *text = read_file(files[f], &size);
+        if (!text) {
+            fprintf(stderr, "abcindex: cannot read %s\n", files[f]);
+            return 1;
+        }
+        // Grow the record array until the file's tunes fit
+        int32_t n;
+        while ((n = abc_index_scan(text, size, (uint16_t)f, records + count, capacity - count, scratch)) == -2) {
+            capacity *= 2;
+            AbcIndexRecord *grown = realloc(records, capacity * sizeof(AbcIndexRecord));
+            if (!grown) return 1;
+            records = grown;
+        }
+        count += (uint32_t)n;
+        free(text);
+    }
+
+    int32_t size = abc_index_write(records, count, NULL, 0);
+    uint8_t *index = size > 0 ? malloc((size_t)size) : NULL;
+    if (!index || abc_index_write(records, count, index, (uint32_t)size) != size) return 1;
+
+    FILE *out = fopen(out_path, "wb");
+    if (!out || fwrite(index, 1, (size_t)size, out) != (size_t)size) {
+        fprintf(stderr, "abcindex: cannot write %s\n", out_path);
+        if (out) fclose(out);
+        return 1;
+    }
+    fclose(out);
+    printf("%lu tunes from %d files, %ld bytes\n", (unsigned long)count, file_count, (long)size);
+    free(index);
+    free(records);
+    free(scratch);
+    return 0;
+}
+
+static void print_match(const AbcIndexRecord *r, char **files, int file_count) {
+    printf("file %u  offset %lu  X:%lu  K:%.*s  M:%u/%u  %u voices  %lu notes",
+           r->file_id, (unsigned long)r->offset, (unsigned long)r->number, ABC_INDEX_KEY_LEN, r->key,
+           r->meter_num, r->meter_den, r->voice_count, (unsigned long)r->note_count);
+    if (r->file_id >= file_count) {
+        printf("\n");
+        return;
+    }
+
+    static NotePool pools[INDEX_MAX_VOICES];
+    static struct note storage[INDEX_MAX_VOICES][INDEX_MAX_NOTES];
+    struct sheet sheet;
+    for (int v = 0; v < INDEX_MAX_VOICES; v++) {
+        note_pool_init(&pools[v], storage[v], INDEX_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    sheet_init(&sheet, pools, INDEX_MAX_VOICES);
+
+    uint32_t size;
+    char *text = read_file(files[r->file_id], &size);
+    int result = text ? abc_index_parse(r, text, size, &sheet) : -1;
+    if (result == -3) printf("  (file changed since indexing)\n");
+    else if (result < 0) printf("  (parse failed: %d)\n", result);
+    else printf("  \"%s\"\n", sheet.title);
+    free(text);
+}
+
+static int find(const char *index_path, const char *field, const char *value, char **files, int file_count) {
+    uint32_t size;
+    char *data = read_file(index_path, &size);
+    AbcIndex index;
+    int result = data ? abc_index_open(&index, data, size) : -1;
+    if (result < 0) {
+        fprintf(stderr, "abcindex: %s: %s\n", index_path, result == -3 ? "corrupt index" : "cannot open");
+        free(data);
+        return 1;
+    }
+
+    uint32_t matches[INDEX_MAX_MATCHES], total;
+    if (!strcmp(field, "number")) total = abc_index_find_number(&index, (uint32_t)strtoul(value, NULL, 10), matches, INDEX_MAX_MATCHES);
+    else if (!strcmp(field, "title")) total = abc_index_find_title(&index, value, matches, INDEX_MAX_MATCHES);
+    else if (!strcmp(field, "key")) total = abc_index_find_key(&index, value, matches, INDEX_MAX_MATCHES);
+    else {
+        fprintf(stderr, "abcindex: unknown field %s (number, title or key)\n", field);
+        free(data);
+        return 2;
+    }
+
+    for (uint32_t i = 0; i < total && i < INDEX_MAX_MATCHES; i++) {
+        print_match(&index.records[matches[i]], files, file_count);
+    }
+    if (total > INDEX_MAX_MATCHES) printf("... %lu matches in all\n", (unsigned long)total);
+    free(data);
+    return total ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 4 && !strcmp(argv[1], "build")) return build(argv[2], argv + 3, argc - 3);
+    if (argc >= 5 && !strcmp(argv[1], "find")) return find(argv[2], argv[3], argv[4], argv + 5, argc - 5);
+
+    fprintf(stderr, "usage: %s build <out.idx> <file.abc>...\n"
+                    "       %s find <index.idx> number|title|key <value> [<file.abc>...]\n", argv[0], argv[0]);
+    return 2;
+}
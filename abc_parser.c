@@ -1,4 +1,7 @@
 #include "abc_parser.h"
+#if ABC_TRACE
+#include "abc_trace.h"
+#endif
 #include <stdio.h>
 #include <string.h>
 
@@ -35,6 +38,21 @@ const uint16_t midi_frequencies_x10[128] = {
 // Map note names to semitone offsets from C
 static const int8_t note_to_semitone[7] = { 0, 2, 4, 5, 7, 9, 11 };
 
+// ============================================================================
+// Atomics for publication (override for compilers without GNU builtins)
+// ============================================================================
+
+#ifndef ABC_STORE_RELEASE
+#if defined(__GNUC__) || defined(__clang__)
+#define ABC_STORE_RELEASE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define ABC_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#else
+// Plain accesses: define both macros with the platform's barriers for multi-core use
+#define ABC_STORE_RELEASE(ptr, val) (*(ptr) = (val))
+#define ABC_LOAD_ACQUIRE(ptr) (*(ptr))
+#endif
+#endif
+
 // ============================================================================
 // Key signature data
 // ============================================================================
@@ -76,32 +94,6 @@ static const KeySignature key_signatures[] = {
     {NULL, {0}}
 };
 
-// ============================================================================
-// Parser state (stack allocated during parsing)
-// ============================================================================
-
-typedef struct {
-    const char *input;
-    uint16_t pos;
-    uint16_t len;
-    uint16_t tempo_bpm;
-    uint8_t default_num;
-    uint8_t default_den;
-    uint8_t meter_num;
-    uint8_t meter_den;
-    uint8_t tempo_note_num;
-    uint8_t tempo_note_den;
-    int8_t key_accidentals[7];
-    int8_t bar_accidentals[7];
-    int16_t repeat_start_index;
-    int16_t repeat_end_index;
-    uint8_t in_repeat;
-    uint8_t tuplet_remaining;
-    uint8_t tuplet_num;
-    uint8_t tuplet_in_time;
-    uint8_t current_voice;       // Current voice index
-} ParserState;
-
 // ============================================================================
 // Utility functions
 // ============================================================================
@@ -189,6 +181,11 @@ void note_pool_init(NotePool *pool, struct note *buffer, uint16_t capacity, uint
     pool->tail_index = -1;
     pool->total_ticks = 0;
     pool->voice_id[0] = '\0';
+    pool->allocator = NULL;
+}
+
+void note_pool_set_allocator(NotePool *pool, const AbcAllocator *allocator) {
+    if (pool) pool->allocator = allocator;
 }
 
 void note_pool_reset(NotePool *pool) {
@@ -201,11 +198,31 @@ void note_pool_reset(NotePool *pool) {
 }
 
 int note_pool_available(const NotePool *pool) {
-    return pool ? (pool->capacity - pool->count) : 0;
+    return (pool && pool->capacity > pool->count) ? (pool->capacity - pool->count) : 0;
+}
+
+// Move a pool into larger storage from its allocator
+static int note_pool_grow(NotePool *pool, uint16_t min_capacity) {
+    if (!pool->allocator || !pool->allocator->grow || min_capacity > 0x7FFF) return -1;
+    uint16_t capacity = 0;
+    struct note *notes = pool->allocator->grow(pool->allocator->ctx, pool->notes, pool->count,
+                                               min_capacity, &capacity);
+    if (!notes || capacity < min_capacity) return -1;
+    pool->notes = notes;
+    pool->capacity = capacity > 0x7FFF ? 0x7FFF : capacity;
+    return 0;
+}
+
+int note_pool_reserve(NotePool *pool, uint16_t capacity) {
+    if (!pool) return -1;
+    if (pool->notes && pool->capacity >= capacity) return 0;
+    return note_pool_grow(pool, capacity);
 }
 
 static int16_t note_pool_alloc(NotePool *pool) {
-    if (!pool || !pool->notes || pool->count >= pool->capacity) return -1;
+    if (!pool) return -1;
+    if ((!pool->notes || pool->count >= pool->capacity) &&
+        note_pool_grow(pool, (uint16_t)(pool->count + 1)) < 0) return -1;
     int16_t index = (int16_t)pool->count;
     pool->count++;
     struct note *n = &pool->notes[index];
@@ -238,6 +255,10 @@ void sheet_init(struct sheet *sheet, NotePool *pools, uint8_t pool_count) {
     sheet->default_note_den = 8;
     sheet->meter_num = 4;
     sheet->meter_den = 4;
+    sheet->publication = NULL;
+#if ABC_TRACE
+    sheet->trace = NULL;
+#endif
     // Note: pools should already be initialized by caller via note_pool_init_ext()
 }
 
@@ -279,16 +300,78 @@ struct note *sheet_first_note(const struct sheet *sheet) {
     return pool_first_note(&sheet->pools[0]);
 }
 
-// Append a note/chord to a specific pool (stores only MIDI notes)
-static int pool_append_note(NotePool *pool, uint8_t chord_size,
-                            NoteName *names, int *octaves,
-                            int8_t *accs, uint8_t duration_ticks) {
-    if (!pool) return -1;
+// ============================================================================
+// Publication (parse while playing)
+// ============================================================================
 
-    int16_t index = note_pool_alloc(pool);
-    if (index < 0) return -1;
+void sheet_set_publication(struct sheet *sheet, AbcPublication *pub) {
+    if (!sheet) return;
+    if (pub) memset(pub, 0, sizeof(*pub));
+    sheet->publication = pub;
+}
 
-    struct note *n = &pool->notes[index];
+#if ABC_TRACE
+void sheet_set_trace(struct sheet *sheet, struct AbcTrace *trace) {
+    if (sheet) sheet->trace = trace;
+}
+#endif
+
+// Storage must stay put and every voice must have a counter
+static int publication_valid(const struct sheet *sheet) {
+    if (!sheet->publication) return 1;
+    if (sheet->pool_count > ABC_PUBLISH_MAX_VOICES) return 0;
+    for (uint8_t v = 0; v < sheet->pool_count; v++) {
+        if (sheet->pools[v].allocator) return 0;
+    }
+    return 1;
+}
+
+// Notes are complete before their count is released, voice IDs before voice_count
+static void publish_voice(const struct sheet *sheet, uint8_t voice) {
+    AbcPublication *pub = sheet->publication;
+    ABC_STORE_RELEASE(&pub->count[voice], sheet->pools[voice].count);
+    ABC_STORE_RELEASE(&pub->voice_count, sheet->voice_count);
+}
+
+static void publish_all(const struct sheet *sheet, int done, int result) {
+    for (uint8_t v = 0; v < sheet->voice_count; v++) publish_voice(sheet, v);
+    if (done) {
+        sheet->publication->result = (int8_t)result;
+        ABC_STORE_RELEASE(&sheet->publication->done, 1);
+    }
+}
+
+void abc_reader_init(AbcReader *reader, const struct sheet *sheet, uint8_t voice) {
+    if (!reader) return;
+    reader->sheet = sheet;
+    reader->voice = voice;
+    reader->next = 0;
+}
+
+int abc_reader_next(AbcReader *reader, struct note *note) {
+    if (!reader || !note || !reader->sheet || !reader->sheet->publication) return -1;
+    const AbcPublication *pub = reader->sheet->publication;
+    if (reader->voice >= ABC_PUBLISH_MAX_VOICES) return -1;
+
+    // Read done first: once it is set, the counts are final
+    uint8_t done = ABC_LOAD_ACQUIRE(&pub->done);
+    uint16_t count = ABC_LOAD_ACQUIRE(&pub->count[reader->voice]);
+    if (reader->next >= count) return done ? -1 : 0;
+
+    // Copy field by field: the parser may still be linking next_index
+    const struct note *src = &reader->sheet->pools[reader->voice].notes[reader->next++];
+    note->next_index = -1;
+    note->duration = src->duration;
+    note->chord_size = src->chord_size;
+    for (uint8_t i = 0; i < src->chord_size && i < ABC_MAX_CHORD_NOTES; i++) {
+        note->midi_note[i] = src->midi_note[i];
+    }
+    return 1;
+}
+
+// Fill a freshly allocated note/chord (stores only MIDI notes)
+static void note_fill(const NotePool *pool, struct note *n, uint8_t chord_size,
+                      const uint8_t *midi, uint8_t duration_ticks) {
     // Clamp chord size to pool's max (and struct's compile-time max)
     uint8_t max_chord = pool->max_chord_notes;
     if (max_chord > ABC_MAX_CHORD_NOTES) max_chord = ABC_MAX_CHORD_NOTES;
@@ -300,8 +383,24 @@ static int pool_append_note(NotePool *pool, uint8_t chord_size,
 
     for (uint8_t i = 0; i < chord_size; i++) {
         // Only store MIDI note - other properties derived on demand
-        n->midi_note[i] = (uint8_t)note_to_midi(names[i], octaves[i], accs[i]);
+        n->midi_note[i] = midi[i];
     }
+}
+
+// Repeat copies keep each pitch's natural note name and octave only
+static uint8_t repeat_copy_pitch(uint8_t midi) {
+    return (uint8_t)note_to_midi(midi_to_note_name(midi), midi_to_octave(midi), ACC_NONE);
+}
+
+// Append a note/chord to a specific pool (stores only MIDI notes)
+static int pool_append_note(NotePool *pool, uint8_t chord_size,
+                            const uint8_t *midi, uint8_t duration_ticks) {
+    if (!pool) return -1;
+
+    int16_t index = note_pool_alloc(pool);
+    if (index < 0) return -1;
+
+    note_fill(pool, &pool->notes[index], chord_size, midi, duration_ticks);
 
     if (pool->head_index < 0) {
         pool->head_index = index;
@@ -327,12 +426,87 @@ static inline char advance(ParserState *s) {
     return (s->pos < s->len) ? s->input[s->pos++] : '\0';
 }
 
+// abc_parse_stats() counters: a NULL check per token, or nothing when compiled out
+#if ABC_PARSE_STATS
+#define STAT_ADD(s, field, n) do { if ((s)->stats) (s)->stats->field += (n); } while (0)
+#else
+#define STAT_ADD(s, field, n) ((void)0)
+#endif
+
+// Phase timing hooks (abc_trace.h); nothing at all unless ABC_TRACE
+#if ABC_TRACE
+#define TRACE_ENTER(s, phase) do { if ((s)->trace) abc_trace_enter((s)->trace, phase); } while (0)
+#define TRACE_EXIT(s) do { if ((s)->trace) abc_trace_exit((s)->trace); } while (0)
+#else
+#define TRACE_ENTER(s, phase) ((void)(s))
+#define TRACE_EXIT(s) ((void)(s))
+#endif
+
+// Step mode: has this step used up its work budget?
+static int step_spent(const ParserState *s) {
+    const AbcStepParser *st = s->step;
+    return (uint32_t)(s->pos - st->step_pos) + st->copied >= st->limit;
+}
+
+// Token size caps, so one token (and the overrun of a step) stays small:
+//   - runs of one kind inside a token (accidentals, octave marks, digits,
+//     slashes, blanks after V:) are read up to ABC_RUN_LIMIT bytes; the rest
+//     of the run is read as the next token
+//   - a chord is scanned for ABC_CHORD_SCAN_LIMIT bytes after its '['
+//   - header values and voice IDs keep their first ABC_FIELD_LIMIT bytes; the
+//     rest is skipped (by skip_rest, so step mode can split it)
+// A step reads at most ABC_STEP_MAX_TOKEN bytes past its budget (a V: with
+// the most blanks and the longest ID).
+#define ABC_RUN_LIMIT 16
+#define ABC_CHORD_SCAN_LIMIT 64
+#define ABC_FIELD_LIMIT 255
+
+// Step mode stops at the end of the budget; the next step skips the rest
 static void skip_whitespace(ParserState *s) {
     while (s->pos < s->len) {
         char c = s->input[s->pos];
-        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') s->pos++;
-        else break;
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        if (s->step && step_spent(s)) break;
+        s->pos++;
+    }
+}
+
+static int voice_id_char(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+// Text skipped whole: an annotation, or what is left of a header line or a
+// voice ID past ABC_FIELD_LIMIT
+#define SKIP_NONE 0
+#define SKIP_ANNOTATION 1       // Up to and including the closing '"'
+#define SKIP_LINE 2             // Up to and including the line break
+#define SKIP_VOICE_ID 3         // Up to the first byte that is not an ID byte
+
+// Returns 1 if a step's budget ran out first (step_drain() resumes the skip)
+static int skip_rest(ParserState *s, uint8_t skip) {
+    while (s->pos < s->len) {
+        char c = peek(s);
+        if (skip == SKIP_VOICE_ID ? !voice_id_char(c) :
+            skip == SKIP_ANNOTATION ? c == '"' : (c == '\n' || c == '\r')) {
+            if (skip != SKIP_VOICE_ID) advance(s);
+            break;
+        }
+        if (s->step && step_spent(s)) {
+            s->step->skipping = skip;
+            return 1;
+        }
+        advance(s);
     }
+    return 0;
+}
+
+// Append a decimal digit; numbers saturate at ABC_NUMBER_LIMIT so long digit
+// runs cannot overflow (and durations still fit uint32_t before clamping)
+#define ABC_NUMBER_LIMIT 9999
+static int add_digit(int value, char digit) {
+    value = value * 10 + (digit - '0');
+    return value > ABC_NUMBER_LIMIT ? ABC_NUMBER_LIMIT : value;
 }
 
 // Calculate duration in MIDI ticks (PPQ-based)
@@ -364,6 +538,7 @@ static void set_key_signature(ParserState *s, const char *key) {
         }
     }
     memset(s->key_accidentals, 0, 7);
+    STAT_ADD(s, key_fallbacks, 1);
 }
 
 static void safe_strcpy(char *dest, uint8_t dest_size, const char *src, uint8_t src_len) {
@@ -372,20 +547,158 @@ static void safe_strcpy(char *dest, uint8_t dest_size, const char *src, uint8_t
     dest[len] = '\0';
 }
 
+// ============================================================================
+// Editor re-parse state (see abc_editor_edit)
+// ============================================================================
+
+// While the editor re-parses, new notes are linked after per-voice cursors
+// instead of the pool tails, so the old continuation stays intact for splicing.
+struct AbcEditRun {
+    AbcEditor *editor;
+    int16_t tail[ABC_EDIT_MAX_VOICES];      // Last note of the new list so far
+    uint16_t notes[ABC_EDIT_MAX_VOICES];    // List length so far
+    uint32_t ticks[ABC_EDIT_MAX_VOICES];
+    int16_t old_next[ABC_EDIT_MAX_VOICES];  // What followed each resume tail in the old lists
+    uint8_t linear;             // Fresh parse: list position == note index
+    uint8_t converged;
+    uint16_t base;              // First checkpoint slot this run writes
+    uint16_t write;             // Next checkpoint slot
+    uint16_t old_read;          // Unconsumed old checkpoints, parked at the top of the array
+    uint16_t old_end;
+    uint16_t edit_end;          // First unchanged byte after the edit (new offsets)
+    int32_t delta;              // New offset - old offset for text after the edit
+    uint16_t last_pos;          // Loop position already handled (skips the resume point)
+};
+
+static int edit_append(ParserState *s, struct sheet *sheet, uint8_t chord_size,
+                       const uint8_t *midi, uint8_t duration_ticks) {
+    struct AbcEditRun *run = s->edit;
+    uint8_t v = s->current_voice;
+    NotePool *pool = &sheet->pools[v];
+
+    int16_t index = note_pool_alloc(pool);
+    if (index < 0) return -1;
+    note_fill(pool, &pool->notes[index], chord_size, midi, duration_ticks);
+
+    if (run->tail[v] < 0) pool->head_index = index;
+    else pool->notes[run->tail[v]].next_index = index;
+    run->tail[v] = index;
+    run->notes[v]++;
+    run->ticks[v] += duration_ticks;
+    return 0;
+}
+
+// ============================================================================
+// Event mode state (see abc_parse_events)
+// ============================================================================
+
+struct AbcEventSink {
+    const AbcEventCallbacks *cb;
+    void *user;
+    uint8_t stopped;            // A callback returned nonzero
+    char voice_id[ABC_EVENT_MAX_VOICES][ABC_MAX_VOICE_ID_LEN];
+};
+
+// Record a callback's answer; returns -1 once the parse should stop
+static int event_result(struct AbcEventSink *ev, int result) {
+    if (result != 0) ev->stopped = 1;
+    return ev->stopped ? -1 : 0;
+}
+
+static int event_voice(ParserState *s) {
+    struct AbcEventSink *ev = s->events;
+    if (!ev->cb->voice) return 0;
+    return event_result(ev, ev->cb->voice(ev->user, s->current_voice, ev->voice_id[s->current_voice]));
+}
+
+static int event_bar(ParserState *s, AbcBarType type) {
+    struct AbcEventSink *ev = s->events;
+    if (!ev->cb->bar) return 0;
+    return event_result(ev, ev->cb->bar(ev->user, type));
+}
+
+static int event_note(ParserState *s, uint8_t chord_size, const uint8_t *midi, uint8_t duration_ticks) {
+    struct AbcEventSink *ev = s->events;
+    if (!ev->cb->note) return 0;
+    if (chord_size > ABC_MAX_CHORD_NOTES) chord_size = ABC_MAX_CHORD_NOTES;
+    return event_result(ev, ev->cb->note(ev->user, s->current_voice, midi, chord_size, duration_ticks));
+}
+
+// ============================================================================
+// Cursor mode (see abc_cursor_next)
+// ============================================================================
+
+// Hand a note of the followed voice to the cursor; the body loop then stops
+static int cursor_note(ParserState *s, uint8_t chord_size, const uint8_t *midi, uint8_t duration_ticks) {
+    AbcCursor *cur = s->cursor;
+    if (s->current_voice != cur->voice) return 0;
+
+    struct note *n = cur->out;
+    if (chord_size > ABC_MAX_CHORD_NOTES) chord_size = ABC_MAX_CHORD_NOTES;
+    n->next_index = -1;
+    n->duration = duration_ticks;
+    n->chord_size = chord_size;
+    for (uint8_t i = 0; i < chord_size; i++) {
+        // Replayed notes lose their accidentals, exactly like copy_repeat_section
+        n->midi_note[i] = (s == &cur->replay) ? repeat_copy_pitch(midi[i]) : midi[i];
+    }
+    cur->ready = 1;
+    return 0;
+}
+
+// A :| in the followed voice: replay from the saved |: up to here
+static void cursor_repeat(ParserState *s, int16_t start_idx) {
+    AbcCursor *cur = s->cursor;
+    if (s != &cur->state || start_idx < 0) return;
+    if (s->current_voice != cur->voice || s->repeat_voice != cur->voice) return;
+    // Stop the replay at the ':' of ":|" (already past ":|:" when called for one)
+    uint16_t end = (uint16_t)(s->pos - 2);
+    if (s->input[end] != ':') end--;
+    cur->replay = cur->repeat;
+    cur->replay_end = end;
+    cur->replaying = 1;
+}
+
+// Checked at the top of the body loop: stop to hand out a note or switch states
+static int cursor_pause(ParserState *s) {
+    AbcCursor *cur = s->cursor;
+    if (cur->ready) return 1;
+    if (s == &cur->state) return cur->replaying;
+    if (s->pos >= cur->replay_end) {
+        cur->replaying = 0;
+        return 1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Voice storage (pools when parsing, the measure report during a dry run)
+// ============================================================================
+
+static char *voice_id_slot(ParserState *s, struct sheet *sheet, uint8_t idx) {
+    if (s->events) return s->events->voice_id[idx];
+    if (s->cursor) return s->cursor->voice_id[idx];
+    return s->measure ? s->measure->voice_id[idx] : sheet->pools[idx].voice_id;
+}
+
 // Find or create a voice by ID, returns voice index
-static int find_or_create_voice(struct sheet *sheet, const char *voice_id, uint8_t id_len) {
+static int find_or_create_voice(ParserState *s, struct sheet *sheet, const char *voice_id, uint8_t id_len) {
     // Search existing voices
     for (uint8_t i = 0; i < sheet->voice_count; i++) {
-        if (strncmp(sheet->pools[i].voice_id, voice_id, id_len) == 0 &&
-            sheet->pools[i].voice_id[id_len] == '\0') {
+        const char *id = voice_id_slot(s, sheet, i);
+        if (strncmp(id, voice_id, id_len) == 0 && id[id_len] == '\0') {
             return i;
         }
     }
 
+    // Editor: a resumed parse may not change the voice layout (returns -2 to
+    // request a full re-parse, which also restores the old voice IDs' slots)
+    if (s->edit && !s->edit->linear) return -2;
+
     // Create new voice if space available
     if (sheet->voice_count < sheet->pool_count) {
         uint8_t idx = sheet->voice_count;
-        safe_strcpy(sheet->pools[idx].voice_id, ABC_MAX_VOICE_ID_LEN, voice_id, id_len);
+        safe_strcpy(voice_id_slot(s, sheet, idx), ABC_MAX_VOICE_ID_LEN, voice_id, id_len);
         sheet->voice_count++;
         return idx;
     }
@@ -393,28 +706,106 @@ static int find_or_create_voice(struct sheet *sheet, const char *voice_id, uint8
     return -1; // No space for more voices
 }
 
+// Number of notes stored so far in the current voice
+static int16_t voice_note_count(ParserState *s, struct sheet *sheet) {
+    if (s->measure) return (int16_t)s->measure->notes[s->current_voice];
+    if (s->edit) return (int16_t)s->edit->notes[s->current_voice];
+    if (s->events || s->cursor) return 0;  // Repeats are reported or replayed, not copied
+    if (s->step) return (int16_t)(sheet->pools[s->current_voice].count + s->step->copy_pending);
+    return (int16_t)sheet->pools[s->current_voice].count;
+}
+
+// Store a parsed note/chord in the current voice
+static int voice_append(ParserState *s, struct sheet *sheet, uint8_t chord_size,
+                        const uint8_t *midi, uint8_t duration_ticks) {
+    AbcMeasureReport *m = s->measure;
+    if (s->edit) return edit_append(s, sheet, chord_size, midi, duration_ticks);
+    if (s->events) return event_note(s, chord_size, midi, duration_ticks);
+    if (s->cursor) return cursor_note(s, chord_size, midi, duration_ticks);
+    if (!m) {
+        TRACE_ENTER(s, ABC_TRACE_APPEND);
+        int result = pool_append_note(&sheet->pools[s->current_voice], chord_size, midi, duration_ticks);
+        TRACE_EXIT(s);
+        return result;
+    }
+    if (m->notes[s->current_voice] >= 0x7FFF) return -1;  // Beyond what a NotePool can index
+    m->notes[s->current_voice]++;
+    m->total_notes++;
+    if (chord_size > m->max_chord_size) m->max_chord_size = chord_size;
+    if (duration_ticks > m->max_duration) m->max_duration = duration_ticks;
+    return 0;
+}
+
 // ============================================================================
 // Header parsing
 // ============================================================================
 
-static void parse_header(ParserState *s, struct sheet *sheet) {
-    while (s->pos < s->len) {
-        skip_whitespace(s);
-        if (s->pos + 1 >= s->len || s->input[s->pos + 1] != ':') break;
+// One "F:value" header line
+typedef struct {
+    char field;
+    uint16_t start;             // Value, trimmed of surrounding blanks
+    uint16_t end;
+    uint16_t next;              // First byte after the line break, or after the value
+    uint8_t more;               // The line goes on past ABC_FIELD_LIMIT (skip the rest)
+} HeaderLine;
+
+// Split the header line at s->pos (after whitespace)
+// Returns 0 if the text there is not a header field
+static int header_line(ParserState *s, HeaderLine *line) {
+    skip_whitespace(s);
+    if (s->pos + 1 >= s->len || s->input[s->pos + 1] != ':') return 0;
+
+    line->field = s->input[s->pos];
+    uint16_t start = s->pos + 2;
+    uint16_t end = start;
+
+    while (end < s->len && end - start < ABC_FIELD_LIMIT && s->input[end] != '\n' && s->input[end] != '\r') end++;
+    uint16_t line_end = end;
+    line->more = 0;
+    if (end < s->len) {
+        if (s->input[end] == '\n' || s->input[end] == '\r') end++;
+        else line->more = 1;
+    }
 
-        char field = s->input[s->pos];
-        uint16_t start = s->pos + 2;
-        uint16_t end = start;
+    while (start < line_end && s->input[start] == ' ') start++;
+    while (line_end > start && (s->input[line_end-1] == ' ' || s->input[line_end-1] == '\t')) line_end--;
 
-        while (end < s->len && s->input[end] != '\n' && s->input[end] != '\r') end++;
-        uint16_t line_end = end;
-        if (end < s->len) end++;
+    line->start = start;
+    line->end = line_end;
+    line->next = end;
+    return 1;
+}
 
-        while (start < line_end && s->input[start] == ' ') start++;
-        while (line_end > start && (s->input[line_end-1] == ' ' || s->input[line_end-1] == '\t')) line_end--;
+static int parse_header_fields(ParserState *s, struct sheet *sheet);
+static int step_drain(ParserState *s, struct sheet *sheet);
 
-        uint8_t vlen = (uint8_t)(line_end - start);
-        const char *val = s->input + start;
+// Returns 1 if a step's budget ran out before the header ended
+static int parse_header(ParserState *s, struct sheet *sheet) {
+    TRACE_ENTER(s, ABC_TRACE_HEADER);
+    int result = parse_header_fields(s, sheet);
+    TRACE_EXIT(s);
+    return result;
+}
+
+static int parse_header_fields(ParserState *s, struct sheet *sheet) {
+    while (s->pos < s->len) {
+        if (s->step) {
+            if (step_drain(s, sheet)) return 1;
+            skip_whitespace(s);
+            if (step_spent(s)) return 1;
+        }
+        HeaderLine line;
+        if (!header_line(s, &line)) break;
+
+        char field = line.field;
+        uint16_t end = line.next;
+        uint8_t vlen = (uint8_t)(line.end - line.start);
+        const char *val = s->input + line.start;
+
+        if (s->events && field != 'V' && s->events->cb->header &&
+            event_result(s->events, s->events->cb->header(s->events->user, field, val, vlen)) < 0) {
+            return 0;
+        }
 
         switch (field) {
             case 'X': break; // Reference number, ignore
@@ -423,10 +814,10 @@ static void parse_header(ParserState *s, struct sheet *sheet) {
             case 'L': {
                 int num = 0, den = 0;
                 uint8_t i = 0;
-                while (i < vlen && val[i] >= '0' && val[i] <= '9') num = num * 10 + (val[i++] - '0');
+                while (i < vlen && val[i] >= '0' && val[i] <= '9') num = add_digit(num, val[i++]);
                 if (i < vlen && val[i] == '/') {
                     i++;
-                    while (i < vlen && val[i] >= '0' && val[i] <= '9') den = den * 10 + (val[i++] - '0');
+                    while (i < vlen && val[i] >= '0' && val[i] <= '9') den = add_digit(den, val[i++]);
                 }
                 if (num > 0 && den > 0) {
                     s->default_num = sheet->default_note_num = (uint8_t)num;
@@ -437,10 +828,10 @@ static void parse_header(ParserState *s, struct sheet *sheet) {
             case 'M': {
                 int num = 0, den = 0;
                 uint8_t i = 0;
-                while (i < vlen && val[i] >= '0' && val[i] <= '9') num = num * 10 + (val[i++] - '0');
+                while (i < vlen && val[i] >= '0' && val[i] <= '9') num = add_digit(num, val[i++]);
                 if (i < vlen && val[i] == '/') {
                     i++;
-                    while (i < vlen && val[i] >= '0' && val[i] <= '9') den = den * 10 + (val[i++] - '0');
+                    while (i < vlen && val[i] >= '0' && val[i] <= '9') den = add_digit(den, val[i++]);
                 }
                 if (num > 0 && den > 0) {
                     s->meter_num = sheet->meter_num = (uint8_t)num;
@@ -457,12 +848,12 @@ static void parse_header(ParserState *s, struct sheet *sheet) {
                 }
                 if (eq_pos > 0) {
                     while (i < eq_pos - 1 && val[i] >= '0' && val[i] <= '9') {
-                        note_num = note_num * 10 + (val[i++] - '0');
+                        note_num = add_digit(note_num, val[i++]);
                     }
                     if (i < eq_pos - 1 && val[i] == '/') {
                         i++;
                         while (i < eq_pos - 1 && val[i] >= '0' && val[i] <= '9') {
-                            note_den = note_den * 10 + (val[i++] - '0');
+                            note_den = add_digit(note_den, val[i++]);
                         }
                     }
                     if (note_num > 0 && note_den > 0) {
@@ -472,7 +863,7 @@ static void parse_header(ParserState *s, struct sheet *sheet) {
                 }
                 i = eq_pos;
                 while (i < vlen && val[i] >= '0' && val[i] <= '9') {
-                    tempo = tempo * 10 + (val[i++] - '0');
+                    tempo = add_digit(tempo, val[i++]);
                 }
                 if (tempo > 0) s->tempo_bpm = sheet->tempo_bpm = (uint16_t)tempo;
                 break;
@@ -481,14 +872,17 @@ static void parse_header(ParserState *s, struct sheet *sheet) {
                 safe_strcpy(sheet->key, ABC_MAX_KEY_LEN, val, vlen);
                 set_key_signature(s, sheet->key);
                 s->pos = end;
-                return;
+                if (line.more) skip_rest(s, SKIP_LINE);  // A step leaves the rest to the body's step_drain
+                return 0;
             }
             case 'V':
                 // V: marks start of body - don't consume it, let body parser handle it
-                return;
+                return 0;
         }
         s->pos = end;
+        if (line.more && skip_rest(s, SKIP_LINE)) return 1;
     }
+    return 0;
 }
 
 // ============================================================================
@@ -496,19 +890,48 @@ static void parse_header(ParserState *s, struct sheet *sheet) {
 // ============================================================================
 
 typedef struct {
-    NoteName name;
-    int octave;
-    int8_t accidental;
+    uint8_t midi;               // 0 = rest
     int dur_num;
     int dur_den;
 } ParsedPitch;
 
+// Read a run of digits (at most ABC_RUN_LIMIT) into *value
+static void parse_number(ParserState *s, int *value) {
+    *value = 0;
+    for (uint8_t n = 0; n < ABC_RUN_LIMIT && peek(s) >= '0' && peek(s) <= '9'; n++) {
+        *value = add_digit(*value, advance(s));
+    }
+}
+
+// Length suffix ("3", "/2", "3/4", "//"); leaves *num and *den alone where absent
+static void parse_length(ParserState *s, int *num, int *den) {
+    char c = peek(s);
+    if (c >= '0' && c <= '9') {
+        parse_number(s, num);
+        c = peek(s);
+    }
+    if (c == '/') {
+        advance(s);
+        c = peek(s);
+        if (c >= '0' && c <= '9') {
+            parse_number(s, den);
+            if (*den == 0) *den = 1;    // "/0" would divide by zero
+        } else {
+            *den = 2;
+            for (uint8_t n = 0; n < ABC_RUN_LIMIT && peek(s) == '/'; n++) {
+                advance(s);
+                if (*den <= ABC_NUMBER_LIMIT / 2) *den *= 2;
+            }
+        }
+    }
+}
+
 static int parse_pitch(ParserState *s, ParsedPitch *pitch) {
     char c = peek(s);
     int8_t acc = ACC_NONE;
     int explicit_acc = 0;
 
-    while (c == '^' || c == '_' || c == '=') {
+    for (uint8_t n = 0; n < ABC_RUN_LIMIT && (c == '^' || c == '_' || c == '='); n++) {
         explicit_acc = 1;
         if (c == '^') acc = (acc == ACC_SHARP) ? ACC_DOUBLE_SHARP : ACC_SHARP;
         else if (c == '_') acc = (acc == ACC_FLAT) ? ACC_DOUBLE_FLAT : ACC_FLAT;
@@ -533,7 +956,7 @@ static int parse_pitch(ParserState *s, ParsedPitch *pitch) {
     }
 
     c = peek(s);
-    while (c == '\'' || c == ',') {
+    for (uint8_t n = 0; n < ABC_RUN_LIMIT && (c == '\'' || c == ','); n++) {
         if (c == '\'') octave++; else octave--;
         advance(s);
         c = peek(s);
@@ -542,29 +965,10 @@ static int parse_pitch(ParserState *s, ParsedPitch *pitch) {
     if (octave > 6) octave = 6;
 
     // Parse duration modifiers
-    int num = 1, den = 1;
-    c = peek(s);
-    if (c >= '0' && c <= '9') {
-        num = 0;
-        while (c >= '0' && c <= '9') { num = num * 10 + (c - '0'); advance(s); c = peek(s); }
-    }
-    if (c == '/') {
-        advance(s);
-        c = peek(s);
-        if (c >= '0' && c <= '9') {
-            den = 0;
-            while (c >= '0' && c <= '9') { den = den * 10 + (c - '0'); advance(s); c = peek(s); }
-        } else {
-            den = 2;
-            while (peek(s) == '/') { advance(s); den *= 2; }
-        }
-    }
-
-    pitch->name = name;
-    pitch->octave = octave;
-    pitch->accidental = acc;
-    pitch->dur_num = num;
-    pitch->dur_den = den;
+    pitch->dur_num = 1;
+    pitch->dur_den = 1;
+    parse_length(s, &pitch->dur_num, &pitch->dur_den);
+    pitch->midi = (uint8_t)note_to_midi(name, octave, acc);
     return 0;
 }
 
@@ -577,35 +981,36 @@ static int parse_note_or_chord(ParserState *s, struct sheet *sheet) {
     if (s->pos >= s->len) return 1;
 
     char c = peek(s);
-    NotePool *pool = &sheet->pools[s->current_voice];
 
     // Handle chord [...]
     if (c == '[') {
+        uint16_t open = s->pos;
         advance(s); // skip '['
 
-        NoteName names[ABC_MAX_CHORD_NOTES];
-        int octaves[ABC_MAX_CHORD_NOTES];
-        int8_t accs[ABC_MAX_CHORD_NOTES];
+        uint8_t midi[ABC_MAX_CHORD_NOTES];
         uint8_t chord_size = 0;
         int total_dur_num = 1, total_dur_den = 1;
 
-        while (peek(s) != ']' && s->pos < s->len && chord_size < ABC_MAX_CHORD_NOTES) {
-            skip_whitespace(s);
+        // A chord still open after ABC_CHORD_SCAN_LIMIT bytes ends there
+        while (peek(s) != ']' && s->pos < s->len && chord_size < ABC_MAX_CHORD_NOTES &&
+               s->pos - open < ABC_CHORD_SCAN_LIMIT) {
             c = peek(s);
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                advance(s);
+                continue;
+            }
 
             // Skip if not a note character
             if (!((c >= 'A' && c <= 'G') || (c >= 'a' && c <= 'g') ||
                   c == 'z' || c == 'Z' || c == '^' || c == '_' || c == '=')) {
-                if (c == ']') break;
                 advance(s);
+                STAT_ADD(s, skipped_unknown, 1);
                 continue;
             }
 
             ParsedPitch pitch;
             if (parse_pitch(s, &pitch) == 0) {
-                names[chord_size] = pitch.name;
-                octaves[chord_size] = pitch.octave;
-                accs[chord_size] = pitch.accidental;
+                midi[chord_size] = pitch.midi;
                 // Use last pitch's duration for the chord
                 total_dur_num = pitch.dur_num;
                 total_dur_den = pitch.dur_den;
@@ -616,26 +1021,12 @@ static int parse_note_or_chord(ParserState *s, struct sheet *sheet) {
         if (peek(s) == ']') advance(s); // skip ']'
 
         // Check for duration after chord
-        c = peek(s);
-        if (c >= '0' && c <= '9') {
-            total_dur_num = 0;
-            while (c >= '0' && c <= '9') { total_dur_num = total_dur_num * 10 + (c - '0'); advance(s); c = peek(s); }
-        }
-        if (c == '/') {
-            advance(s);
-            c = peek(s);
-            if (c >= '0' && c <= '9') {
-                total_dur_den = 0;
-                while (c >= '0' && c <= '9') { total_dur_den = total_dur_den * 10 + (c - '0'); advance(s); c = peek(s); }
-            } else {
-                total_dur_den = 2;
-                while (peek(s) == '/') { advance(s); total_dur_den *= 2; }
-            }
-        }
+        parse_length(s, &total_dur_num, &total_dur_den);
 
         if (chord_size > 0) {
             uint8_t duration = calculate_duration_ticks(s, total_dur_num, total_dur_den);
-            return pool_append_note(pool, chord_size, names, octaves, accs, duration);
+            STAT_ADD(s, chords, 1);
+            return voice_append(s, sheet, chord_size, midi, duration);
         }
         return 0;
     }
@@ -643,109 +1034,310 @@ static int parse_note_or_chord(ParserState *s, struct sheet *sheet) {
     // Handle single note
     ParsedPitch pitch;
     if (parse_pitch(s, &pitch) == 0) {
-        NoteName names[1] = { pitch.name };
-        int octaves[1] = { pitch.octave };
-        int8_t accs[1] = { pitch.accidental };
         uint8_t duration = calculate_duration_ticks(s, pitch.dur_num, pitch.dur_den);
-        return pool_append_note(pool, 1, names, octaves, accs, duration);
+        if (pitch.midi == 0) STAT_ADD(s, rests, 1);
+        else STAT_ADD(s, notes, 1);
+        return voice_append(s, sheet, 1, &pitch.midi, duration);
     }
 
     return 1; // Not a note
 }
 
-static int copy_repeat_section(NotePool *pool, int16_t start_idx, int16_t end_idx) {
+// Append a copy of note `index`; *next receives the source's link
+static int copy_repeat_note(ParserState *s, NotePool *pool, int16_t index, int16_t *next) {
+    struct note *src = &pool->notes[index];
+
+    uint8_t midi[ABC_MAX_CHORD_NOTES];
+    for (uint8_t i = 0; i < src->chord_size && i < ABC_MAX_CHORD_NOTES; i++) {
+        midi[i] = repeat_copy_pitch(src->midi_note[i]);  // Accidentals not preserved in repeat copies
+    }
+
+    // Read the link first: appending may move a growable pool's storage
+    *next = src->next_index;
+    TRACE_ENTER(s, ABC_TRACE_APPEND);
+    int result = pool_append_note(pool, src->chord_size, midi, src->duration);
+    TRACE_EXIT(s);
+    return result;
+}
+
+static int copy_repeat_section(ParserState *s, NotePool *pool, int16_t start_idx, int16_t end_idx) {
     if (!pool || start_idx < 0) return 0;
 
     int16_t cur = start_idx;
     while (cur >= 0 && cur <= end_idx && cur < (int16_t)pool->count) {
-        struct note *src = &pool->notes[cur];
+        if (copy_repeat_note(s, pool, cur, &cur) < 0) return -1;
+        if (cur < 0) break;
+    }
+    return 0;
+}
 
-        // Extract note properties from stored MIDI values
-        NoteName names[ABC_MAX_CHORD_NOTES];
-        int octaves[ABC_MAX_CHORD_NOTES];
-        int8_t accs[ABC_MAX_CHORD_NOTES];
+// Step mode: queue the same copies for step_drain() (pools are in index order)
+static int step_queue_repeat(ParserState *s, struct sheet *sheet, int16_t start_idx, int16_t end_idx) {
+    int16_t count = (int16_t)sheet->pools[s->current_voice].count;
+    if (start_idx < 0 || start_idx >= count) return 0;
+    if (end_idx > count - 1) end_idx = count - 1;
+    if (end_idx < start_idx) return 0;
+    s->step->copy_next = start_idx;
+    s->step->copy_pending = (uint16_t)(end_idx - start_idx + 1);
+    s->step->copy_voice = s->current_voice;
+    return 0;
+}
 
-        for (uint8_t i = 0; i < src->chord_size && i < ABC_MAX_CHORD_NOTES; i++) {
-            names[i] = midi_to_note_name(src->midi_note[i]);
-            octaves[i] = midi_to_octave(src->midi_note[i]);
-            accs[i] = ACC_NONE;  // Accidentals not preserved in repeat copies
+// Editor version of copy_repeat_section: spliced lists are not in index order,
+// so walk by list position (same copies, including the lost accidentals)
+static int edit_repeat(ParserState *s, struct sheet *sheet, int16_t start_idx, int16_t end_idx) {
+    struct AbcEditRun *run = s->edit;
+    uint8_t v = s->current_voice;
+    NotePool *pool = &sheet->pools[v];
+    int16_t count = (int16_t)run->notes[v];
+
+    // Positions from another voice's count: results depend on both voices' lengths
+    if (start_idx >= 0 && s->repeat_voice != v) run->editor->cross_voice_repeats = 1;
+
+    if (start_idx < 0 || start_idx >= count) return 0;
+    if (end_idx > count - 1) end_idx = count - 1;
+    if (end_idx < start_idx) return 0;
+
+    int16_t cur = pool->head_index;
+    if (run->linear) cur = start_idx;
+    else for (int16_t i = 0; i < start_idx && cur >= 0; i++) cur = pool->notes[cur].next_index;
+
+    for (int16_t i = start_idx; i <= end_idx && cur >= 0; i++) {
+        const struct note *src = &pool->notes[cur];
+        uint8_t midi[ABC_MAX_CHORD_NOTES];
+        for (uint8_t j = 0; j < src->chord_size && j < ABC_MAX_CHORD_NOTES; j++) {
+            midi[j] = repeat_copy_pitch(src->midi_note[j]);
         }
+        int16_t next = src->next_index;
+        uint8_t chord_size = src->chord_size, duration = src->duration;
+        if (edit_append(s, sheet, chord_size, midi, duration) < 0) return -1;
+        cur = next;
+    }
+    return 0;
+}
 
-        if (pool_append_note(pool, src->chord_size, names, octaves, accs, src->duration) < 0) {
-            return -1;
+// Unfold a repeat section in the current voice
+static int voice_repeat(ParserState *s, struct sheet *sheet, int16_t start_idx, int16_t end_idx) {
+    AbcMeasureReport *m = s->measure;
+    if (s->edit) return edit_repeat(s, sheet, start_idx, end_idx);
+    if (s->events) return 0;
+    if (s->cursor) {
+        cursor_repeat(s, start_idx);
+        return 0;
+    }
+    if (s->step) return step_queue_repeat(s, sheet, start_idx, end_idx);
+    if (!m) {
+        NotePool *pool = &sheet->pools[s->current_voice];
+        uint16_t before = pool->count;
+        TRACE_ENTER(s, ABC_TRACE_REPEAT);
+        int result = copy_repeat_section(s, pool, start_idx, end_idx);
+        TRACE_EXIT(s);
+        if (pool->count > before) {
+            STAT_ADD(s, repeats, 1);
+            STAT_ADD(s, notes_copied, (uint32_t)(pool->count - before));
         }
-        cur = src->next_index;
-        if (cur < 0) break;
+        return result;
+    }
+
+    // Mirror copy_repeat_section: copies [start_idx, end_idx] of the notes stored so far
+    int16_t count = (int16_t)m->notes[s->current_voice];
+    if (start_idx < 0 || start_idx >= count) return 0;
+    if (end_idx > count - 1) end_idx = count - 1;
+    if (end_idx < start_idx) return 0;
+    uint16_t copies = (uint16_t)(end_idx - start_idx + 1);
+    if ((uint32_t)count + copies > 0x7FFF) return -1;
+    m->notes[s->current_voice] = (uint16_t)(count + copies);
+    m->total_notes += copies;
+    return 0;
+}
+
+// ============================================================================
+// Editor checkpoints
+// ============================================================================
+
+static void edit_snapshot(const ParserState *s, const struct sheet *sheet, AbcCheckpoint *cp) {
+    const struct AbcEditRun *run = s->edit;
+    cp->state = *s;
+    cp->voice_count = sheet->voice_count;
+    memcpy(cp->tail, run->tail, sizeof(cp->tail));
+    memcpy(cp->notes, run->notes, sizeof(cp->notes));
+    memcpy(cp->ticks, run->ticks, sizeof(cp->ticks));
+}
+
+// Would parsing on from here reproduce what the old parse produced from cp?
+static int edit_converged(const ParserState *s, const struct sheet *sheet, const AbcCheckpoint *cp) {
+    const ParserState *o = &cp->state;
+    // An open repeat would copy notes that this edit may have changed
+    if (s->repeat_start_index >= 0 || o->repeat_start_index >= 0) return 0;
+    if (sheet->voice_count != cp->voice_count || s->current_voice != o->current_voice) return 0;
+    if (s->in_repeat != o->in_repeat || s->tuplet_remaining != o->tuplet_remaining ||
+        s->tuplet_num != o->tuplet_num || s->tuplet_in_time != o->tuplet_in_time) return 0;
+    if (s->default_num != o->default_num || s->default_den != o->default_den) return 0;
+    if (memcmp(s->key_accidentals, o->key_accidentals, 7) != 0 ||
+        memcmp(s->bar_accidentals, o->bar_accidentals, 7) != 0) return 0;
+
+    // A repeat that starts in one voice and ends in another copies by position
+    // from the start of the voice, so later text may depend on edited notes
+    return !s->edit->editor->cross_voice_repeats;
+}
+
+// Halve the checkpoints this run wrote (keeping the first) and space them wider
+static void edit_decimate(struct AbcEditRun *run) {
+    AbcEditor *ed = run->editor;
+    uint16_t kept = run->base;
+    for (uint16_t i = run->base; i < run->write; i += 2) ed->checkpoints[kept++] = ed->checkpoints[i];
+    run->write = kept;
+    ed->checkpoint_gap = ed->checkpoint_gap ? (uint16_t)(ed->checkpoint_gap * 2) : 32;
+}
+
+// Called at bar lines and line starts; returns 1 once the parse has converged
+static int edit_boundary(ParserState *s, struct sheet *sheet) {
+    struct AbcEditRun *run = s->edit;
+    AbcEditor *ed = run->editor;
+    if (s->pos == run->last_pos) return 0;
+    run->last_pos = s->pos;
+
+    // Old checkpoints after the edit sit at the same text, shifted by delta
+    while (run->old_read < run->old_end) {
+        int32_t old_pos = ed->checkpoints[run->old_read].state.pos;
+        if (old_pos + run->delta >= (int32_t)run->edit_end && old_pos + run->delta >= (int32_t)s->pos) break;
+        run->old_read++;
+    }
+    if (run->old_read < run->old_end &&
+        ed->checkpoints[run->old_read].state.pos + run->delta == (int32_t)s->pos &&
+        edit_converged(s, sheet, &ed->checkpoints[run->old_read])) {
+        run->converged = 1;
+        return 1;
+    }
+
+    if (run->write > 0 && s->pos - ed->checkpoints[run->write - 1].state.pos < ed->checkpoint_gap) return 0;
+    if (run->write >= run->old_read) {
+        if (run->write - run->base >= 2) edit_decimate(run);
+        else if (run->old_read < run->old_end) run->old_read++;  // Give up the nearest old checkpoint
+        if (run->write >= run->old_read) return 0;
     }
+    edit_snapshot(s, sheet, &ed->checkpoints[run->write++]);
     return 0;
 }
 
+// ============================================================================
+// Step mode (see abc_parse_step)
+// ============================================================================
+
+// Continue work a token left unfinished: queued repeat copies, then skipped
+// text. Returns 1 if some is left for the next step, -1 if a pool is exhausted.
+static int step_drain(ParserState *s, struct sheet *sheet) {
+    AbcStepParser *st = s->step;
+    while (st->copy_pending > 0) {
+        if (step_spent(s)) return 1;
+        if (copy_repeat_note(s, &sheet->pools[st->copy_voice], st->copy_next, &st->copy_next) < 0) return -1;
+        st->copy_pending--;
+        st->copied++;
+    }
+    uint8_t skip = st->skipping;
+    st->skipping = SKIP_NONE;
+    return skip != SKIP_NONE ? skip_rest(s, skip) : 0;
+}
+
+static int parse_body(ParserState *s, struct sheet *sheet);
+
 static int parse_notes(ParserState *s, struct sheet *sheet) {
     s->repeat_start_index = -1;
     s->repeat_end_index = -1;
     s->in_repeat = 0;
     s->current_voice = 0;
+    return parse_body(s, sheet);
+}
+
+static int parse_body_tokens(ParserState *s, struct sheet *sheet);
+
+// Body loop; the editor also enters here to resume from a checkpoint
+static int parse_body(ParserState *s, struct sheet *sheet) {
+    TRACE_ENTER(s, ABC_TRACE_BODY);
+    int result = parse_body_tokens(s, sheet);
+    TRACE_EXIT(s);
+    return result;
+}
 
+static int parse_body_tokens(ParserState *s, struct sheet *sheet) {
     // Don't create default voice yet - wait to see if V: line comes first
 
     while (s->pos < s->len) {
+        if (sheet->publication && !s->edit && sheet->voice_count > 0) {
+            publish_voice(sheet, s->current_voice);
+        }
+        if (s->step) {
+            int busy = step_drain(s, sheet);
+            if (busy < 0) return -2;
+            if (busy || step_spent(s)) return 0;
+        }
+
         skip_whitespace(s);
         if (s->pos >= s->len) break;
+        if (s->step && step_spent(s)) return 0;
 
         char c = peek(s);
 
+        if (s->edit && (c == '|' || (s->pos > 0 && (s->input[s->pos - 1] == '\n' || s->input[s->pos - 1] == '\r')))) {
+            if (edit_boundary(s, sheet)) return 0;
+        }
+        if (s->cursor && cursor_pause(s)) return 0;
+
         // Handle V: voice change (inline) BEFORE getting pool reference
         if (c == 'V' && s->pos + 1 < s->len && s->input[s->pos + 1] == ':') {
             advance(s); // V
             advance(s); // :
 
             // Skip leading whitespace
-            while (s->pos < s->len && (s->input[s->pos] == ' ' || s->input[s->pos] == '\t')) {
+            for (uint8_t n = 0; n < ABC_RUN_LIMIT && (peek(s) == ' ' || peek(s) == '\t'); n++) {
                 s->pos++;
             }
 
-            // Read voice ID (alphanumeric characters only)
+            // Read voice ID (alphanumeric characters only); bytes past
+            // ABC_FIELD_LIMIT are skipped below
             uint16_t id_start = s->pos;
-            while (s->pos < s->len) {
-                char ch = s->input[s->pos];
-                // Voice ID is alphanumeric, stop at whitespace or any other character
-                if ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') ||
-                    (ch >= '0' && ch <= '9') || ch == '_' || ch == '-') {
-                    s->pos++;
-                } else {
-                    break;
-                }
+            while (s->pos < s->len && s->pos - id_start < ABC_FIELD_LIMIT && voice_id_char(s->input[s->pos])) {
+                s->pos++;
             }
             uint8_t id_len = (uint8_t)(s->pos - id_start);
 
             if (id_len > 0) {
-                int voice_idx = find_or_create_voice(sheet, s->input + id_start, id_len);
+                int voice_idx = find_or_create_voice(s, sheet, s->input + id_start, id_len);
+                if (voice_idx == -2) return -2;
                 if (voice_idx >= 0) {
                     s->current_voice = (uint8_t)voice_idx;
+                    if (s->events && event_voice(s) < 0) return -2;
                 }
             }
+            skip_rest(s, SKIP_VOICE_ID);  // Step mode may leave the rest to step_drain
             continue;
         }
 
         // Create default voice if none exists and we're about to parse notes
         if (sheet->voice_count == 0 && sheet->pool_count > 0) {
+            if (s->edit && !s->edit->linear) return -2;
             sheet->voice_count = 1;
-            safe_strcpy(sheet->pools[0].voice_id, ABC_MAX_VOICE_ID_LEN, "default", 7);
+            safe_strcpy(voice_id_slot(s, sheet, 0), ABC_MAX_VOICE_ID_LEN, "default", 7);
+            if (s->events && event_voice(s) < 0) return -2;
         }
 
-        NotePool *pool = &sheet->pools[s->current_voice];
-
         if (c == '|') {
             advance(s);
             memset(s->bar_accidentals, 0, 7);
             c = peek(s);
+            AbcBarType bar = ABC_BAR_SINGLE;
             if (c == ':') {
                 advance(s);
                 s->in_repeat = 1;
-                s->repeat_start_index = (int16_t)pool->count;
+                s->repeat_start_index = voice_note_count(s, sheet);
+                s->repeat_voice = s->current_voice;
+                if (s->cursor) s->cursor->repeat = *s;
+                bar = ABC_BAR_REPEAT_START;
             } else if (c == '|' || c == ']') {
                 advance(s);
+                bar = (c == '|') ? ABC_BAR_DOUBLE : ABC_BAR_FINAL;
             }
+            if (s->events && event_bar(s, bar) < 0) return -2;
             continue;
         }
 
@@ -753,15 +1345,19 @@ static int parse_notes(ParserState *s, struct sheet *sheet) {
             advance(s);
             if (peek(s) == '|') {
                 advance(s);
-                s->repeat_end_index = (int16_t)(pool->count - 1);
+                s->repeat_end_index = (int16_t)(voice_note_count(s, sheet) - 1);
                 if (peek(s) == ':') {
                     advance(s);
-                    if (copy_repeat_section(pool, s->repeat_start_index, s->repeat_end_index) < 0) return -2;
-                    s->repeat_start_index = (int16_t)pool->count;
+                    if (voice_repeat(s, sheet, s->repeat_start_index, s->repeat_end_index) < 0) return -2;
+                    s->repeat_start_index = voice_note_count(s, sheet);
+                    s->repeat_voice = s->current_voice;
+                    if (s->cursor) s->cursor->repeat = *s;
+                    if (s->events && event_bar(s, ABC_BAR_REPEAT_END_START) < 0) return -2;
                 } else {
-                    if (copy_repeat_section(pool, s->repeat_start_index, s->repeat_end_index) < 0) return -2;
+                    if (voice_repeat(s, sheet, s->repeat_start_index, s->repeat_end_index) < 0) return -2;
                     s->in_repeat = 0;
                     s->repeat_start_index = -1;
+                    if (s->events && event_bar(s, ABC_BAR_REPEAT_END) < 0) return -2;
                 }
             }
             continue;
@@ -781,6 +1377,7 @@ static int parse_notes(ParserState *s, struct sheet *sheet) {
                 else if (n == 4) s->tuplet_in_time = 3;
                 else if (n == 6) s->tuplet_in_time = 2;
                 else s->tuplet_in_time = n - 1;
+                STAT_ADD(s, tuplets, 1);
             }
             continue;
         }
@@ -789,19 +1386,28 @@ static int parse_notes(ParserState *s, struct sheet *sheet) {
         if (c == ')' || c == '{' || c == '}' || c == '!' || c == '+' ||
             c == '-' || c == '<' || c == '>' || c == '~' || c == '%' || c == '.') {
             advance(s);
+            STAT_ADD(s, skipped_decoration, 1);
             continue;
         }
 
         if (c == '"') {
+#if ABC_PARSE_STATS
+            uint16_t start = s->pos;
+#endif
             advance(s);
-            while (s->pos < s->len && peek(s) != '"') advance(s);
-            if (peek(s) == '"') advance(s);
+            skip_rest(s, SKIP_ANNOTATION);    // Step mode may leave the rest to step_drain
+            STAT_ADD(s, skipped_decoration, (uint32_t)(s->pos - start));
             continue;
         }
 
+        TRACE_ENTER(s, ABC_TRACE_NOTE);
         int result = parse_note_or_chord(s, sheet);
+        TRACE_EXIT(s);
         if (result < 0) return -2;
-        if (result > 0) advance(s);
+        if (result > 0 && s->pos < s->len) {
+            advance(s);
+            STAT_ADD(s, skipped_unknown, 1);
+        }
     }
     return 0;
 }
@@ -810,13 +1416,12 @@ static int parse_notes(ParserState *s, struct sheet *sheet) {
 // Main parse function
 // ============================================================================
 
-int abc_parse(struct sheet *sheet, const char *abc_string) {
-    if (!sheet || !abc_string || !sheet->pools || sheet->pool_count == 0) return -1;
-
+// Reads at most max_len bytes of abc_string (stops at a NUL before that)
+static void parser_state_init(ParserState *s, const struct sheet *sheet, const char *abc_string, uint16_t max_len) {
     uint16_t len = 0;
-    while (abc_string[len] && len < 0xFFFF) len++;
+    while (len < max_len && abc_string[len]) len++;
 
-    ParserState s = {
+    *s = (ParserState){
         .input = abc_string,
         .pos = 0,
         .len = len,
@@ -830,16 +1435,454 @@ int abc_parse(struct sheet *sheet, const char *abc_string) {
         .repeat_start_index = -1,
         .repeat_end_index = -1,
         .in_repeat = 0,
+        .repeat_voice = 0,
         .tuplet_remaining = 0,
         .tuplet_num = 0,
         .tuplet_in_time = 0,
-        .current_voice = 0
+        .current_voice = 0,
+        .measure = NULL,
+        .edit = NULL,
+        .events = NULL,
+        .cursor = NULL,
+        .step = NULL,
+        .stats = NULL
     };
-    memset(s.key_accidentals, 0, 7);
-    memset(s.bar_accidentals, 0, 7);
+    memset(s->key_accidentals, 0, 7);
+    memset(s->bar_accidentals, 0, 7);
+#if ABC_TRACE
+    s->trace = sheet->trace;
+#endif
+}
+
+static int parse_sheet(struct sheet *sheet, const char *abc_string, uint16_t len, AbcParseStats *stats) {
+    if (!sheet || !abc_string || !sheet->pools || sheet->pool_count == 0) return -1;
+    if (!publication_valid(sheet)) return -1;
+
+    ParserState s;
+    parser_state_init(&s, sheet, abc_string, len);
+    s.stats = stats;
+
+    parse_header(&s, sheet);
+    int result = parse_notes(&s, sheet);
+    if (sheet->publication) publish_all(sheet, 1, result);
+
+    if (stats) {
+        // Pools only grow during a parse, so the final counts are the high-water marks
+        stats->bytes = s.pos;
+        stats->voice_count = sheet->voice_count;
+        for (uint8_t v = 0; v < sheet->voice_count && v < ABC_STATS_MAX_VOICES; v++) {
+            stats->pool_peak[v] = sheet->pools[v].count;
+            stats->pool_capacity[v] = sheet->pools[v].capacity;
+        }
+    }
+    return result;
+}
 
+int abc_parse(struct sheet *sheet, const char *abc_string) {
+    return parse_sheet(sheet, abc_string, 0xFFFF, NULL);
+}
+
+int abc_parse_len(struct sheet *sheet, const char *abc_string, uint16_t len) {
+    return parse_sheet(sheet, abc_string, len, NULL);
+}
+
+int abc_parse_stats(struct sheet *sheet, const char *abc_string, AbcParseStats *stats) {
+    if (!stats) return -1;
+    memset(stats, 0, sizeof(*stats));
+    return parse_sheet(sheet, abc_string, 0xFFFF, stats);
+}
+
+int abc_measure(const char *abc_string, AbcMeasureReport *report) {
+    if (!abc_string || !report) return -1;
+    memset(report, 0, sizeof(*report));
+
+    // Header fields land in a scratch sheet; voices and counts in the report
+    struct sheet scratch;
+    sheet_init(&scratch, NULL, ABC_MEASURE_MAX_VOICES);
+
+    ParserState s;
+    parser_state_init(&s, &scratch, abc_string, 0xFFFF);
+    s.measure = report;
+
+    parse_header(&s, &scratch);
+    int result = parse_notes(&s, &scratch);
+    report->voice_count = scratch.voice_count;
+    return result;
+}
+
+// Skim a tune body for V: IDs without parsing notes
+static void scan_voices(const ParserState *s, AbcHeaderScan *scan) {
+    const char *in = s->input;
+    uint16_t pos = s->pos;
+
+    while (pos < s->len) {
+        char c = in[pos];
+        if (c == '"' || c == '[') {
+            // Annotation or chord: the parser never sees V: inside either
+            char close = (c == '"') ? '"' : ']';
+            pos++;
+            while (pos < s->len && in[pos] != close) pos++;
+            if (pos < s->len) pos++;
+            continue;
+        }
+        if (c == '\n') {
+            uint16_t next = pos + 1;
+            while (next < s->len && (in[next] == ' ' || in[next] == '\t' || in[next] == '\r')) next++;
+            if (next < s->len && in[next] == '\n') break;     // Blank line: end of tune
+            pos = next;
+            continue;
+        }
+        if (c != 'V' || pos + 1 >= s->len || in[pos + 1] != ':') {
+            pos++;
+            continue;
+        }
+
+        // Same ID rules as parse_body
+        pos += 2;
+        for (uint8_t n = 0; n < ABC_RUN_LIMIT && pos < s->len && (in[pos] == ' ' || in[pos] == '\t'); n++) pos++;
+        uint16_t id_start = pos;
+        while (pos < s->len && pos - id_start < ABC_FIELD_LIMIT && voice_id_char(in[pos])) pos++;
+        AbcSpan id = { id_start, (uint16_t)(pos - id_start) };
+        while (pos < s->len && voice_id_char(in[pos])) pos++;
+        if (id.len == 0) continue;
+
+        uint8_t i = 0;
+        while (i < scan->voice_count &&
+               (scan->voices[i].len != id.len || memcmp(in + scan->voices[i].offset, in + id.offset, id.len) != 0)) {
+            i++;
+        }
+        if (i < scan->voice_count) continue;
+        if (scan->voice_count < ABC_SCAN_MAX_VOICES) scan->voices[scan->voice_count++] = id;
+        else scan->voices_truncated = 1;
+    }
+    scan->body_end = pos;
+}
+
+int abc_scan_header(const char *abc_string, uint8_t flags, AbcHeaderScan *scan) {
+    if (!abc_string || !scan) return -1;
+    memset(scan, 0, sizeof(*scan));
+
+    struct sheet scratch;
+    sheet_init(&scratch, NULL, 0);
+    ParserState s;
+    parser_state_init(&s, &scratch, abc_string, 0xFFFF);
+
+    // The same lines parse_header reads, and the same end of the header
+    HeaderLine line;
+    int done = 0;
+    while (!done && s.pos < s.len && header_line(&s, &line)) {
+        AbcSpan span = { line.start, (uint16_t)(line.end - line.start) };
+        switch (line.field) {
+            case 'X': scan->number = span; break;
+            case 'T': scan->title = span; break;
+            case 'C': scan->composer = span; break;
+            case 'M': scan->meter = span; break;
+            case 'L': scan->length = span; break;
+            case 'Q': scan->tempo = span; break;
+            case 'K': scan->key = span; break;
+            case 'V': done = 1; continue;   // Not consumed: the body starts here
+        }
+        s.pos = line.next;
+        if (line.more) skip_rest(&s, SKIP_LINE);
+        if (line.field == 'K') done = 1;
+    }
+    scan->body_start = s.pos;
+
+    if (flags & ABC_SCAN_VOICES) scan_voices(&s, scan);
+    return 0;
+}
+
+int abc_parse_events(const char *abc_string, const AbcEventCallbacks *callbacks, void *user) {
+    if (!abc_string || !callbacks) return -1;
+
+    // Header fields land in a scratch sheet; voice IDs in the sink
+    struct AbcEventSink sink = { .cb = callbacks, .user = user, .stopped = 0 };
+    struct sheet scratch;
+    sheet_init(&scratch, NULL, ABC_EVENT_MAX_VOICES);
+
+    ParserState s;
+    parser_state_init(&s, &scratch, abc_string, 0xFFFF);
+    s.events = &sink;
+
+    parse_header(&s, &scratch);
+    int result = sink.stopped ? 0 : parse_notes(&s, &scratch);
+    return sink.stopped ? -3 : result;
+}
+
+int abc_parse_begin(AbcStepParser *parser, struct sheet *sheet, const char *abc_string) {
+    if (!parser || !sheet || !abc_string || !sheet->pools || sheet->pool_count == 0) return -1;
+    if (!publication_valid(sheet)) return -1;
+    memset(parser, 0, sizeof(*parser));
+    parser->sheet = sheet;
+    parser_state_init(&parser->state, sheet, abc_string, 0xFFFF);
+    return 0;
+}
+
+int abc_parse_step(AbcStepParser *parser, uint16_t max_units) {
+    if (!parser || !parser->sheet) return -1;
+    if (parser->phase == 2) return parser->result;
+
+    ParserState *s = &parser->state;
+    s->step = parser;
+    parser->limit = max_units > 0 ? max_units : 1;
+    parser->step_pos = s->pos;
+    parser->copied = 0;
+
+    if (parser->phase == 0) {
+        if (parse_header(s, parser->sheet)) return ABC_PARSE_IN_PROGRESS;
+        // As parse_notes()
+        s->repeat_start_index = -1;
+        s->repeat_end_index = -1;
+        s->in_repeat = 0;
+        s->current_voice = 0;
+        parser->phase = 1;
+    }
+
+    int result = parse_body(s, parser->sheet);
+    if (result == 0) {
+        // Also finishes copies queued by the last token of the text
+        result = step_drain(s, parser->sheet);
+        if (result > 0 || s->pos < s->len) {
+            if (parser->sheet->publication) publish_all(parser->sheet, 0, 0);
+            return ABC_PARSE_IN_PROGRESS;
+        }
+    }
+    parser->phase = 2;
+    parser->result = (int8_t)(result < 0 ? -2 : 0);
+    if (parser->sheet->publication) publish_all(parser->sheet, 1, parser->result);
+    return parser->result;
+}
+
+int abc_cursor_init(AbcCursor *cursor, const char *abc_string, uint8_t voice) {
+    if (!cursor || !abc_string) return -1;
+    memset(cursor, 0, sizeof(*cursor));
+
+    struct sheet scratch;
+    sheet_init(&scratch, NULL, ABC_CURSOR_MAX_VOICES);
+    parser_state_init(&cursor->state, &scratch, abc_string, 0xFFFF);
+    parse_header(&cursor->state, &scratch);
+
+    cursor->voice = voice;
+    cursor->tempo_bpm = scratch.tempo_bpm;
+    return 0;
+}
+
+int abc_cursor_next(AbcCursor *cursor, struct note *note) {
+    if (!cursor || !note) return -1;
+
+    // Only the voice table of a sheet is used while parsing the body
+    struct sheet scratch;
+    sheet_init(&scratch, NULL, ABC_CURSOR_MAX_VOICES);
+    scratch.voice_count = cursor->voice_count;
+
+    cursor->out = note;
+    cursor->ready = 0;
+    cursor->state.cursor = cursor;
+    cursor->replay.cursor = cursor;
+    for (;;) {
+        int replaying = cursor->replaying;
+        ParserState *s = replaying ? &cursor->replay : &cursor->state;
+        parse_body(s, &scratch);
+        cursor->voice_count = scratch.voice_count;
+        if (cursor->ready) return 1;
+        if (replaying) {
+            cursor->replaying = 0;  // Section done (or, defensively, the text ended)
+        } else if (!cursor->replaying) {
+            return 0;
+        }
+    }
+}
+
+// ============================================================================
+// Incremental editing
+// ============================================================================
+
+// Parse the whole text, recording checkpoints from scratch
+static int editor_full_parse(AbcEditor *ed) {
+    struct sheet *sheet = ed->sheet;
+    sheet_reset(sheet);
+
+    struct AbcEditRun run;
+    memset(&run, 0, sizeof(run));
+    run.editor = ed;
+    run.linear = 1;
+    run.old_read = run.old_end = ed->checkpoint_capacity;
+    run.last_pos = 0xFFFF;
+    for (uint8_t v = 0; v < ABC_EDIT_MAX_VOICES; v++) run.tail[v] = -1;
+    ed->checkpoint_gap = 0;
+    ed->cross_voice_repeats = 0;
+
+    ParserState s;
+    parser_state_init(&s, sheet, ed->text, 0xFFFF);
     parse_header(&s, sheet);
-    return parse_notes(&s, sheet);
+    ed->body_start = s.pos;
+    s.edit = &run;
+    int result = parse_notes(&s, sheet);
+
+    for (uint8_t v = 0; v < sheet->voice_count; v++) {
+        sheet->pools[v].tail_index = run.tail[v];
+        sheet->pools[v].total_ticks = run.ticks[v];
+    }
+    ed->checkpoint_count = run.write;
+    ed->last_full = 1;
+    ed->last_reparsed = ed->text_len;
+    return result;
+}
+
+// Link the re-parsed runs to what followed old checkpoint `old` (NULL = end of
+// tune) and rebuild the checkpoint list behind them
+static void editor_splice(AbcEditor *ed, struct AbcEditRun *run, const ParserState *s,
+                          const AbcCheckpoint *resume, uint8_t old_voice_count) {
+    struct sheet *sheet = ed->sheet;
+    AbcCheckpoint *cps = ed->checkpoints;
+
+    if (!run->converged) {
+        for (uint8_t v = 0; v < sheet->voice_count; v++) {
+            NotePool *pool = &sheet->pools[v];
+            if (run->tail[v] < 0) pool->head_index = -1;
+            else pool->notes[run->tail[v]].next_index = -1;
+            pool->tail_index = run->tail[v];
+            pool->total_ticks = run->ticks[v];
+        }
+        for (uint8_t v = sheet->voice_count; v < old_voice_count; v++) note_pool_reset(&sheet->pools[v]);
+        ed->checkpoint_count = run->write;
+        return;
+    }
+
+    // The convergence point becomes a checkpoint (it may overwrite the old one)
+    AbcCheckpoint old = cps[run->old_read];
+    edit_snapshot(s, sheet, &cps[run->write]);
+
+    int32_t dn[ABC_EDIT_MAX_VOICES];
+    int32_t dt[ABC_EDIT_MAX_VOICES];
+    sheet->voice_count = old_voice_count;
+    for (uint8_t v = 0; v < old_voice_count; v++) {
+        NotePool *pool = &sheet->pools[v];
+        // Voices without notes since the resume point still point at the old continuation
+        int16_t cont = (old.tail[v] == resume->tail[v]) ? run->old_next[v] : pool->notes[old.tail[v]].next_index;
+        if (run->tail[v] < 0) pool->head_index = cont;
+        else pool->notes[run->tail[v]].next_index = cont;
+        if (cont < 0) pool->tail_index = run->tail[v];
+        dn[v] = (int32_t)run->notes[v] - old.notes[v];
+        dt[v] = (int32_t)(run->ticks[v] - old.ticks[v]);
+        pool->total_ticks += (uint32_t)dt[v];
+    }
+
+    // Then the untouched old checkpoints, shifted
+    uint16_t count = (uint16_t)(run->write + 1);
+    for (uint16_t k = (uint16_t)(run->old_read + 1); k < run->old_end; k++) {
+        AbcCheckpoint *cp = &cps[count++];
+        memmove(cp, &cps[k], sizeof(*cp));
+        cp->state.pos = (uint16_t)(cp->state.pos + run->delta);
+        for (uint8_t v = 0; v < old_voice_count; v++) {
+            if (cp->tail[v] == old.tail[v]) cp->tail[v] = run->tail[v];
+            cp->notes[v] = (uint16_t)(cp->notes[v] + dn[v]);
+            cp->ticks[v] += (uint32_t)dt[v];
+        }
+        if (cp->state.repeat_start_index >= 0) {
+            cp->state.repeat_start_index = (int16_t)(cp->state.repeat_start_index + dn[cp->state.repeat_voice]);
+        }
+        if (cp->state.repeat_end_index >= 0) {
+            cp->state.repeat_end_index = (int16_t)(cp->state.repeat_end_index + dn[cp->state.current_voice]);
+        }
+    }
+    ed->checkpoint_count = count;
+}
+
+int abc_editor_init(AbcEditor *editor, struct sheet *sheet, char *text, uint32_t text_capacity,
+                    AbcCheckpoint *checkpoints, uint16_t checkpoint_capacity) {
+    if (!editor || !sheet || !sheet->pools || sheet->pool_count == 0 || !text || !checkpoints) return -1;
+    if (sheet->pool_count > ABC_EDIT_MAX_VOICES || checkpoint_capacity < 4) return -1;
+
+    uint32_t len = 0;
+    while (len < text_capacity && text[len]) len++;
+    if (len >= text_capacity || len > 0xFFFF) return -1;
+
+    editor->sheet = sheet;
+    editor->text = text;
+    editor->text_capacity = text_capacity;
+    editor->text_len = (uint16_t)len;
+    editor->checkpoints = checkpoints;
+    editor->checkpoint_capacity = checkpoint_capacity;
+    return editor_full_parse(editor);
+}
+
+int abc_editor_edit(AbcEditor *editor, uint16_t start, uint16_t end,
+                    const char *replacement, uint16_t replacement_len) {
+    if (!editor || start > end || end > editor->text_len || (!replacement && replacement_len > 0)) return -1;
+    uint32_t new_len = (uint32_t)editor->text_len - (end - start) + replacement_len;
+    if (new_len >= editor->text_capacity || new_len > 0xFFFF) return -1;
+
+    // Header changes affect every note
+    int full = start <= editor->body_start;
+
+    char *text = editor->text;
+    memmove(text + start + replacement_len, text + end, (size_t)editor->text_len - end + 1);
+    if (replacement_len > 0) memcpy(text + start, replacement, replacement_len);
+    editor->text_len = (uint16_t)new_len;
+    if (full) return editor_full_parse(editor);
+
+    // Keep room for the checkpoints the re-parse will record
+    AbcCheckpoint *cps = editor->checkpoints;
+    if (editor->checkpoint_count + 2 > editor->checkpoint_capacity) {
+        struct AbcEditRun all = { .editor = editor, .base = 0, .write = editor->checkpoint_count };
+        edit_decimate(&all);
+        editor->checkpoint_count = all.write;
+    }
+
+    // Resume from the last checkpoint before the edit. Strictly before: the
+    // token ending at a checkpoint peeked at the byte there (e.g. "B|" -> "B3").
+    uint16_t lo = 0, hi = editor->checkpoint_count;
+    while (lo < hi) {
+        uint16_t mid = (uint16_t)((lo + hi) / 2);
+        if (cps[mid].state.pos < start) lo = (uint16_t)(mid + 1);
+        else hi = mid;
+    }
+    if (lo == 0) return editor_full_parse(editor);
+    uint16_t resume_idx = (uint16_t)(lo - 1);
+    const AbcCheckpoint *resume = &cps[resume_idx];
+
+    struct sheet *sheet = editor->sheet;
+    struct AbcEditRun run;
+    memset(&run, 0, sizeof(run));
+    run.editor = editor;
+    for (uint8_t v = 0; v < ABC_EDIT_MAX_VOICES; v++) {
+        run.tail[v] = resume->tail[v];
+        run.notes[v] = resume->notes[v];
+        run.ticks[v] = resume->ticks[v];
+        if (v < sheet->pool_count) {
+            const NotePool *pool = &sheet->pools[v];
+            run.old_next[v] = resume->tail[v] < 0 ? pool->head_index : pool->notes[resume->tail[v]].next_index;
+        }
+    }
+
+    // Park the old checkpoints after the resume point at the top of the array
+    uint16_t parked = (uint16_t)(editor->checkpoint_count - lo);
+    run.old_end = editor->checkpoint_capacity;
+    run.old_read = (uint16_t)(run.old_end - parked);
+    memmove(&cps[run.old_read], &cps[lo], (size_t)parked * sizeof(*cps));
+    run.base = run.write = lo;
+    run.edit_end = (uint16_t)(start + replacement_len);
+    run.delta = (int32_t)replacement_len - (int32_t)(end - start);
+
+    ParserState s = resume->state;
+    s.input = text;
+    s.len = editor->text_len;
+    s.measure = NULL;
+    s.edit = &run;
+    run.last_pos = s.pos;
+    uint16_t from = s.pos;
+    uint8_t old_voice_count = sheet->voice_count;
+    sheet->voice_count = resume->voice_count;
+
+    if (parse_body(&s, sheet) < 0) {
+        // Out of note storage (spliced-out notes included) or voices changed
+        return editor_full_parse(editor);
+    }
+    editor_splice(editor, &run, &s, &cps[resume_idx], old_voice_count);
+    editor->last_full = 0;
+    editor->last_reparsed = (uint16_t)(s.pos - from);
+    return 0;
 }
 
 // ============================================================================
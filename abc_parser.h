@@ -31,6 +31,42 @@
 #define ABC_PPQ 48                 // Pulses per quarter note (MIDI-style timing)
 #endif
 
+#ifndef ABC_MEASURE_MAX_VOICES
+#define ABC_MEASURE_MAX_VOICES 16  // Voices tracked by abc_measure()
+#endif
+
+#ifndef ABC_EDIT_MAX_VOICES
+#define ABC_EDIT_MAX_VOICES 8      // Voices tracked per editor checkpoint (AbcEditor)
+#endif
+
+#ifndef ABC_EVENT_MAX_VOICES
+#define ABC_EVENT_MAX_VOICES 16    // Voices distinguished by abc_parse_events()
+#endif
+
+#ifndef ABC_CURSOR_MAX_VOICES
+#define ABC_CURSOR_MAX_VOICES 8    // Voices distinguished by an AbcCursor
+#endif
+
+#ifndef ABC_PUBLISH_MAX_VOICES
+#define ABC_PUBLISH_MAX_VOICES 8   // Voices an AbcPublication tracks
+#endif
+
+#ifndef ABC_STATS_MAX_VOICES
+#define ABC_STATS_MAX_VOICES 16    // Voices with pool figures in AbcParseStats
+#endif
+
+#ifndef ABC_PARSE_STATS
+#define ABC_PARSE_STATS 1          // 0 compiles the abc_parse_stats() counters out
+#endif
+
+#ifndef ABC_SCAN_MAX_VOICES
+#define ABC_SCAN_MAX_VOICES 16     // Voice IDs listed by abc_scan_header()
+#endif
+
+#ifndef ABC_TRACE
+#define ABC_TRACE 0                // 1 adds per-phase timing hooks (see abc_trace.h)
+#endif
+
 // ============================================================================
 // Types
 // ============================================================================
@@ -66,6 +102,17 @@ struct note {
     uint8_t midi_note[ABC_MAX_CHORD_NOTES];  // MIDI note numbers (0-127, 0 = rest)
 };
 
+// Optional allocator for growable note pools (see note_pool_set_allocator)
+// grow() returns storage for at least min_capacity notes that already holds the
+// first `used` notes of `old` (realloc semantics), and stores the actual capacity
+// in *capacity. Returns NULL on failure. Because notes link by index, moving
+// them to a new buffer keeps the list intact.
+typedef struct AbcAllocator {
+    struct note *(*grow)(void *ctx, struct note *old, uint16_t used,
+                         uint16_t min_capacity, uint16_t *capacity);
+    void *ctx;
+} AbcAllocator;
+
 // Note pool structure (one per voice)
 // Initialize with note_pool_init() before use
 typedef struct {
@@ -77,8 +124,20 @@ typedef struct {
     uint16_t capacity;       // Max notes this pool can hold
     uint32_t total_ticks;    // Total duration in MIDI ticks for this voice
     uint8_t max_chord_notes; // Max notes per chord (for validation)
+    const AbcAllocator *allocator;  // Grows the pool when full (NULL = fixed capacity)
 } NotePool;
 
+// Parse progress published to readers on other cores (see sheet_set_publication)
+// Written with release stores by the parser, read with acquire loads.
+typedef struct {
+    uint16_t count[ABC_PUBLISH_MAX_VOICES];  // Notes of each voice that are complete
+    uint8_t voice_count;        // Voices whose IDs are complete
+    uint8_t done;               // 1 once the parse has finished
+    int8_t result;              // Parse result (valid once done)
+} AbcPublication;
+
+struct AbcTrace;
+
 // Sheet structure - contains the parsed music (all statically allocated)
 struct sheet {
     NotePool *pools;            // Pointer to array of note pools (one per voice)
@@ -97,8 +156,195 @@ struct sheet {
     uint8_t meter_den;          // M: denominator (e.g., 4 in 4/4)
     uint8_t tempo_note_num;     // Q: note numerator (e.g., 1 in Q:1/4=120)
     uint8_t tempo_note_den;     // Q: note denominator (e.g., 4 in Q:1/4=120)
+
+    AbcPublication *publication;  // Parse-while-play progress (NULL = off)
+#if ABC_TRACE
+    struct AbcTrace *trace;     // Phase timing (NULL = off)
+#endif
 };
 
+// Sizing report from abc_measure() - exact requirements for a parse
+typedef struct {
+    uint8_t voice_count;        // Pools needed (pass as pool_count to sheet_init)
+    uint8_t max_chord_size;     // Largest chord seen (max_chord_notes for note_pool_init)
+    uint8_t max_duration;       // Longest note in MIDI ticks
+    uint32_t total_notes;       // Notes across all voices
+    char voice_id[ABC_MEASURE_MAX_VOICES][ABC_MAX_VOICE_ID_LEN];  // Voice IDs, in pool order
+    uint16_t notes[ABC_MEASURE_MAX_VOICES];  // Notes per voice after repeat expansion (capacity)
+} AbcMeasureReport;
+
+// Counters from abc_parse_stats() - what one parse did and how full the pools got
+typedef struct {
+    uint32_t bytes;             // Input consumed (header and body)
+    uint32_t notes;             // Single notes parsed from the text
+    uint32_t chords;            // [...] chords parsed from the text
+    uint32_t rests;
+    uint32_t tuplets;           // (n markers
+    uint32_t repeats;           // Repeat sections unfolded (that copied at least one note)
+    uint32_t notes_copied;      // Notes appended by repeat unfolding
+    uint32_t skipped_decoration;  // Decoration and "annotation" characters skipped
+    uint32_t skipped_unknown;   // Characters skipped as unrecognized
+    uint8_t key_fallbacks;      // K: values not in the key table (parsed as C major)
+    uint8_t voice_count;
+    uint16_t pool_peak[ABC_STATS_MAX_VOICES];      // Notes stored per voice (high-water mark)
+    uint16_t pool_capacity[ABC_STATS_MAX_VOICES];  // Pool capacity at the end (after any growth)
+} AbcParseStats;
+
+// Part of the input text (offset from its start, length in bytes)
+typedef struct {
+    uint16_t offset;
+    uint16_t len;               // 0 = field absent
+} AbcSpan;
+
+// abc_scan_header() flag: also skim the body for V: IDs
+#define ABC_SCAN_VOICES 0x01
+
+// Header fields found by abc_scan_header(), as spans of the input (untruncated)
+typedef struct {
+    AbcSpan number;             // X:
+    AbcSpan title;              // T: (the last one, as abc_parse() keeps)
+    AbcSpan composer;           // C:
+    AbcSpan meter;              // M:
+    AbcSpan length;             // L:
+    AbcSpan tempo;              // Q:
+    AbcSpan key;                // K:
+    uint16_t body_start;        // Where the tune body begins
+    uint16_t body_end;          // ABC_SCAN_VOICES: end of the tune (blank line or end of text)
+    uint8_t voice_count;        // ABC_SCAN_VOICES: distinct V: IDs, in order of appearance
+    uint8_t voices_truncated;   // More than ABC_SCAN_MAX_VOICES IDs were seen
+    AbcSpan voices[ABC_SCAN_MAX_VOICES];
+} AbcHeaderScan;
+
+// Bar line types reported by abc_parse_events()
+typedef enum {
+    ABC_BAR_SINGLE = 0,         // |
+    ABC_BAR_DOUBLE,             // ||
+    ABC_BAR_FINAL,              // |]
+    ABC_BAR_REPEAT_START,       // |:
+    ABC_BAR_REPEAT_END,         // :|
+    ABC_BAR_REPEAT_END_START    // :|:
+} AbcBarType;
+
+// Callbacks for abc_parse_events(); any may be NULL
+// Return 0 to continue, nonzero to stop the parse.
+typedef struct {
+    // Header field, e.g. field 'T' with the title (value is not NUL-terminated)
+    int (*header)(void *user, char field, const char *value, uint8_t len);
+    // Following notes belong to this voice (also sent for the implicit "default" voice)
+    int (*voice)(void *user, uint8_t voice, const char *id);
+    int (*bar)(void *user, AbcBarType type);
+    // Note, chord or rest (midi 0): pitches resolved through key and bar accidentals
+    int (*note)(void *user, uint8_t voice, const uint8_t *midi, uint8_t chord_size, uint8_t duration);
+} AbcEventCallbacks;
+
+// Parser state between tokens of the tune body
+// Public only so editor checkpoints can live in caller memory; treat as opaque.
+struct AbcEditRun;
+struct AbcEventSink;
+struct AbcCursor;
+struct AbcStepParser;
+typedef struct {
+    const char *input;
+    uint16_t pos;
+    uint16_t len;
+    uint16_t tempo_bpm;
+    uint8_t default_num;
+    uint8_t default_den;
+    uint8_t meter_num;
+    uint8_t meter_den;
+    uint8_t tempo_note_num;
+    uint8_t tempo_note_den;
+    int8_t key_accidentals[7];
+    int8_t bar_accidentals[7];
+    int16_t repeat_start_index;
+    int16_t repeat_end_index;
+    uint8_t in_repeat;
+    uint8_t repeat_voice;        // Voice that was current when the repeat started
+    uint8_t tuplet_remaining;
+    uint8_t tuplet_num;
+    uint8_t tuplet_in_time;
+    uint8_t current_voice;       // Current voice index
+    AbcMeasureReport *measure;   // Dry run: count notes instead of storing them
+    struct AbcEditRun *edit;     // Editor re-parse: splice notes and record checkpoints
+    struct AbcEventSink *events; // Event mode: report notes to callbacks instead of storing them
+    struct AbcCursor *cursor;    // Cursor mode: stop at each note of one voice
+    struct AbcStepParser *step;  // Step mode: stop when the step's work budget is spent
+    AbcParseStats *stats;        // abc_parse_stats(): count what the parse does
+#if ABC_TRACE
+    struct AbcTrace *trace;      // Phase timing, from the sheet
+#endif
+} ParserState;
+
+// Cooperative parse in bounded steps (see abc_parse_step); caller-owned
+typedef struct AbcStepParser {
+    ParserState state;
+    struct sheet *sheet;
+    uint16_t limit;             // Work units allowed in the current step
+    uint16_t step_pos;          // Input offset where the current step began
+    uint16_t copied;            // Repeat notes copied in the current step
+    int16_t copy_next;          // Pending repeat copy: next source note
+    uint16_t copy_pending;      // Repeat notes still to copy
+    uint8_t copy_voice;
+    uint8_t skipping;           // Kind of text still being skipped (annotation, long line or ID)
+    uint8_t phase;              // 0 = header, 1 = body, 2 = done
+    int8_t result;              // Return code once done
+} AbcStepParser;
+
+// abc_parse_step() return value while work remains
+#define ABC_PARSE_IN_PROGRESS 1
+
+// Most input bytes one abc_parse_step() call reads past its budget: the longest
+// token, a V: with 16 blanks and a 255-byte ID
+#define ABC_STEP_MAX_TOKEN 273
+
+// Reads one voice of a sheet while another core parses into it
+typedef struct {
+    const struct sheet *sheet;
+    uint8_t voice;
+    uint16_t next;              // Index of the next note to read
+} AbcReader;
+
+// Lazy note cursor (see abc_cursor_init): parses one voice on demand
+typedef struct AbcCursor {
+    ParserState state;          // Main parse position
+    ParserState repeat;         // State just after the last |: (where a replay starts)
+    ParserState replay;         // Re-parse of a repeat section
+    uint16_t replay_end;        // Offset of the :| that ends the replay
+    uint8_t replaying;
+    uint8_t ready;              // A note was written to out
+    uint8_t voice;              // Voice index this cursor follows
+    uint8_t voice_count;
+    uint16_t tempo_bpm;         // Q: field (for ticks_to_ms)
+    struct note *out;
+    char voice_id[ABC_CURSOR_MAX_VOICES][ABC_MAX_VOICE_ID_LEN];
+} AbcCursor;
+
+// Editor checkpoint: parser state at a bar line or line start, plus where
+// each voice's note list ended at that point
+typedef struct {
+    ParserState state;          // state.pos is the text offset
+    uint8_t voice_count;
+    int16_t tail[ABC_EDIT_MAX_VOICES];    // Last note of each voice so far (-1 = none)
+    uint16_t notes[ABC_EDIT_MAX_VOICES];  // Notes in each voice so far
+    uint32_t ticks[ABC_EDIT_MAX_VOICES];  // Ticks in each voice so far
+} AbcCheckpoint;
+
+// Incremental re-parser for live editing (see abc_editor_init)
+typedef struct {
+    struct sheet *sheet;
+    char *text;                 // Tune text, edited in place (NUL-terminated)
+    uint32_t text_capacity;
+    uint16_t text_len;
+    uint16_t body_start;        // First byte after the header
+    AbcCheckpoint *checkpoints; // Sorted by position
+    uint16_t checkpoint_capacity;
+    uint16_t checkpoint_count;
+    uint16_t checkpoint_gap;    // Minimum bytes between checkpoints (doubles when full)
+    uint8_t cross_voice_repeats;  // A repeat started in one voice and ended in another
+    uint8_t last_full;          // 1 if the last edit re-parsed the whole tune
+    uint16_t last_reparsed;     // Bytes of text the last edit re-parsed
+} AbcEditor;
+
 // Frequency lookup table indexed by MIDI note (0-127), stored as freq * 10
 // Index directly with MIDI note number for O(1) lookup
 // Covers MIDI notes 12-95 (C0-B6), values outside range return 0 or clamped
@@ -114,7 +360,16 @@ extern const uint16_t midi_frequencies_x10[128];
 // max_chord_notes: maximum simultaneous notes per chord (clamped to ABC_MAX_CHORD_NOTES)
 void note_pool_init(NotePool *pool, struct note *buffer, uint16_t capacity, uint8_t max_chord_notes);
 
-// Reset pool (reuse memory for new parse)
+// Let a pool grow through an allocator instead of failing when full
+// (NULL restores the default fixed-capacity, zero-allocation behavior)
+// Pools may then start with a NULL buffer and capacity 0
+void note_pool_set_allocator(NotePool *pool, const AbcAllocator *allocator);
+
+// Make room for at least `capacity` notes, growing through the allocator if needed
+// Returns 0 on success, -1 if the pool is too small and cannot grow
+int note_pool_reserve(NotePool *pool, uint16_t capacity);
+
+// Reset pool (reuse memory for new parse, keeps buffer and allocator)
 void note_pool_reset(NotePool *pool);
 
 // Get remaining capacity
@@ -132,9 +387,126 @@ void sheet_init(struct sheet *sheet, NotePool *pools, uint8_t pool_count);
 // Parse ABC notation into pre-allocated sheet
 // Returns 0 on success, negative on error
 //   -1: NULL input
-//   -2: Note pool exhausted
+//   -2: Note pool exhausted (and could not grow)
 int abc_parse(struct sheet *sheet, const char *abc_string);
 
+// abc_parse() of the first len bytes of abc_string, which need not be
+// NUL-terminated (e.g. one tune inside a mapped collection file)
+int abc_parse_len(struct sheet *sheet, const char *abc_string, uint16_t len);
+
+// abc_parse() that also fills `stats` (cleared first): tokens parsed, repeat
+// work, skipped characters, key fallbacks and per-voice pool high-water marks.
+// Same results as abc_parse(); stats are filled on failure too. With
+// ABC_PARSE_STATS 0 the counters are compiled out and only the pool figures
+// and bytes are reported.
+int abc_parse_stats(struct sheet *sheet, const char *abc_string, AbcParseStats *stats);
+
+// Dry run: parse without storing notes and report exact pool requirements
+// Assumes one pool per voice (up to ABC_MEASURE_MAX_VOICES voices)
+// Returns 0 on success, negative on error
+//   -1: NULL input
+//   -2: A voice needs more notes than a NotePool can index (32767)
+int abc_measure(const char *abc_string, AbcMeasureReport *report);
+
+// Catalog scan: read the header fields as abc_parse() would, without parsing
+// notes. Fields are returned as spans into abc_string instead of truncated
+// copies. With ABC_SCAN_VOICES the body is also skimmed (annotations and
+// bracketed groups skipped, like the parser) for V: IDs; a blank line ends
+// the tune there, so a pointer into a collection file scans one tune.
+// Returns 0 on success, -1 on NULL input
+int abc_scan_header(const char *abc_string, uint8_t flags, AbcHeaderScan *scan);
+
+// Event mode: parse without note pools, calling back per header field, voice
+// switch, bar line and note/chord. Memory use is constant (no sheet needed).
+// Repeats are reported as bar events rather than unfolded (abc_parse() copies
+// the notes between ABC_BAR_REPEAT_START and the next ABC_BAR_REPEAT_END; an
+// end without a start copies nothing).
+// Returns 0 on success, negative on error
+//   -1: NULL input
+//   -3: A callback stopped the parse
+int abc_parse_events(const char *abc_string, const AbcEventCallbacks *callbacks, void *user);
+
+// Parse while playing: publish progress through pub so a playback thread can
+// read notes as soon as they are stored, without locks. Call before starting
+// the reader (pub is cleared); NULL turns publication off.
+// Applies to abc_parse() and abc_parse_step(), which return -1 if a pool has
+// an allocator (storage would move under the reader) or the sheet has more
+// than ABC_PUBLISH_MAX_VOICES pools.
+void sheet_set_publication(struct sheet *sheet, AbcPublication *pub);
+
+#if ABC_TRACE
+// Time parse phases of this sheet into `trace` (NULL = off; see abc_trace.h)
+void sheet_set_trace(struct sheet *sheet, struct AbcTrace *trace);
+#endif
+
+// Start reading `voice` of a sheet that is being parsed with a publication
+void abc_reader_init(AbcReader *reader, const struct sheet *sheet, uint8_t voice);
+
+// Copy the next published note (next_index set to -1); notes come in list order
+// Returns 1 if a note was copied, 0 if none is published yet, -1 once the parse
+// has finished and every note of the voice was read (or on invalid arguments)
+int abc_reader_next(AbcReader *reader, struct note *note);
+
+// Start a cooperative parse of abc_string into sheet (same result as abc_parse)
+// The text must stay valid until the parse is done.
+// Returns 0 on success, -1 on invalid arguments
+int abc_parse_begin(AbcStepParser *parser, struct sheet *sheet, const char *abc_string);
+
+// Do a bounded amount of parsing: about max_units work units, one unit being
+// an input byte or a note copied by a repeat. Steps stop between tokens, so a
+// step does at most max_units + ABC_STEP_MAX_TOKEN units. Tokens are capped
+// to keep that small: a chord ends 64 bytes after its '[', runs of
+// accidentals, octave marks, digits or slashes are read 16 bytes at a time,
+// and header values and voice IDs keep their first 255 bytes. Whitespace,
+// annotations, the rest of long header lines and IDs, and repeat copies are
+// split across steps.
+// Returns ABC_PARSE_IN_PROGRESS, then abc_parse()'s result (0, -2) once done;
+// -1 on invalid arguments
+int abc_parse_step(AbcStepParser *parser, uint16_t max_units);
+
+// Lazy cursor over one voice: parses the header now and the body only as far
+// as each abc_cursor_next() call needs, so playback can start at once without
+// note storage. The text must stay valid while the cursor is used.
+// voice: voice index in order of appearance, as in sheet->pools
+// Returns 0 on success, -1 on invalid arguments
+int abc_cursor_init(AbcCursor *cursor, const char *abc_string, uint8_t voice);
+
+// Next note of the cursor's voice (next_index is -1)
+// Repeats are replayed by re-parsing the section from its remembered input
+// offset, giving the same notes abc_parse() copies. A repeat started in another
+// voice is not replayed. Voices beyond ABC_CURSOR_MAX_VOICES are ignored, as
+// abc_parse() ignores voices beyond its pools.
+// Returns 1 if a note was stored, 0 at the end of the tune, -1 on invalid arguments
+int abc_cursor_next(AbcCursor *cursor, struct note *note);
+
+// ============================================================================
+// Incremental Editing
+// ============================================================================
+//
+// The editor keeps a tune's text and its parsed sheet in sync. Each edit
+// resumes parsing from the last checkpoint before the change and stops as soon
+// as the parser state matches the old parse again at a later checkpoint; the
+// re-parsed notes are spliced into the existing lists through next_index.
+//
+// Spliced-out notes stay allocated, so after edits pool->count is the storage
+// in use rather than the list length (walk the list to count notes). When a
+// pool runs out, the editor compacts everything with a full re-parse. Edits in
+// the header, or that make the parse create a voice, also re-parse fully; so do
+// all edits once a repeat starts in one voice and ends in another.
+
+// Start editing: parses text (NUL-terminated, inside a buffer of text_capacity
+// bytes) into the sheet and records checkpoints in caller memory
+// The sheet may have at most ABC_EDIT_MAX_VOICES pools; checkpoint_capacity >= 4
+// Returns 0 on success, -1 on invalid arguments, -2 if a pool is exhausted
+int abc_editor_init(AbcEditor *editor, struct sheet *sheet, char *text, uint32_t text_capacity,
+                    AbcCheckpoint *checkpoints, uint16_t checkpoint_capacity);
+
+// Replace text[start, end) with replacement and update the sheet
+// Returns 0 on success, -1 on an invalid range or if the text would not fit,
+// -2 if a pool is exhausted even after a full re-parse
+int abc_editor_edit(AbcEditor *editor, uint16_t start, uint16_t end,
+                    const char *replacement, uint16_t replacement_len);
+
 // Reset sheet for reuse (also resets all note pools)
 void sheet_reset(struct sheet *sheet);
 
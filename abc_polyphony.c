@@ -0,0 +1,209 @@
+#include "abc_polyphony.h"
+#include <string.h>
+
+#define NO_VOICE 0xFF
+
+// Allocation state of one oscillator
+typedef struct {
+    uint32_t start;             // Tick the current pitch started
+    uint32_t end;               // Tick it ends
+    uint32_t segment;           // Tick the pending stream segment started
+    uint8_t midi;               // Current pitch (0 = free)
+    uint8_t voice;              // Voice of the current (or last) pitch
+} Oscillator;
+
+typedef struct {
+    const AbcPolyConfig *config;
+    AbcOscStream *streams;
+    Oscillator osc[ABC_POLY_MAX_OSCILLATORS];
+    AbcPolyStats stats;
+    int result;
+} Allocation;
+
+static uint8_t voice_priority(const Allocation *a, uint8_t v) {
+    return a->config->priority ? a->config->priority[v] : (uint8_t)(255 - v);
+}
+
+// ============================================================================
+// Stream output
+// ============================================================================
+
+static void stream_write(Allocation *a, uint8_t o, uint8_t midi, uint8_t voice, uint32_t ticks) {
+    AbcOscStream *stream = &a->streams[o];
+    while (ticks > 0) {
+        uint16_t chunk = (uint16_t)(ticks > 0xFFFF ? 0xFFFF : ticks);
+        if (stream->count == 0xFFFF || (stream->commands && stream->count >= stream->capacity)) {
+            a->result = -2;
+            return;
+        }
+        if (stream->commands) {
+            AbcOscCommand *c = &stream->commands[stream->count];
+            c->ticks = chunk;
+            c->midi = midi;
+            c->voice = voice;
+        }
+        stream->count++;
+        ticks -= chunk;
+    }
+}
+
+// Close the pending segment at `tick` and start a new one
+static void osc_set(Allocation *a, uint8_t o, uint32_t tick, uint8_t midi, uint8_t voice) {
+    Oscillator *osc = &a->osc[o];
+    if (tick > osc->segment) stream_write(a, o, osc->midi, osc->voice, tick - osc->segment);
+    osc->segment = tick;
+    osc->midi = midi;
+    osc->voice = voice;
+}
+
+// ============================================================================
+// Allocation
+// ============================================================================
+
+// Pick an oscillator for a pitch of voice v starting at tick, or -1 to drop it
+static int pick_oscillator(const Allocation *a, uint8_t v, uint32_t tick) {
+    const AbcPolyConfig *config = a->config;
+    int free_any = -1, free_same = -1;
+    for (uint8_t o = 0; o < config->oscillators; o++) {
+        if (a->osc[o].midi) continue;
+        if (free_any < 0) free_any = o;
+        if (free_same < 0 && a->osc[o].voice == v) free_same = o;  // Keeps voices on the same channel
+    }
+    if (free_same >= 0) return free_same;
+    if (free_any >= 0) return free_any;
+
+    int victim = -1;
+    for (uint8_t o = 0; o < config->oscillators; o++) {
+        const Oscillator *osc = &a->osc[o];
+        if (osc->start >= tick) continue;  // Started together: earlier in order wins
+
+        switch (config->rule) {
+            case ABC_STEAL_LOWEST_PRIORITY: {
+                uint8_t p = voice_priority(a, osc->voice);
+                if (p > voice_priority(a, v)) continue;
+                if (victim >= 0) {
+                    uint8_t best = voice_priority(a, a->osc[victim].voice);
+                    if (p > best || (p == best && osc->start >= a->osc[victim].start)) continue;
+                }
+                break;
+            }
+            case ABC_STEAL_KEEP_MELODY:
+                if (osc->voice == config->melody_voice && v != config->melody_voice) continue;
+                // Prefer anything outside the melody, then the oldest
+                if (victim >= 0) {
+                    int in_melody = osc->voice == config->melody_voice;
+                    int best_in_melody = a->osc[victim].voice == config->melody_voice;
+                    if (in_melody > best_in_melody) continue;
+                    if (in_melody == best_in_melody && osc->start >= a->osc[victim].start) continue;
+                }
+                break;
+            default:
+                if (victim >= 0 && osc->start >= a->osc[victim].start) continue;
+                break;
+        }
+        victim = o;
+    }
+    return victim;
+}
+
+static void start_note(Allocation *a, uint8_t v, const struct note *n, uint32_t tick) {
+    // Highest pitch first: it usually carries the line
+    uint8_t pitches[ABC_MAX_CHORD_NOTES];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < n->chord_size && i < ABC_MAX_CHORD_NOTES; i++) {
+        uint8_t midi = n->midi_note[i];
+        if (midi == 0) continue;
+        uint8_t j = count++;
+        for (; j > 0 && pitches[j - 1] < midi; j--) pitches[j] = pitches[j - 1];
+        pitches[j] = midi;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        a->stats.pitches++;
+        int o = pick_oscillator(a, v, tick);
+        if (o < 0) {
+            a->stats.dropped++;
+            continue;
+        }
+        if (a->osc[o].midi) a->stats.stolen++;
+        osc_set(a, (uint8_t)o, tick, pitches[i], v);
+        a->osc[o].start = tick;
+        a->osc[o].end = tick + n->duration;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+int abc_polyphony_allocate(const struct sheet *sheet, const AbcPolyConfig *config,
+                           AbcOscStream *streams, AbcPolyStats *stats) {
+    if (!sheet || !config || !streams) return -1;
+    if (config->oscillators == 0 || config->oscillators > ABC_POLY_MAX_OSCILLATORS) return -1;
+    if (sheet->voice_count > ABC_POLY_MAX_VOICES || (sheet->voice_count > 0 && !sheet->pools)) return -1;
+
+    Allocation a;
+    memset(&a, 0, sizeof(a));
+    a.config = config;
+    a.streams = streams;
+    for (uint8_t o = 0; o < config->oscillators; o++) {
+        streams[o].count = 0;
+        a.osc[o].voice = NO_VOICE;
+    }
+
+    // Voices in the order they claim oscillators when starting together
+    uint8_t order[ABC_POLY_MAX_VOICES];
+    uint8_t voice_count = sheet->voice_count;
+    for (uint8_t v = 0; v < voice_count; v++) {
+        uint8_t j = v;
+        if (config->rule == ABC_STEAL_KEEP_MELODY) {
+            for (; j > 0 && v == config->melody_voice; j--) order[j] = order[j - 1];
+        } else if (config->rule == ABC_STEAL_LOWEST_PRIORITY) {
+            for (; j > 0 && voice_priority(&a, order[j - 1]) < voice_priority(&a, v); j--) order[j] = order[j - 1];
+        }
+        order[j] = v;
+    }
+
+    const struct note *next[ABC_POLY_MAX_VOICES];
+    uint32_t next_tick[ABC_POLY_MAX_VOICES];
+    for (uint8_t v = 0; v < voice_count; v++) {
+        next[v] = pool_first_note(&sheet->pools[v]);
+        next_tick[v] = 0;
+        if (sheet->pools[v].total_ticks > a.stats.total_ticks) a.stats.total_ticks = sheet->pools[v].total_ticks;
+    }
+
+    // Visit every tick where a pitch starts or ends, in order
+    for (;;) {
+        uint32_t tick = UINT32_MAX;
+        for (uint8_t v = 0; v < voice_count; v++) {
+            if (next[v] && next_tick[v] < tick) tick = next_tick[v];
+        }
+        for (uint8_t o = 0; o < config->oscillators; o++) {
+            if (a.osc[o].midi && a.osc[o].end < tick) tick = a.osc[o].end;
+        }
+        if (tick == UINT32_MAX) break;
+
+        // Ends first, so their oscillators are free for what starts here
+        for (uint8_t o = 0; o < config->oscillators; o++) {
+            if (a.osc[o].midi && a.osc[o].end == tick) osc_set(&a, o, tick, 0, a.osc[o].voice);
+        }
+        for (uint8_t i = 0; i < voice_count; i++) {
+            uint8_t v = order[i];
+            const NotePool *pool = &sheet->pools[v];
+            while (next[v] && next_tick[v] == tick) {
+                if (next[v]->duration > 0) start_note(&a, v, next[v], tick);
+                next_tick[v] += next[v]->duration;
+                next[v] = note_next(pool, next[v]);
+            }
+        }
+        if (tick > a.stats.total_ticks) a.stats.total_ticks = tick;
+    }
+
+    // Pad every stream with silence to the common end
+    for (uint8_t o = 0; o < config->oscillators; o++) {
+        osc_set(&a, o, a.stats.total_ticks, 0, a.osc[o].voice);
+    }
+
+    if (stats) *stats = a.stats;
+    return a.result;
+}
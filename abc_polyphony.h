@@ -0,0 +1,72 @@
+#ifndef ABC_POLYPHONY_H
+#define ABC_POLYPHONY_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Polyphony limiter - oscillator allocation ahead of playback
+// ============================================================================
+//
+// Sound chips have a handful of oscillators, while a sheet can ask for
+// voice_count x chord_size pitches at once. abc_polyphony_allocate() walks the
+// whole sheet once, maps every sounding pitch to an oscillator and writes one
+// command stream per oscillator. The playback ISR then only counts ticks:
+//
+//   if (--remaining == 0) {
+//       const AbcOscCommand *c = &stream->commands[next++];
+//       set_pitch(osc, c->midi);          // 0 = silent
+//       remaining = c->ticks;
+//   }
+//
+// Every stream covers the whole tune, so all oscillators stay in step (and
+// can loop together). When no oscillator is free, the rule decides which
+// sounding pitch is cut; a pitch may only cut one that started earlier, so
+// pitches starting together are kept in voice order (by priority), highest
+// chord note first, and the rest are dropped.
+
+#define ABC_POLY_MAX_OSCILLATORS 8   // Oscillators one pass can allocate
+#define ABC_POLY_MAX_VOICES     16   // Voices one pass can read
+
+typedef enum {
+    ABC_STEAL_OLDEST,           // Cut the pitch that started first
+    ABC_STEAL_LOWEST_PRIORITY,  // Cut a pitch of the least important voice (never a more important one)
+    ABC_STEAL_KEEP_MELODY       // Cut the oldest pitch outside the melody voice
+} AbcStealRule;
+
+// One segment of an oscillator's output
+typedef struct {
+    uint16_t ticks;             // Length in MIDI ticks (long segments are split)
+    uint8_t midi;               // Pitch to play (0 = silent)
+    uint8_t voice;              // Voice the pitch came from (last voice while silent, 0xFF before any)
+} AbcOscCommand;
+
+// Caller-provided stream for one oscillator
+typedef struct {
+    AbcOscCommand *commands;    // NULL = only count the commands needed
+    uint16_t capacity;
+    uint16_t count;             // Commands written (or needed)
+} AbcOscStream;
+
+typedef struct {
+    uint8_t oscillators;        // 1..ABC_POLY_MAX_OSCILLATORS
+    AbcStealRule rule;
+    uint8_t melody_voice;       // For ABC_STEAL_KEEP_MELODY
+    const uint8_t *priority;    // Per voice, higher wins (NULL = earlier voices win)
+} AbcPolyConfig;
+
+typedef struct {
+    uint32_t pitches;           // Pitches the sheet asked for
+    uint32_t stolen;            // Pitches cut short to make room
+    uint32_t dropped;           // Pitches that found no oscillator
+    uint32_t total_ticks;       // Length of every stream
+} AbcPolyStats;
+
+// Allocate oscillators for a parsed sheet and fill one stream per oscillator
+// streams: config->oscillators entries; stats may be NULL
+// Returns 0 on success, -1 on invalid arguments, -2 if a stream is too small
+// (counts are still filled in, so a NULL-commands pass sizes the buffers)
+int abc_polyphony_allocate(const struct sheet *sheet, const AbcPolyConfig *config,
+                           AbcOscStream *streams, AbcPolyStats *stats);
+
+#endif // ABC_POLYPHONY_H
@@ -0,0 +1,231 @@
+#include "abc_search.h"
+#include <string.h>
+
+// ============================================================================
+// Melodies and n-grams
+// ============================================================================
+
+// Top pitch of a note (0 for a rest)
+static uint8_t top_pitch(const struct note *n) {
+    uint8_t top = 0;
+    for (uint8_t i = 0; i < n->chord_size && i < ABC_MAX_CHORD_NOTES; i++) {
+        if (n->midi_note[i] > top) top = n->midi_note[i];
+    }
+    return top;
+}
+
+uint32_t abc_search_melody(const NotePool *pool, uint8_t *midi, uint32_t max) {
+    if (!pool || !midi) return 0;
+    uint32_t count = 0;
+    for (struct note *n = pool_first_note(pool); n && count < max; n = note_next(pool, n)) {
+        uint8_t pitch = top_pitch(n);
+        if (pitch) midi[count++] = pitch;
+    }
+    return count;
+}
+
+// Rolling n-gram over the last ABC_SEARCH_N intervals, in base ABC_SEARCH_SYMBOLS
+typedef struct {
+    uint32_t gram;
+    uint8_t prev;               // Previous pitch (0 = none yet)
+    uint8_t intervals;          // Intervals in gram, up to ABC_SEARCH_N
+} GramState;
+
+// Push a pitch; returns 1 when gram holds a full n-gram
+static int gram_push(GramState *g, uint8_t pitch) {
+    if (pitch == 0) return 0;
+    if (g->prev == 0) {
+        g->prev = pitch;
+        return 0;
+    }
+    int interval = (int)pitch - (int)g->prev;
+    if (interval > ABC_SEARCH_MAX_LEAP) interval = ABC_SEARCH_MAX_LEAP;
+    if (interval < -ABC_SEARCH_MAX_LEAP) interval = -ABC_SEARCH_MAX_LEAP;
+    g->gram = (g->gram * ABC_SEARCH_SYMBOLS + (uint32_t)(interval + ABC_SEARCH_MAX_LEAP)) % ABC_SEARCH_GRAMS;
+    g->prev = pitch;
+    if (g->intervals < ABC_SEARCH_N) g->intervals++;
+    return g->intervals == ABC_SEARCH_N;
+}
+
+// ============================================================================
+// Postings (LEB128 deltas of tune id + 1)
+// ============================================================================
+
+static uint8_t varint_len(uint32_t v) {
+    uint8_t len = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        len++;
+    }
+    return len;
+}
+
+static void add_gram(AbcSearchIndex *index, uint32_t gram, uint32_t tune) {
+    uint32_t id = tune + 1;
+    if (index->last[gram] == id) return;        // Each tune listed once per n-gram
+    uint32_t delta = id - index->last[gram];
+    uint8_t len = varint_len(delta);
+    index->last[gram] = id;
+
+    if (index->phase == ABC_SEARCH_SIZING) {
+        index->offsets[gram] += len;
+        index->postings_size += len;
+        return;
+    }
+    uint32_t pos = index->offsets[gram];
+    if (len > index->postings_size - index->written || pos + len > index->postings_size) {
+        index->phase = ABC_SEARCH_FAILED;
+        return;
+    }
+    for (; delta >= 0x80; delta >>= 7) index->postings[pos++] = (uint8_t)(delta | 0x80);
+    index->postings[pos++] = (uint8_t)delta;
+    index->offsets[gram] = pos;
+    index->written += len;
+}
+
+// ============================================================================
+// Building
+// ============================================================================
+
+int abc_search_init(AbcSearchIndex *index, uint32_t *offsets, uint32_t *last) {
+    if (!index || !offsets || !last) return -1;
+    memset(index, 0, sizeof(*index));
+    index->offsets = offsets;
+    index->last = last;
+    memset(offsets, 0, (ABC_SEARCH_GRAMS + 1) * sizeof(uint32_t));
+    memset(last, 0, ABC_SEARCH_GRAMS * sizeof(uint32_t));
+    index->phase = ABC_SEARCH_SIZING;
+    return 0;
+}
+
+// Next tune id for the current pass (-1 if adding is not allowed now)
+static int32_t next_tune(AbcSearchIndex *index) {
+    if (index->phase == ABC_SEARCH_SIZING) return (int32_t)index->tune_count++;
+    if (index->phase != ABC_SEARCH_FILLING) return -1;
+    if (index->filled == index->tune_count) {
+        index->phase = ABC_SEARCH_FAILED;       // More tunes than were sized
+        return -1;
+    }
+    return (int32_t)index->filled++;
+}
+
+int32_t abc_search_add(AbcSearchIndex *index, const NotePool *pool) {
+    if (!index || !pool) return -1;
+    int32_t tune = next_tune(index);
+    if (tune < 0) return -1;
+
+    GramState g = { 0, 0, 0 };
+    for (struct note *n = pool_first_note(pool); n; n = note_next(pool, n)) {
+        if (gram_push(&g, top_pitch(n))) add_gram(index, g.gram, (uint32_t)tune);
+    }
+    return tune;
+}
+
+int32_t abc_search_add_melody(AbcSearchIndex *index, const uint8_t *midi, uint32_t count) {
+    if (!index || (!midi && count > 0)) return -1;
+    int32_t tune = next_tune(index);
+    if (tune < 0) return -1;
+
+    GramState g = { 0, 0, 0 };
+    for (uint32_t i = 0; i < count; i++) {
+        if (gram_push(&g, midi[i])) add_gram(index, g.gram, (uint32_t)tune);
+    }
+    return tune;
+}
+
+int abc_search_layout(AbcSearchIndex *index, uint8_t *postings, uint32_t size) {
+    if (!index || index->phase != ABC_SEARCH_SIZING) return -1;
+    if (!postings || size < index->postings_size) return -2;
+
+    // Byte counts become start offsets
+    uint32_t start = 0;
+    for (uint32_t g = 0; g < ABC_SEARCH_GRAMS; g++) {
+        uint32_t bytes = index->offsets[g];
+        index->offsets[g] = start;
+        start += bytes;
+    }
+    index->offsets[ABC_SEARCH_GRAMS] = start;
+    memset(index->last, 0, ABC_SEARCH_GRAMS * sizeof(uint32_t));
+    index->postings = postings;
+    index->phase = ABC_SEARCH_FILLING;
+    return 0;
+}
+
+int abc_search_finish(AbcSearchIndex *index) {
+    if (!index || index->phase != ABC_SEARCH_FILLING) return -1;
+    if (index->filled != index->tune_count || index->written != index->postings_size) {
+        index->phase = ABC_SEARCH_FAILED;
+        return -1;
+    }
+    // Each offset now marks its n-gram's end, which is the next one's start
+    for (uint32_t g = ABC_SEARCH_GRAMS; g > 0; g--) index->offsets[g] = index->offsets[g - 1];
+    index->offsets[0] = 0;
+    index->phase = ABC_SEARCH_READY;
+    return 0;
+}
+
+// ============================================================================
+// Query
+// ============================================================================
+
+int32_t abc_search_query(const AbcSearchIndex *index, const uint8_t *midi, uint32_t count,
+                         uint32_t *scores, AbcSearchHit *hits, uint32_t max_hits) {
+    if (!index || index->phase != ABC_SEARCH_READY) return -1;
+    if ((!midi && count > 0) || (!scores && index->tune_count > 0) || (!hits && max_hits > 0)) return -1;
+    if (count > ABC_SEARCH_MAX_QUERY) count = ABC_SEARCH_MAX_QUERY;
+
+    // Distinct n-grams of the fragment
+    uint32_t grams[ABC_SEARCH_MAX_QUERY];
+    uint32_t gram_count = 0;
+    GramState g = { 0, 0, 0 };
+    for (uint32_t i = 0; i < count; i++) {
+        if (!gram_push(&g, midi[i])) continue;
+        uint32_t j = 0;
+        while (j < gram_count && grams[j] != g.gram) j++;
+        if (j == gram_count) grams[gram_count++] = g.gram;
+    }
+
+    // Scores hold weight << 8 | n-grams matched
+    memset(scores, 0, index->tune_count * sizeof(uint32_t));
+    for (uint32_t i = 0; i < gram_count; i++) {
+        const uint8_t *p = index->postings + index->offsets[grams[i]];
+        const uint8_t *end = index->postings + index->offsets[grams[i] + 1];
+
+        // Tunes listed = bytes ending a varint; weight 1 + log2(tunes / listed)
+        uint32_t listed = 0;
+        for (const uint8_t *q = p; q < end; q++) listed += *q < 0x80;
+        if (listed == 0) continue;
+        uint32_t weight = 1;
+        for (uint32_t ratio = index->tune_count / listed; ratio > 1; ratio >>= 1) weight++;
+
+        uint32_t id = 0;
+        while (p < end) {
+            uint32_t delta = 0;
+            for (uint8_t shift = 0; p < end; shift += 7) {
+                uint8_t b = *p++;
+                delta |= (uint32_t)(b & 0x7F) << shift;
+                if (b < 0x80) break;
+            }
+            id += delta;
+            scores[id - 1] += weight << 8 | 1;
+        }
+    }
+
+    // Keep the best max_hits, scanning in tune order so ties favor lower ids
+    uint32_t found = 0;
+    for (uint32_t t = 0; t < index->tune_count && max_hits > 0; t++) {
+        uint32_t s = scores[t];
+        if (s == 0) continue;
+        if (found == max_hits && s <= ((uint32_t)hits[found - 1].score << 8 | hits[found - 1].matched)) continue;
+
+        uint32_t i = found < max_hits ? found++ : found - 1;
+        while (i > 0 && s > ((uint32_t)hits[i - 1].score << 8 | hits[i - 1].matched)) {
+            hits[i] = hits[i - 1];
+            i--;
+        }
+        hits[i].tune = t;
+        hits[i].score = (uint16_t)(s >> 8);
+        hits[i].matched = (uint16_t)(s & 0xFF);
+    }
+    return (int32_t)found;
+}
@@ -0,0 +1,92 @@
+#ifndef ABC_SEARCH_H
+#define ABC_SEARCH_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Melody search - find tunes containing a fragment, in any key
+// ============================================================================
+//
+// Each tune is reduced to its melody: rests are skipped and a chord counts as
+// its top note. The melody's intervals are cut into overlapping n-grams of
+// ABC_SEARCH_N intervals, so a fragment matches in any transposition.
+// Intervals beyond an octave count as an octave, which leaves few enough
+// distinct n-grams (ABC_SEARCH_GRAMS) to address them directly.
+//
+// The inverted index lists, per n-gram, the tunes containing it as
+// delta-coded variable-length tune ids (one or two bytes each for most
+// entries). All memory is caller-provided. Like sizing with abc_measure()
+// before parsing, the index is built in two passes over the same tunes in the
+// same order:
+//
+//   abc_search_init()                      tables
+//   abc_search_add() per tune              sizing pass
+//   abc_search_layout()                    postings buffer (postings_size bytes)
+//   abc_search_add() per tune              filling pass
+//   abc_search_finish()                    ready for abc_search_query()
+//
+// A query scores every tune that shares n-grams with the fragment; rare
+// n-grams weigh more than common ones (an inverse document frequency).
+
+#define ABC_SEARCH_N 4              // Intervals per n-gram (5 notes)
+#define ABC_SEARCH_MAX_LEAP 12      // Larger intervals count as this many semitones
+#define ABC_SEARCH_SYMBOLS (2 * ABC_SEARCH_MAX_LEAP + 1)
+#define ABC_SEARCH_GRAMS (ABC_SEARCH_SYMBOLS * ABC_SEARCH_SYMBOLS * ABC_SEARCH_SYMBOLS * ABC_SEARCH_SYMBOLS)
+#define ABC_SEARCH_MAX_QUERY 64     // Query notes used (the rest are ignored)
+
+typedef enum {
+    ABC_SEARCH_SIZING = 0,
+    ABC_SEARCH_FILLING,
+    ABC_SEARCH_READY,
+    ABC_SEARCH_FAILED           // Filling pass did not match the sizing pass
+} AbcSearchPhase;
+
+typedef struct {
+    uint32_t *offsets;          // ABC_SEARCH_GRAMS + 1 entries: n-gram postings start in `postings`
+    uint32_t *last;             // ABC_SEARCH_GRAMS entries: last tune added per n-gram (building only)
+    uint8_t *postings;
+    uint32_t postings_size;     // Bytes needed (after sizing) or used
+    uint32_t tune_count;
+    uint32_t filled;            // Tunes added in the filling pass
+    uint32_t written;           // Postings bytes written in the filling pass
+    uint8_t phase;              // AbcSearchPhase
+} AbcSearchIndex;
+
+typedef struct {
+    uint32_t tune;              // Order in which the tune was added (0 = first)
+    uint16_t score;             // Weighted n-grams shared with the query
+    uint16_t matched;           // Distinct query n-grams the tune contains
+} AbcSearchHit;
+
+// Melody of a pool: one pitch per note, rests skipped, top note of chords
+// Returns the pitches written (at most max)
+uint32_t abc_search_melody(const NotePool *pool, uint8_t *midi, uint32_t max);
+
+// Start building; offsets and last are the tables sized above
+// Returns 0 on success, -1 on NULL arguments
+int abc_search_init(AbcSearchIndex *index, uint32_t *offsets, uint32_t *last);
+
+// Add a tune from one voice's pool (usually the melody voice)
+// Returns the tune's id, or -1 on invalid arguments or wrong phase
+int32_t abc_search_add(AbcSearchIndex *index, const NotePool *pool);
+
+// As abc_search_add(), from pitches (0 = rest, skipped)
+int32_t abc_search_add_melody(AbcSearchIndex *index, const uint8_t *midi, uint32_t count);
+
+// End the sizing pass: postings needs index->postings_size bytes
+// Returns 0 on success, -1 on wrong phase, -2 if size is too small
+int abc_search_layout(AbcSearchIndex *index, uint8_t *postings, uint32_t size);
+
+// End the filling pass
+// Returns 0 on success, -1 if the tunes differed from the sizing pass
+int abc_search_finish(AbcSearchIndex *index);
+
+// Rank tunes by the n-grams they share with a fragment (pitches, 0 = rest)
+// scores: tune_count entries of working memory
+// Fills up to max_hits best hits, highest score first (ties: lower tune id)
+// Returns the hits written, or -1 on invalid arguments or an unfinished index
+int32_t abc_search_query(const AbcSearchIndex *index, const uint8_t *midi, uint32_t count,
+                         uint32_t *scores, AbcSearchHit *hits, uint32_t max_hits);
+
+#endif // ABC_SEARCH_H
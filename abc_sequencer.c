@@ -0,0 +1,229 @@
+#include "abc_sequencer.h"
+#include <string.h>
+
+// ============================================================================
+// Clock conversion
+// ============================================================================
+
+// Recompute the tick rate after a tempo change (not per event)
+static void update_rate(AbcSequencer *seq) {
+    const struct sheet *sheet = seq->sheet;
+    uint64_t bpm = sheet->tempo_bpm ? sheet->tempo_bpm : 120;
+    uint64_t num = sheet->tempo_note_num ? sheet->tempo_note_num : 1;
+    uint64_t den = sheet->tempo_note_den ? sheet->tempo_note_den : 4;
+
+    // q: ticks per minute (Q16.16 after the tempo scale), d: clock units per minute
+    // Q:1/8=120 is 120 eighths per minute, so the tempo note sets the beat length
+    uint64_t q = bpm * 4 * ABC_PPQ * num * seq->tempo_scale;
+    uint64_t d = den * 60 * seq->config.clock_rate;
+    // Round the rate up so an event falls due no later than its exact time
+    seq->ticks_per_unit = ((q / d) << 16) + (((q % d) << 16) + d - 1) / d;
+    seq->units_per_tick = (d << 16) / ((q >> 16) ? (q >> 16) : 1);
+}
+
+// Clock value an event at `tick` should sound at (now if it is already due)
+static uint32_t event_time(const AbcSequencer *seq, uint32_t tick) {
+    uint64_t at = (uint64_t)tick << 32;
+    if (at <= seq->pos) return seq->now;
+    return seq->now + (uint32_t)((((at - seq->pos) >> 16) * seq->units_per_tick + 0x80000000u) >> 32);
+}
+
+// ============================================================================
+// Voice heap
+// ============================================================================
+
+// Tick first, then note-offs before note-ons, then voice order
+static uint64_t voice_key(const AbcSequencer *seq, uint8_t v) {
+    const AbcSeqVoice *voice = &seq->voices[v];
+    return ((uint64_t)voice->tick << 8) | (voice->sounding ? 0u : 0x80u) | v;
+}
+
+static void heap_sift_down(AbcSequencer *seq, uint8_t i) {
+    for (;;) {
+        uint8_t least = i;
+        uint8_t left = (uint8_t)(2 * i + 1), right = (uint8_t)(2 * i + 2);
+        if (left < seq->heap_size && voice_key(seq, seq->heap[left]) < voice_key(seq, seq->heap[least])) least = left;
+        if (right < seq->heap_size && voice_key(seq, seq->heap[right]) < voice_key(seq, seq->heap[least])) least = right;
+        if (least == i) return;
+        uint8_t tmp = seq->heap[i];
+        seq->heap[i] = seq->heap[least];
+        seq->heap[least] = tmp;
+        i = least;
+    }
+}
+
+static void heap_build(AbcSequencer *seq) {
+    seq->heap_size = 0;
+    for (uint8_t v = 0; v < seq->voice_count; v++) {
+        if (seq->voices[v].note) seq->heap[seq->heap_size++] = v;
+    }
+    for (uint8_t i = seq->heap_size / 2; i-- > 0;) heap_sift_down(seq, i);
+}
+
+// ============================================================================
+// Voice stepping
+// ============================================================================
+
+static int note_sounds(const struct note *n) {
+    for (uint8_t i = 0; i < n->chord_size; i++) {
+        if (n->midi_note[i]) return 1;
+    }
+    return 0;
+}
+
+static void emit(const AbcSequencer *seq, uint8_t v, const struct note *n, int on, uint32_t time) {
+    void (*cb)(void *, uint8_t, uint8_t, uint32_t) = on ? seq->config.callbacks.note_on : seq->config.callbacks.note_off;
+    if (!cb) return;
+    for (uint8_t i = 0; i < n->chord_size; i++) {
+        if (n->midi_note[i]) cb(seq->config.user, v, n->midi_note[i], time);
+    }
+}
+
+// Move to the next note at the current tick, wrapping around when looping
+static void voice_next_note(AbcSequencer *seq, uint8_t v) {
+    AbcSeqVoice *voice = &seq->voices[v];
+    const NotePool *pool = &seq->sheet->pools[v];
+    voice->note = note_next(pool, voice->note);
+    if (!voice->note && seq->config.loop && seq->loop_ticks > 0) {
+        voice->start += seq->loop_ticks;
+        voice->tick = voice->start;
+        voice->note = pool_first_note(pool);
+    }
+}
+
+// Handle a voice's next event: a note-off, or the start of its next note
+static void voice_step(AbcSequencer *seq, uint8_t v) {
+    AbcSeqVoice *voice = &seq->voices[v];
+    uint32_t time = event_time(seq, voice->tick);
+
+    if (voice->sounding) {
+        emit(seq, v, voice->note, 0, time);
+        voice->sounding = 0;
+        voice_next_note(seq, v);
+        return;
+    }
+    voice->tick += voice->note->duration;
+    if (note_sounds(voice->note)) {
+        emit(seq, v, voice->note, 1, time);
+        voice->sounding = 1;      // note-off comes up at the end tick
+    } else {
+        voice_next_note(seq, v);  // Rests just move the voice on
+    }
+}
+
+// Note-off for every sounding note, then on to the note after it
+static void silence(AbcSequencer *seq) {
+    for (uint8_t v = 0; v < seq->voice_count; v++) {
+        AbcSeqVoice *voice = &seq->voices[v];
+        if (!voice->sounding) continue;
+        // A note-on fired from the lookahead window may still lie in the future
+        emit(seq, v, voice->note, 0, event_time(seq, voice->tick - voice->note->duration));
+        voice->sounding = 0;
+        voice_next_note(seq, v);
+    }
+    heap_build(seq);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+int abc_sequencer_init(AbcSequencer *seq, const struct sheet *sheet, const AbcSequencerConfig *config) {
+    if (!seq || !sheet || !config || config->clock_rate == 0) return -1;
+    if (sheet->voice_count > ABC_SEQ_MAX_VOICES || (sheet->voice_count > 0 && !sheet->pools)) return -1;
+
+    memset(seq, 0, sizeof(*seq));
+    seq->sheet = sheet;
+    seq->config = *config;
+    seq->voice_count = sheet->voice_count;
+    seq->tempo_scale = ABC_SEQ_SCALE_ONE;
+    for (uint8_t v = 0; v < seq->voice_count; v++) {
+        if (sheet->pools[v].total_ticks > seq->loop_ticks) seq->loop_ticks = sheet->pools[v].total_ticks;
+    }
+    update_rate(seq);
+    abc_sequencer_seek(seq, 0);
+    return 0;
+}
+
+int abc_sequencer_advance(AbcSequencer *seq, uint32_t now) {
+    if (!seq || !seq->sheet) return -1;
+    if (!seq->started) {
+        seq->started = 1;
+        seq->now = now;
+    }
+    uint32_t elapsed = now - seq->now;  // Wraps correctly with the clock
+    seq->now = now;
+    if (seq->paused) return 0;
+
+    seq->pos += (uint64_t)elapsed * seq->ticks_per_unit;
+    uint64_t horizon = seq->pos + (uint64_t)seq->config.lookahead * seq->ticks_per_unit;
+
+    int events = 0;
+    while (seq->heap_size > 0 && (seq->config.max_events == 0 || events < seq->config.max_events)) {
+        uint8_t v = seq->heap[0];
+        if (((uint64_t)seq->voices[v].tick << 32) > horizon) break;
+        voice_step(seq, v);
+        if (!seq->voices[v].note) seq->heap[0] = seq->heap[--seq->heap_size];  // Voice played out
+        heap_sift_down(seq, 0);
+        events++;
+    }
+    return events;
+}
+
+void abc_sequencer_pause(AbcSequencer *seq) {
+    if (!seq || seq->paused) return;
+    silence(seq);
+    seq->paused = 1;
+}
+
+void abc_sequencer_resume(AbcSequencer *seq, uint32_t now) {
+    if (!seq || !seq->paused) return;
+    seq->paused = 0;
+    seq->started = 1;
+    seq->now = now;
+}
+
+void abc_sequencer_seek(AbcSequencer *seq, uint32_t tick) {
+    if (!seq || !seq->sheet) return;
+    silence(seq);
+    if (seq->config.loop && seq->loop_ticks > 0) tick %= seq->loop_ticks;
+
+    for (uint8_t v = 0; v < seq->voice_count; v++) {
+        AbcSeqVoice *voice = &seq->voices[v];
+        const NotePool *pool = &seq->sheet->pools[v];
+        const struct note *n = pool_first_note(pool);
+        uint32_t at = 0;
+        while (n && at < tick) {
+            at += n->duration;
+            n = note_next(pool, n);
+        }
+        voice->note = n;
+        voice->tick = at;
+        voice->start = 0;
+        voice->sounding = 0;
+        if (!n && seq->config.loop && seq->loop_ticks > 0) {
+            voice->note = pool_first_note(pool);
+            voice->tick = voice->start = seq->loop_ticks;
+        }
+    }
+    seq->pos = (uint64_t)tick << 32;
+    heap_build(seq);
+}
+
+void abc_sequencer_set_tempo_scale(AbcSequencer *seq, uint32_t scale) {
+    if (!seq || !seq->sheet) return;
+    if (scale < ABC_SEQ_SCALE_ONE / 64) scale = ABC_SEQ_SCALE_ONE / 64;
+    if (scale > ABC_SEQ_SCALE_ONE * 64) scale = ABC_SEQ_SCALE_ONE * 64;
+    seq->tempo_scale = scale;
+    update_rate(seq);
+}
+
+uint32_t abc_sequencer_position(const AbcSequencer *seq) {
+    if (!seq) return 0;
+    uint32_t tick = (uint32_t)(seq->pos >> 32);
+    return (seq->config.loop && seq->loop_ticks > 0) ? tick % seq->loop_ticks : tick;
+}
+
+int abc_sequencer_finished(const AbcSequencer *seq) {
+    return !seq || seq->heap_size == 0;
+}
@@ -0,0 +1,99 @@
+#ifndef ABC_SEQUENCER_H
+#define ABC_SEQUENCER_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Sequencer - note-on/note-off scheduling from a running clock
+// ============================================================================
+//
+// Drives all voices of a parsed sheet against any monotonic clock: a
+// millisecond timer, a microsecond counter or an audio sample counter. Call
+// abc_sequencer_advance() with the current clock value as often as convenient;
+// it fires note-on/note-off callbacks for every event up to `lookahead` clock
+// units ahead, each stamped with the clock value it should sound at.
+//
+//   - position is kept in fixed-point ticks, so advancing costs one multiply
+//     and each event one multiply; there are no divisions per note
+//   - voices wait in a small heap ordered by their next event, so each event
+//     costs O(log voices) rather than a scan over all voices
+//   - at a given tick, note-offs fire before note-ons, so repeated pitches
+//     retrigger cleanly
+//   - max_events caps the work per call; the remainder fires on the next one
+//   - nothing is allocated; the sheet must stay valid while it plays
+
+#define ABC_SEQ_MAX_VOICES  16       // Voices a sequencer can play
+#define ABC_SEQ_SCALE_ONE   0x10000u // Tempo scale 1.0 (Q16.16)
+
+typedef struct {
+    void (*note_on)(void *user, uint8_t voice, uint8_t midi, uint32_t time);
+    void (*note_off)(void *user, uint8_t voice, uint8_t midi, uint32_t time);
+} AbcSequencerCallbacks;
+
+typedef struct {
+    uint32_t clock_rate;        // Clock units per second (1000 = ms, 48000 = samples)
+    uint32_t lookahead;         // Fire events this many clock units early (0 = when due)
+    uint16_t max_events;        // Events per advance (0 = unlimited)
+    uint8_t loop;               // Restart at the end of the longest voice
+    AbcSequencerCallbacks callbacks;
+    void *user;
+} AbcSequencerConfig;
+
+// Per-voice playback state
+typedef struct {
+    const struct note *note;    // Note whose note-on (or note-off, if sounding) is next
+    uint32_t tick;              // Tick of that event
+    uint32_t start;             // Tick the current pass through the voice started at
+    uint8_t sounding;           // note-on of `note` has fired
+} AbcSeqVoice;
+
+typedef struct {
+    const struct sheet *sheet;
+    AbcSequencerConfig config;
+    AbcSeqVoice voices[ABC_SEQ_MAX_VOICES];
+    uint8_t heap[ABC_SEQ_MAX_VOICES];  // Voices with events left, soonest first
+    uint8_t heap_size;
+    uint8_t voice_count;
+    uint8_t started;            // Clock origin taken
+    uint8_t paused;
+    uint32_t loop_ticks;        // Length of one pass (longest voice)
+    uint32_t now;               // Clock value at the last advance
+    uint64_t pos;               // Playback position in ticks (Q32.32)
+    uint64_t ticks_per_unit;    // Q32.32
+    uint64_t units_per_tick;    // Q16.16
+    uint32_t tempo_scale;       // Q16.16
+} AbcSequencer;
+
+// Prepare to play a parsed sheet from its start
+// Tempo comes from the sheet's Q: field, including its note value.
+// The clock origin is taken from the first advance.
+// Returns 0 on success, -1 on invalid arguments or too many voices
+int abc_sequencer_init(AbcSequencer *seq, const struct sheet *sheet, const AbcSequencerConfig *config);
+
+// Fire every event due before now + lookahead
+// Returns the number of events processed (0 while paused), -1 on invalid arguments
+int abc_sequencer_advance(AbcSequencer *seq, uint32_t now);
+
+// Stop the clock; sounding notes get their note-off
+// Notes already fired from the lookahead window are cut, not replayed.
+void abc_sequencer_pause(AbcSequencer *seq);
+
+// Restart the clock at `now` after a pause
+void abc_sequencer_resume(AbcSequencer *seq, uint32_t now);
+
+// Jump to a tick (wrapped into the tune when looping); sounding notes get
+// their note-off and playback resumes with the first note starting at or after it
+void abc_sequencer_seek(AbcSequencer *seq, uint32_t tick);
+
+// Scale the sheet's tempo (ABC_SEQ_SCALE_ONE = as written, clamped to 1/64..64)
+// The position is kept, so this can be called while playing.
+void abc_sequencer_set_tempo_scale(AbcSequencer *seq, uint32_t scale);
+
+// Current position in ticks from the start of the tune
+uint32_t abc_sequencer_position(const AbcSequencer *seq);
+
+// 1 once every voice has played out (never while looping)
+int abc_sequencer_finished(const AbcSequencer *seq);
+
+#endif // ABC_SEQUENCER_H
@@ -0,0 +1,428 @@
+#include "abc_store.h"
+#include <string.h>
+
+#define NONE 0xFFFFFFFFu
+#define DELETED 0xFFFF
+
+// Heap blocks start with a small header so compaction can walk the heap
+#define BLOCK_FREE   0
+#define BLOCK_SHEET  1
+#define BLOCK_STRING 2
+#define BLOCK_HEADER 8
+
+// Sheet blocks: one record per voice, then the notes of every voice
+typedef struct {
+    uint16_t voice_id;          // Interned string ID
+    uint16_t count;
+    uint32_t total_ticks;
+} StoreVoice;
+
+static uint32_t block_round(uint32_t payload) {
+    return (BLOCK_HEADER + payload + 7u) & ~7u;
+}
+
+static uint32_t block_size(const AbcStore *store, uint32_t offset) {
+    const uint8_t *b = store->heap + offset;
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static void block_write(AbcStore *store, uint32_t offset, uint32_t size, uint16_t kind, uint16_t owner) {
+    uint8_t *b = store->heap + offset;
+    b[0] = (uint8_t)size; b[1] = (uint8_t)(size >> 8); b[2] = (uint8_t)(size >> 16); b[3] = (uint8_t)(size >> 24);
+    b[4] = (uint8_t)kind; b[5] = (uint8_t)(kind >> 8);
+    b[6] = (uint8_t)owner; b[7] = (uint8_t)(owner >> 8);
+}
+
+static uint16_t block_kind(const AbcStore *store, uint32_t offset) {
+    return (uint16_t)(store->heap[offset + 4] | (store->heap[offset + 5] << 8));
+}
+
+static uint16_t block_owner(const AbcStore *store, uint32_t offset) {
+    return (uint16_t)(store->heap[offset + 6] | (store->heap[offset + 7] << 8));
+}
+
+static uint8_t *block_payload(const AbcStore *store, uint32_t offset) {
+    return store->heap + offset + BLOCK_HEADER;
+}
+
+// Bump-allocate a block, compacting first if the holes would make it fit
+static uint32_t heap_alloc(AbcStore *store, uint32_t payload, uint16_t kind, uint16_t owner) {
+    uint32_t size = block_round(payload);
+    if (size > store->heap_size - store->heap_used) {
+        if (store->compact_locks > 0 || size > store->heap_size - store->heap_live) return NONE;
+        abc_store_compact(store);
+    }
+    uint32_t offset = store->heap_used;
+    block_write(store, offset, size, kind, owner);
+    store->heap_used += size;
+    store->heap_live += size;
+    return offset;
+}
+
+static void heap_free(AbcStore *store, uint32_t offset) {
+    uint32_t size = block_size(store, offset);
+    block_write(store, offset, size, BLOCK_FREE, 0);
+    store->heap_live -= size;
+}
+
+// ============================================================================
+// String interning
+// ============================================================================
+
+static uint32_t string_hash(const char *s, uint16_t len) {
+    uint32_t hash = 2166136261u;
+    for (uint16_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)s[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint16_t bounded_len(const char *s, uint16_t max) {
+    uint16_t n = 0;
+    while (n < max && s[n]) n++;
+    return n;
+}
+
+// Returns a string ID with one new reference, 0 for empty strings, DELETED when
+// full (no slot or heap space, or the string already has UINT16_MAX references)
+static uint16_t string_intern(AbcStore *store, const char *s, uint16_t len) {
+    if (len == 0) return 0;
+    uint32_t hash = string_hash(s, len);
+    uint16_t mask = (uint16_t)(store->string_capacity - 1);
+    int32_t free_slot = -1;
+
+    for (uint16_t probe = 0; probe < store->string_capacity; probe++) {
+        uint16_t i = (uint16_t)((hash + probe) & mask);
+        AbcStoreString *str = &store->strings[i];
+        if (str->offset == NONE) {
+            if (str->len == DELETED) {
+                if (free_slot < 0) free_slot = i;
+                continue;
+            }
+            if (free_slot < 0) free_slot = i;
+            break;  // Never-used slot ends the probe sequence
+        }
+        if (str->hash == hash && str->len == len &&
+            memcmp(block_payload(store, str->offset), s, len) == 0) {
+            if (str->refs == UINT16_MAX) return DELETED;    // Full rather than wrap to 0
+            str->refs++;
+            return (uint16_t)(i + 1);
+        }
+    }
+
+    // Keep one slot empty so probe sequences always terminate
+    if (free_slot < 0 || store->string_count + 1u >= store->string_capacity) return DELETED;
+    uint32_t offset = heap_alloc(store, len, BLOCK_STRING, (uint16_t)free_slot);
+    if (offset == NONE) return DELETED;
+    memcpy(block_payload(store, offset), s, len);
+
+    AbcStoreString *str = &store->strings[free_slot];
+    str->offset = offset;
+    str->hash = hash;
+    str->len = len;
+    str->refs = 1;
+    store->string_count++;
+    return (uint16_t)(free_slot + 1);
+}
+
+static void string_release(AbcStore *store, uint16_t id) {
+    if (id == 0 || id == DELETED) return;
+    AbcStoreString *str = &store->strings[id - 1];
+    if (--str->refs > 0) return;
+    heap_free(store, str->offset);
+    str->offset = NONE;
+    str->len = DELETED;
+    store->string_count--;
+}
+
+const char *abc_store_string(const AbcStore *store, uint16_t id, uint16_t *len) {
+    if (!store || id == 0 || id > store->string_capacity || store->strings[id - 1].offset == NONE) {
+        if (len) *len = 0;
+        return NULL;
+    }
+    const AbcStoreString *str = &store->strings[id - 1];
+    if (len) *len = str->len;
+    return (const char *)block_payload(store, str->offset);
+}
+
+uint16_t abc_store_intern(AbcStore *store, const char *s, uint16_t len) {
+    if (!store || (!s && len > 0) || len == DELETED) return DELETED;
+    return string_intern(store, s, len);
+}
+
+void abc_store_release(AbcStore *store, uint16_t id) {
+    if (!store || id > store->string_capacity || (id > 0 && store->strings[id - 1].offset == NONE)) return;
+    string_release(store, id);
+}
+
+static void string_copy(const AbcStore *store, uint16_t id, char *dest, uint16_t dest_size) {
+    uint16_t len;
+    const char *src = abc_store_string(store, id, &len);
+    if (len >= dest_size) len = (uint16_t)(dest_size - 1);
+    if (src) memcpy(dest, src, len);
+    dest[len] = '\0';
+}
+
+// ============================================================================
+// Store
+// ============================================================================
+
+int abc_store_init(AbcStore *store, void *heap, uint32_t heap_size,
+                   AbcStoreEntry *entries, uint16_t entry_capacity,
+                   AbcStoreString *strings, uint16_t string_capacity) {
+    if (!store || !heap || !entries || !strings || entry_capacity == 0 || entry_capacity == 0xFFFF) return -1;
+    if (string_capacity < 2 || (string_capacity & (string_capacity - 1)) != 0) return -1;
+
+    // Blocks are 8-byte aligned relative to an aligned heap base
+    uintptr_t addr = (uintptr_t)heap;
+    uint32_t skip = (uint32_t)((8 - (addr & 7)) & 7);
+    if (heap_size < skip) return -1;
+    store->heap = (uint8_t *)heap + skip;
+    store->heap_size = (heap_size - skip) & ~7u;
+    store->heap_used = 0;
+    store->heap_live = 0;
+    store->compact_locks = 0;
+
+    store->entries = entries;
+    store->entry_capacity = entry_capacity;
+    store->entry_count = 0;
+    for (uint16_t i = 0; i < entry_capacity; i++) {
+        entries[i].block = NONE;
+        entries[i].generation = 0;
+    }
+
+    store->strings = strings;
+    store->string_capacity = string_capacity;
+    store->string_count = 0;
+    for (uint16_t i = 0; i < string_capacity; i++) {
+        strings[i].offset = NONE;
+        strings[i].len = 0;
+        strings[i].refs = 0;
+    }
+    return 0;
+}
+
+static int32_t handle_slot(const AbcStore *store, AbcStoreHandle handle) {
+    uint32_t slot = (handle & 0xFFFF);
+    if (!store || slot == 0 || slot > store->entry_capacity) return -1;
+    const AbcStoreEntry *e = &store->entries[slot - 1];
+    if (e->block == NONE || e->generation != (uint16_t)(handle >> 16)) return -1;
+    return (int32_t)(slot - 1);
+}
+
+const AbcStoreEntry *abc_store_entry(const AbcStore *store, AbcStoreHandle handle) {
+    int32_t slot = handle_slot(store, handle);
+    return slot < 0 ? NULL : &store->entries[slot];
+}
+
+uint32_t abc_store_sheet_bytes(const AbcStore *store, AbcStoreHandle handle) {
+    int32_t slot = handle_slot(store, handle);
+    return slot < 0 ? 0 : block_size(store, store->entries[slot].block);
+}
+
+// Count notes reachable from head (bounded by count so corrupt links terminate)
+static uint16_t pool_list_length(const NotePool *pool) {
+    uint16_t n = 0;
+    struct note *cur = pool_first_note(pool);
+    while (cur && n < pool->count) {
+        n++;
+        cur = note_next(pool, cur);
+    }
+    return n;
+}
+
+static StoreVoice *block_voices(const AbcStore *store, const AbcStoreEntry *e) {
+    return (StoreVoice *)(void *)block_payload(store, e->block);
+}
+
+static void entry_release_strings(AbcStore *store, AbcStoreEntry *e, uint8_t voice_count) {
+    string_release(store, e->title);
+    string_release(store, e->composer);
+    string_release(store, e->key);
+    // Re-read the block after each release: releasing never moves blocks
+    for (uint8_t v = 0; v < voice_count; v++) string_release(store, block_voices(store, e)[v].voice_id);
+}
+
+AbcStoreHandle abc_store_add(AbcStore *store, const struct sheet *sheet) {
+    if (!store || !sheet || (sheet->voice_count > 0 && !sheet->pools)) return ABC_STORE_INVALID;
+
+    uint16_t slot = 0;
+    while (slot < store->entry_capacity && store->entries[slot].block != NONE) slot++;
+    if (slot == store->entry_capacity) return ABC_STORE_INVALID;
+    AbcStoreEntry *e = &store->entries[slot];
+
+    uint32_t note_total = 0;
+    for (uint8_t v = 0; v < sheet->voice_count; v++) note_total += pool_list_length(&sheet->pools[v]);
+
+    // The block is owned by the slot from here on, so compaction keeps e->block current
+    uint32_t payload = (uint32_t)sheet->voice_count * sizeof(StoreVoice) + note_total * sizeof(struct note);
+    e->block = heap_alloc(store, payload, BLOCK_SHEET, slot);
+    if (e->block == NONE) return ABC_STORE_INVALID;
+
+    // Interning may compact the heap; always go back through e->block
+    e->title = string_intern(store, sheet->title, bounded_len(sheet->title, ABC_MAX_TITLE_LEN));
+    e->composer = string_intern(store, sheet->composer, bounded_len(sheet->composer, ABC_MAX_COMPOSER_LEN));
+    e->key = string_intern(store, sheet->key, bounded_len(sheet->key, ABC_MAX_KEY_LEN));
+    int failed = (e->title == DELETED || e->composer == DELETED || e->key == DELETED);
+    uint8_t interned = 0;
+    for (; !failed && interned < sheet->voice_count; interned++) {
+        const NotePool *pool = &sheet->pools[interned];
+        uint16_t id = string_intern(store, pool->voice_id, bounded_len(pool->voice_id, ABC_MAX_VOICE_ID_LEN));
+        StoreVoice *voice = &block_voices(store, e)[interned];
+        voice->voice_id = id;
+        voice->count = pool_list_length(pool);
+        voice->total_ticks = pool->total_ticks;
+        if (id == DELETED) failed = 1;
+    }
+    if (failed) {
+        entry_release_strings(store, e, interned);
+        heap_free(store, e->block);
+        e->block = NONE;
+        return ABC_STORE_INVALID;
+    }
+
+    // Copy notes voice by voice, relinked 0..n-1 so views can point straight at them
+    const StoreVoice *voices = block_voices(store, e);
+    struct note *out = (struct note *)(void *)(block_payload(store, e->block) +
+                                               (size_t)sheet->voice_count * sizeof(StoreVoice));
+    for (uint8_t v = 0; v < sheet->voice_count; v++) {
+        const NotePool *pool = &sheet->pools[v];
+        struct note *n = pool_first_note(pool);
+        for (uint16_t i = 0; i < voices[v].count; i++, out++) {
+            *out = *n;
+            out->next_index = (int16_t)(i + 1 < voices[v].count ? i + 1 : -1);
+            n = note_next(pool, n);
+        }
+    }
+
+    e->tempo_bpm = sheet->tempo_bpm;
+    e->default_note_num = sheet->default_note_num;
+    e->default_note_den = sheet->default_note_den;
+    e->meter_num = sheet->meter_num;
+    e->meter_den = sheet->meter_den;
+    e->tempo_note_num = sheet->tempo_note_num;
+    e->tempo_note_den = sheet->tempo_note_den;
+    e->voice_count = sheet->voice_count;
+    store->entry_count++;
+    return ((AbcStoreHandle)e->generation << 16) | (uint32_t)(slot + 1);
+}
+
+int abc_store_remove(AbcStore *store, AbcStoreHandle handle) {
+    int32_t slot = handle_slot(store, handle);
+    if (slot < 0) return -1;
+    AbcStoreEntry *e = &store->entries[slot];
+
+    entry_release_strings(store, e, e->voice_count);
+    heap_free(store, e->block);
+    e->block = NONE;
+    e->generation++;
+    store->entry_count--;
+    return 0;
+}
+
+void abc_store_compact(AbcStore *store) {
+    if (!store) return;
+    uint32_t read = 0, write = 0;
+    while (read < store->heap_used) {
+        uint32_t size = block_size(store, read);
+        uint16_t kind = block_kind(store, read);
+        if (kind != BLOCK_FREE) {
+            uint16_t owner = block_owner(store, read);
+            if (write != read) memmove(store->heap + write, store->heap + read, size);
+            if (kind == BLOCK_SHEET) store->entries[owner].block = write;
+            else store->strings[owner].offset = write;
+            write += size;
+        }
+        read += size;
+    }
+    store->heap_used = write;
+    store->heap_live = write;
+}
+
+int abc_store_view(const AbcStore *store, AbcStoreHandle handle,
+                   struct sheet *sheet, NotePool *pools, uint8_t pool_count) {
+    int32_t slot = handle_slot(store, handle);
+    if (slot < 0 || !sheet) return -1;
+    const AbcStoreEntry *e = &store->entries[slot];
+    if (e->voice_count > pool_count || (e->voice_count > 0 && !pools)) return -2;
+
+    sheet_init(sheet, pools, pool_count);
+    sheet->voice_count = e->voice_count;
+    sheet->tempo_bpm = e->tempo_bpm;
+    sheet->default_note_num = e->default_note_num;
+    sheet->default_note_den = e->default_note_den;
+    sheet->meter_num = e->meter_num;
+    sheet->meter_den = e->meter_den;
+    sheet->tempo_note_num = e->tempo_note_num;
+    sheet->tempo_note_den = e->tempo_note_den;
+    string_copy(store, e->title, sheet->title, ABC_MAX_TITLE_LEN);
+    string_copy(store, e->composer, sheet->composer, ABC_MAX_COMPOSER_LEN);
+    string_copy(store, e->key, sheet->key, ABC_MAX_KEY_LEN);
+
+    const uint8_t *p = block_payload(store, e->block);
+    const StoreVoice *voices = (const StoreVoice *)(const void *)p;
+    struct note *notes = (struct note *)(uintptr_t)(p + (size_t)e->voice_count * sizeof(StoreVoice));
+    for (uint8_t v = 0; v < e->voice_count; v++) {
+        NotePool *pool = &pools[v];
+        note_pool_init(pool, notes, 0, ABC_MAX_CHORD_NOTES);
+        pool->count = voices[v].count;
+        pool->head_index = voices[v].count > 0 ? 0 : -1;
+        pool->tail_index = (int16_t)voices[v].count - 1;
+        pool->total_ticks = voices[v].total_ticks;
+        string_copy(store, voices[v].voice_id, pool->voice_id, ABC_MAX_VOICE_ID_LEN);
+        notes += voices[v].count;
+    }
+    return 0;
+}
+
+int abc_store_copy(const AbcStore *store, AbcStoreHandle handle, struct sheet *sheet) {
+    int32_t slot = handle_slot(store, handle);
+    if (slot < 0 || !sheet) return -1;
+    const AbcStoreEntry *e = &store->entries[slot];
+    if (e->voice_count > sheet->pool_count || (e->voice_count > 0 && !sheet->pools)) return -2;
+
+    // Reserve first so a failure leaves the sheet untouched
+    const uint8_t *p = block_payload(store, e->block);
+    const StoreVoice *voices = (const StoreVoice *)(const void *)p;
+    for (uint8_t v = 0; v < e->voice_count; v++) {
+        if (note_pool_reserve(&sheet->pools[v], voices[v].count) < 0) return -2;
+    }
+
+    sheet_reset(sheet);
+    sheet->voice_count = e->voice_count;
+    sheet->tempo_bpm = e->tempo_bpm;
+    sheet->default_note_num = e->default_note_num;
+    sheet->default_note_den = e->default_note_den;
+    sheet->meter_num = e->meter_num;
+    sheet->meter_den = e->meter_den;
+    sheet->tempo_note_num = e->tempo_note_num;
+    sheet->tempo_note_den = e->tempo_note_den;
+    string_copy(store, e->title, sheet->title, ABC_MAX_TITLE_LEN);
+    string_copy(store, e->composer, sheet->composer, ABC_MAX_COMPOSER_LEN);
+    string_copy(store, e->key, sheet->key, ABC_MAX_KEY_LEN);
+
+    // Runs are already linked 0..n-1, so one memcpy per voice restores the list
+    const struct note *notes = (const struct note *)(const void *)(p + (size_t)e->voice_count * sizeof(StoreVoice));
+    for (uint8_t v = 0; v < e->voice_count; v++) {
+        NotePool *pool = &sheet->pools[v];
+        uint16_t count = voices[v].count;
+        if (count > 0) memcpy(pool->notes, notes, (size_t)count * sizeof(struct note));
+        pool->count = count;
+        pool->head_index = count > 0 ? 0 : -1;
+        pool->tail_index = (int16_t)count - 1;
+        pool->total_ticks = voices[v].total_ticks;
+        string_copy(store, voices[v].voice_id, pool->voice_id, ABC_MAX_VOICE_ID_LEN);
+        notes += count;
+    }
+    return 0;
+}
+
+AbcStoreHandle abc_store_next(const AbcStore *store, AbcStoreHandle prev) {
+    if (!store) return ABC_STORE_INVALID;
+    for (uint32_t slot = (prev & 0xFFFF); slot < store->entry_capacity; slot++) {
+        const AbcStoreEntry *e = &store->entries[slot];
+        if (e->block != NONE) return ((AbcStoreHandle)e->generation << 16) | (slot + 1);
+    }
+    return ABC_STORE_INVALID;
+}
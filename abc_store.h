@@ -0,0 +1,115 @@
+#ifndef ABC_STORE_H
+#define ABC_STORE_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Sheet store - many resident sheets packed into one heap
+// ============================================================================
+//
+// The store copies parsed sheets into a single caller-provided heap:
+//   - notes of all voices of a sheet go into one exactly-sized block
+//   - title, composer, key and voice IDs are interned and reference counted,
+//     so thousands of tunes sharing "Trad." or voice "1" store them once
+//   - sheets are addressed by small handles; removed sheets leave holes that
+//     abc_store_compact() squeezes out (adds compact automatically when needed)
+//
+// All memory is caller-provided: the heap, the entry table and the string
+// table. Views returned by abc_store_view() point into the heap and stay valid
+// until the sheet is removed or the heap is compacted (raise compact_locks to
+// keep adds from compacting while views are in use).
+
+typedef uint32_t AbcStoreHandle;  // Generation << 16 | (slot + 1); 0 = invalid
+
+#define ABC_STORE_INVALID 0
+#define ABC_STORE_NO_STRING 0xFFFF  // abc_store_intern() failed
+
+// Per-sheet metadata (kept separate from notes so catalog scans stay compact)
+typedef struct {
+    uint32_t block;             // Heap offset of the sheet's note block (UINT32_MAX = free)
+    uint16_t generation;        // Incremented when the slot is freed
+    uint16_t title;             // Interned string IDs (0 = empty)
+    uint16_t composer;
+    uint16_t key;
+    uint16_t tempo_bpm;
+    uint8_t default_note_num;
+    uint8_t default_note_den;
+    uint8_t meter_num;
+    uint8_t meter_den;
+    uint8_t tempo_note_num;
+    uint8_t tempo_note_den;
+    uint8_t voice_count;
+} AbcStoreEntry;
+
+// Interned string slot (open addressing by hash)
+typedef struct {
+    uint32_t offset;            // Heap offset of the string block (UINT32_MAX = none)
+    uint32_t hash;
+    uint16_t len;               // 0xFFFF marks a deleted slot
+    uint16_t refs;              // Interns holding it (at most UINT16_MAX; further adds fail)
+} AbcStoreString;
+
+typedef struct {
+    uint8_t *heap;
+    uint32_t heap_size;
+    uint32_t heap_used;         // High-water mark of the bump pointer
+    uint32_t heap_live;         // Bytes in live blocks (heap_used - heap_live = holes)
+    AbcStoreEntry *entries;
+    uint16_t entry_capacity;
+    uint16_t entry_count;       // Live sheets
+    AbcStoreString *strings;
+    uint16_t string_capacity;   // Power of two
+    uint16_t string_count;      // Live strings
+    uint16_t compact_locks;     // While > 0, adds never compact implicitly (views in use)
+} AbcStore;
+
+// Initialize a store over caller-provided memory
+// string_capacity must be a power of two
+// Returns 0 on success, -1 on invalid arguments
+int abc_store_init(AbcStore *store, void *heap, uint32_t heap_size,
+                   AbcStoreEntry *entries, uint16_t entry_capacity,
+                   AbcStoreString *strings, uint16_t string_capacity);
+
+// Copy a parsed sheet into the store
+// Returns a handle, or ABC_STORE_INVALID if the store is full
+AbcStoreHandle abc_store_add(AbcStore *store, const struct sheet *sheet);
+
+// Remove a sheet; its heap block becomes a hole until compaction
+// Returns 0 on success, -1 on an invalid or stale handle
+int abc_store_remove(AbcStore *store, AbcStoreHandle handle);
+
+// Slide live blocks down over holes (invalidates views)
+void abc_store_compact(AbcStore *store);
+
+// Read-only view of a stored sheet: pools point into the heap (capacity 0)
+// Returns 0 on success, -1 on an invalid handle, -2 if pool_count is too small
+int abc_store_view(const AbcStore *store, AbcStoreHandle handle,
+                   struct sheet *sheet, NotePool *pools, uint8_t pool_count);
+
+// Copy a stored sheet into caller pools (writable; grows pools with an allocator)
+// Returns 0 on success, -1 on an invalid handle, -2 if pools are too few or too small
+int abc_store_copy(const AbcStore *store, AbcStoreHandle handle, struct sheet *sheet);
+
+// Metadata for a handle (NULL if invalid or stale)
+const AbcStoreEntry *abc_store_entry(const AbcStore *store, AbcStoreHandle handle);
+
+// Heap bytes of a sheet's note block, header included (0 if invalid)
+// Interned strings are shared between sheets and not included.
+uint32_t abc_store_sheet_bytes(const AbcStore *store, AbcStoreHandle handle);
+
+// Bytes of an interned string (not NUL-terminated); NULL for id 0
+const char *abc_store_string(const AbcStore *store, uint16_t id, uint16_t *len);
+
+// Intern a string outside any sheet (e.g. a cache key's input text); len < 0xFFFF
+// Returns an ID for abc_store_string() holding one new reference, 0 for an
+// empty string, or ABC_STORE_NO_STRING if the store is full
+uint16_t abc_store_intern(AbcStore *store, const char *s, uint16_t len);
+
+// Drop a reference taken by abc_store_intern()
+void abc_store_release(AbcStore *store, uint16_t id);
+
+// Iterate live sheets: pass ABC_STORE_INVALID to get the first
+AbcStoreHandle abc_store_next(const AbcStore *store, AbcStoreHandle prev);
+
+#endif // ABC_STORE_H
@@ -0,0 +1,179 @@
+#include "abc_trace.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *const phase_names[ABC_TRACE_PHASES] = {
+    "header", "body", "note", "repeat", "append"
+};
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+void abc_trace_init(AbcTrace *trace, AbcTraceClock clock, void *user,
+                    AbcTraceSpan *spans, uint32_t span_capacity) {
+    if (!trace) return;
+    memset(trace, 0, sizeof(*trace));
+    trace->clock = clock;
+    trace->user = user;
+    trace->spans = spans;
+    trace->span_capacity = spans ? span_capacity : 0;
+    abc_trace_reset(trace);
+}
+
+void abc_trace_reset(AbcTrace *trace) {
+    if (!trace) return;
+    trace->span_count = 0;
+    trace->spans_dropped = 0;
+    memset(trace->total, 0, sizeof(trace->total));
+    memset(trace->calls, 0, sizeof(trace->calls));
+    trace->path_count = 0;
+    trace->depth = 0;
+    trace->origin = trace->clock ? trace->clock(trace->user) : 0;
+}
+
+void abc_trace_enter(AbcTrace *trace, AbcTracePhase phase) {
+    if (!trace || !trace->clock || (unsigned)phase >= ABC_TRACE_PHASES) return;
+    if (trace->depth >= ABC_TRACE_MAX_DEPTH) {
+        trace->depth++;         // Too deep: counted so exits stay balanced, not timed
+        return;
+    }
+
+    uint8_t d = trace->depth++;
+    uint16_t parent = d > 0 ? trace->open[d - 1].path : 0;
+    trace->open[d].path = (uint16_t)(parent * 8 + phase + 1);
+    trace->open[d].children = 0;
+    trace->open[d].span = trace->span_capacity;
+    if (trace->span_count < trace->span_capacity) {
+        trace->open[d].span = trace->span_count;
+        AbcTraceSpan *span = &trace->spans[trace->span_count++];
+        span->phase = (uint8_t)phase;
+        span->depth = d;
+        span->duration = 0;
+    } else if (trace->spans) {
+        trace->spans_dropped++;
+    }
+
+    // Read the clock last so the bookkeeping above is not charged to the phase
+    trace->open[d].start = trace->clock(trace->user);
+    if (trace->open[d].span < trace->span_capacity) {
+        trace->spans[trace->open[d].span].start = trace->open[d].start - trace->origin;
+    }
+}
+
+static void add_path(AbcTrace *trace, uint16_t path, uint32_t self) {
+    for (uint8_t i = 0; i < trace->path_count; i++) {
+        if (trace->paths[i].path == path) {
+            trace->paths[i].calls++;
+            trace->paths[i].self += self;
+            return;
+        }
+    }
+    if (trace->path_count < ABC_TRACE_MAX_PATHS) {
+        AbcTracePath *p = &trace->paths[trace->path_count++];
+        p->path = path;
+        p->calls = 1;
+        p->self = self;
+    }
+}
+
+void abc_trace_exit(AbcTrace *trace) {
+    if (!trace || !trace->clock || trace->depth == 0) return;
+    uint32_t now = trace->clock(trace->user);
+    if (trace->depth-- > ABC_TRACE_MAX_DEPTH) return;
+
+    uint8_t d = trace->depth;
+    uint32_t elapsed = now - trace->open[d].start;
+    uint8_t phase = (uint8_t)(trace->open[d].path % 8 - 1);
+
+    trace->total[phase] += elapsed;
+    trace->calls[phase]++;
+    uint32_t children = trace->open[d].children;
+    add_path(trace, trace->open[d].path, elapsed > children ? elapsed - children : 0);
+    if (d > 0) trace->open[d - 1].children += elapsed;
+    if (trace->open[d].span < trace->span_capacity) trace->spans[trace->open[d].span].duration = elapsed;
+}
+
+const char *abc_trace_phase_name(AbcTracePhase phase) {
+    return (unsigned)phase < ABC_TRACE_PHASES ? phase_names[phase] : "?";
+}
+
+// ============================================================================
+// Export
+// ============================================================================
+
+typedef struct {
+    char *buf;
+    uint32_t size;
+    uint32_t len;
+    int overflow;
+} Writer;
+
+static void put(Writer *w, const char *fmt, ...) {
+    if (w->overflow) return;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(w->buf + w->len, w->size - w->len, fmt, args);
+    va_end(args);
+    if (n < 0 || (uint32_t)n >= w->size - w->len) {
+        w->overflow = 1;
+        return;
+    }
+    w->len += (uint32_t)n;
+}
+
+// Clock units as microseconds with three decimals (Chrome's time base)
+static void put_time(Writer *w, const AbcTrace *trace, uint32_t units) {
+    if (trace->clock_hz == 0) {
+        put(w, "%lu", (unsigned long)units);
+        return;
+    }
+    uint64_t ns = (uint64_t)units * 1000000000u / trace->clock_hz;
+    put(w, "%lu.%03lu", (unsigned long)(ns / 1000), (unsigned long)(ns % 1000));
+}
+
+static int32_t finish(Writer *w) {
+    if (w->overflow) {
+        w->buf[0] = '\0';
+        return -2;
+    }
+    return (int32_t)w->len;
+}
+
+int32_t abc_trace_export_chrome(const AbcTrace *trace, char *buf, uint32_t size) {
+    if (!trace || !buf || size == 0) return -1;
+    Writer w = { buf, size, 0, 0 };
+    buf[0] = '\0';
+
+    put(&w, "{\"traceEvents\":[");
+    for (uint32_t i = 0; i < trace->span_count; i++) {
+        const AbcTraceSpan *span = &trace->spans[i];
+        put(&w, "%s\n{\"name\":\"%s\",\"cat\":\"abc\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":",
+            i ? "," : "", abc_trace_phase_name((AbcTracePhase)span->phase));
+        put_time(&w, trace, span->start);
+        put(&w, ",\"dur\":");
+        put_time(&w, trace, span->duration);
+        put(&w, "}");
+    }
+    put(&w, "\n],\"otherData\":{\"spans_dropped\":%lu}}\n", (unsigned long)trace->spans_dropped);
+    return finish(&w);
+}
+
+int32_t abc_trace_export_folded(const AbcTrace *trace, char *buf, uint32_t size) {
+    if (!trace || !buf || size == 0) return -1;
+    Writer w = { buf, size, 0, 0 };
+    buf[0] = '\0';
+
+    for (uint8_t i = 0; i < trace->path_count; i++) {
+        // Digits are outermost first from the top
+        uint16_t path = trace->paths[i].path;
+        uint16_t scale = 1;
+        while (path / scale >= 8) scale *= 8;
+        for (const char *sep = ""; scale > 0; scale /= 8, sep = ";") {
+            put(&w, "%s%s", sep, abc_trace_phase_name((AbcTracePhase)(path / scale % 8 - 1)));
+        }
+        put(&w, " %llu\n", (unsigned long long)trace->paths[i].self);
+    }
+    return finish(&w);
+}
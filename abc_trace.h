@@ -0,0 +1,105 @@
+#ifndef ABC_TRACE_H
+#define ABC_TRACE_H
+
+#include <stdint.h>
+
+// ============================================================================
+// Trace - per-phase cycle accounting for the parser
+// ============================================================================
+//
+// For targets without a profiler. Build with ABC_TRACE 1 and attach a trace to
+// a sheet with sheet_set_trace(); the parser then reads the caller's clock on
+// entry to and exit from each phase:
+//
+//   header   parse_header (all header fields)
+//   body     tune body lexing (everything not in a nested phase)
+//   note     parse_note_or_chord
+//   repeat   unfolding a repeat section (copy_repeat_section)
+//   append   storing a note in a pool (parsed or copied)
+//
+// Time is accumulated online per call path (e.g. body;note;append), so the
+// folded-stack export needs no span buffer. Optional span storage adds a
+// Chrome trace (chrome://tracing, Perfetto) export. With ABC_TRACE 0 (the
+// default) the parser contains no hooks at all.
+
+#define ABC_TRACE_MAX_DEPTH 4
+#define ABC_TRACE_MAX_PATHS 8
+
+typedef enum {
+    ABC_TRACE_HEADER = 0,
+    ABC_TRACE_BODY,
+    ABC_TRACE_NOTE,
+    ABC_TRACE_REPEAT,
+    ABC_TRACE_APPEND,
+    ABC_TRACE_PHASES
+} AbcTracePhase;
+
+// Free-running counter, e.g. DWT->CYCCNT, rdtsc or clock_gettime in ns.
+// Wraps are fine as long as one parse takes fewer than 2^32 units.
+typedef uint32_t (*AbcTraceClock)(void *user);
+
+// One phase call, in clock units since the trace was reset
+typedef struct {
+    uint32_t start;
+    uint32_t duration;
+    uint8_t phase;
+    uint8_t depth;              // 0 = outermost
+} AbcTraceSpan;
+
+// Self time of one call path; path holds phase+1 in 3-bit digits, innermost lowest
+typedef struct {
+    uint16_t path;
+    uint32_t calls;
+    uint64_t self;
+} AbcTracePath;
+
+typedef struct AbcTrace {
+    AbcTraceClock clock;
+    void *user;
+    uint32_t clock_hz;          // Clock rate for the Chrome export (0 = report raw units)
+
+    AbcTraceSpan *spans;        // Optional (NULL = totals only)
+    uint32_t span_capacity;
+    uint32_t span_count;
+    uint32_t spans_dropped;     // Calls that did not fit in spans
+
+    uint64_t total[ABC_TRACE_PHASES];   // Inclusive time per phase
+    uint32_t calls[ABC_TRACE_PHASES];
+    AbcTracePath paths[ABC_TRACE_MAX_PATHS];
+    uint8_t path_count;
+
+    // Phases currently open
+    uint32_t origin;
+    uint8_t depth;
+    struct {
+        uint32_t start;
+        uint32_t children;      // Time spent in nested phases
+        uint32_t span;          // Span index (span_capacity = not recorded)
+        uint16_t path;
+    } open[ABC_TRACE_MAX_DEPTH];
+} AbcTrace;
+
+// spans may be NULL. Also resets the trace.
+void abc_trace_init(AbcTrace *trace, AbcTraceClock clock, void *user,
+                    AbcTraceSpan *spans, uint32_t span_capacity);
+
+// Clear all counters and spans; time restarts at 0
+void abc_trace_reset(AbcTrace *trace);
+
+// Phase boundaries (called by the parser; usable around caller code too)
+void abc_trace_enter(AbcTrace *trace, AbcTracePhase phase);
+void abc_trace_exit(AbcTrace *trace);
+
+// Name of a phase ("header", "body", ...)
+const char *abc_trace_phase_name(AbcTracePhase phase);
+
+// Write a Chrome trace JSON document of the recorded spans (NUL-terminated)
+// Returns its length, -1 on invalid arguments, -2 if it does not fit in size
+int32_t abc_trace_export_chrome(const AbcTrace *trace, char *buf, uint32_t size);
+
+// Write folded stacks ("body;note;append 1234" per line, self time in clock
+// units) for flamegraph.pl, speedscope and similar tools
+// Returns its length, -1 on invalid arguments, -2 if it does not fit in size
+int32_t abc_trace_export_folded(const AbcTrace *trace, char *buf, uint32_t size);
+
+#endif // ABC_TRACE_H
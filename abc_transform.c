@@ -0,0 +1,161 @@
+#include "abc_transform.h"
+#include <string.h>
+
+// ============================================================================
+// Arpeggio
+// ============================================================================
+
+// Sounding pitches of a note, ascending; returns how many
+static uint8_t chord_pitches(const struct note *n, uint8_t *pitches) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < n->chord_size && i < ABC_MAX_CHORD_NOTES; i++) {
+        uint8_t midi = n->midi_note[i];
+        if (midi == 0) continue;
+        uint8_t j = count++;
+        for (; j > 0 && pitches[j - 1] > midi; j--) pitches[j] = pitches[j - 1];
+        pitches[j] = midi;
+    }
+    return count;
+}
+
+// Index into the ascending pitches for arpeggio step `step`
+static uint8_t pattern_index(AbcArpPattern pattern, uint8_t count, uint16_t step) {
+    switch (pattern) {
+        case ABC_ARP_DOWN:
+            return (uint8_t)(count - 1 - step % count);
+        case ABC_ARP_UP_DOWN: {
+            uint16_t period = (uint16_t)(2 * count - 2);
+            uint16_t i = (uint16_t)(step % period);
+            return (uint8_t)(i < count ? i : period - i);
+        }
+        default:
+            return (uint8_t)(step % count);
+    }
+}
+
+// Run the expansion, feeding each output note to the callback
+static int32_t arpeggiate(const NotePool *src, const AbcArpConfig *config,
+                          AbcArpCallback callback, void *user) {
+    int32_t produced = 0;
+    for (const struct note *n = pool_first_note(src); n; n = note_next(src, n)) {
+        uint8_t pitches[ABC_MAX_CHORD_NOTES];
+        uint8_t count = chord_pitches(n, pitches);
+
+        if (count < 2 || n->duration <= config->step_ticks) {
+            // Single notes and rests pass through; a chord too short to split keeps its lowest pitch
+            produced++;
+            if (callback && callback(user, count ? pitches[0] : 0, n->duration)) return -3;
+            continue;
+        }
+
+        uint8_t remaining = n->duration;
+        for (uint16_t step = 0; remaining > 0; step++) {
+            // The last step absorbs the remainder so the chord keeps its exact length
+            uint8_t ticks = remaining < 2 * config->step_ticks ? remaining : config->step_ticks;
+            produced++;
+            if (callback && callback(user, pitches[pattern_index(config->pattern, count, step)], ticks)) return -3;
+            remaining = (uint8_t)(remaining - ticks);
+        }
+    }
+    return produced;
+}
+
+static int append_to_pool(void *user, uint8_t midi, uint8_t duration) {
+    NotePool *pool = (NotePool *)user;
+    if (note_pool_reserve(pool, (uint16_t)(pool->count + 1)) < 0) return 1;
+
+    int16_t index = (int16_t)pool->count++;
+    struct note *n = &pool->notes[index];
+    memset(n, 0, sizeof(*n));
+    n->next_index = -1;
+    n->duration = duration;
+    n->chord_size = 1;
+    n->midi_note[0] = midi;
+
+    if (pool->head_index < 0) pool->head_index = index;
+    else pool->notes[pool->tail_index].next_index = index;
+    pool->tail_index = index;
+    pool->total_ticks += duration;
+    return 0;
+}
+
+int abc_arpeggiate(const NotePool *src, NotePool *dst, const AbcArpConfig *config) {
+    if (!src || !dst || src == dst || !config || config->step_ticks == 0) return -1;
+
+    char voice_id[ABC_MAX_VOICE_ID_LEN];
+    memcpy(voice_id, src->voice_id, sizeof(voice_id));
+    note_pool_reset(dst);
+    memcpy(dst->voice_id, voice_id, sizeof(voice_id));
+
+    return arpeggiate(src, config, append_to_pool, dst) < 0 ? -2 : 0;
+}
+
+int32_t abc_arpeggiate_events(const NotePool *src, const AbcArpConfig *config,
+                              AbcArpCallback callback, void *user) {
+    if (!src || !config || config->step_ticks == 0) return -1;
+    return arpeggiate(src, config, callback, user);
+}
+
+// ============================================================================
+// Bulk transforms
+// ============================================================================
+
+int32_t abc_pool_transpose(NotePool *pool, int8_t semitones, uint8_t low, uint8_t high, AbcRangeMode mode) {
+    if (!pool || pool->capacity == 0 || low == 0 || low > high || high > 127) return -1;
+
+    // The result depends only on the pitch, so work out all 128 once; the pass
+    // over the notes is then one table load per pitch, with no branches
+    uint8_t map[128], moved[128];
+    map[0] = 0;    // Rests stay rests
+    moved[0] = 0;
+    for (int midi = 1; midi < 128; midi++) {
+        int t = midi + semitones;
+        int m = t;
+        if (mode == ABC_RANGE_FOLD) {
+            while (m > high) m -= 12;
+            while (m < low) m += 12;
+        }
+        m = m < low ? low : (m > high ? high : m);
+        map[midi] = (uint8_t)m;
+        moved[midi] = (uint8_t)(m != t);
+    }
+
+    // Follow the list: an edited pool's array also holds spliced-out notes
+    int32_t adjusted = 0;
+    struct note *notes = pool->notes;
+    for (int16_t i = pool->head_index; i >= 0 && i < pool->count; i = notes[i].next_index) {
+        for (uint8_t j = 0; j < notes[i].chord_size && j < ABC_MAX_CHORD_NOTES; j++) {
+            uint8_t midi = notes[i].midi_note[j] & 0x7F;
+            adjusted += moved[midi];
+            notes[i].midi_note[j] = map[midi];
+        }
+    }
+    return adjusted;
+}
+
+int abc_pool_scale_durations(NotePool *pool, uint16_t num, uint16_t den) {
+    if (!pool || pool->capacity == 0 || num == 0 || den == 0) return -1;
+
+    // Each note ends where its unscaled end lands, rounded, so errors never
+    // accumulate. Both passes follow the list in play order: an edited pool's
+    // array also holds spliced-out notes, and live notes out of index order.
+    struct note *notes = pool->notes;
+    uint64_t end = 0, scaled_end = 0;
+    for (int16_t i = pool->head_index; i >= 0 && i < pool->count; i = notes[i].next_index) {
+        end += notes[i].duration;
+        uint64_t next_end = (end * num + den / 2) / den;
+        if (next_end - scaled_end > 255) return -2;
+        scaled_end = next_end;
+    }
+
+    end = 0;
+    scaled_end = 0;
+    for (int16_t i = pool->head_index; i >= 0 && i < pool->count; i = notes[i].next_index) {
+        end += notes[i].duration;
+        uint64_t next_end = (end * num + den / 2) / den;
+        notes[i].duration = (uint8_t)(next_end - scaled_end);
+        scaled_end = next_end;
+    }
+    pool->total_ticks = (uint32_t)scaled_end;
+    return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef ABC_TRANSFORM_H
+#define ABC_TRANSFORM_H
+
+#include <stdint.h>
+#include "abc_parser.h"
+
+// ============================================================================
+// Pool transforms - reshape parsed notes offline
+// ============================================================================
+//
+// Transforms run once on a parsed NotePool so playback code stays trivial.
+// They keep tick totals exact: a transformed pool lasts exactly as many
+// ticks as its source, so voices stay aligned.
+
+// Arpeggio: chords become a fast run over their notes (chiptune style), so a
+// single buzzer or PWM channel plays every chord tone instead of only the first
+
+typedef enum {
+    ABC_ARP_UP,                 // Lowest to highest, repeating
+    ABC_ARP_DOWN,               // Highest to lowest, repeating
+    ABC_ARP_UP_DOWN             // Up then back down without repeating the ends
+} AbcArpPattern;
+
+typedef struct {
+    uint8_t step_ticks;         // Length of each arpeggio step (e.g. ABC_PPQ / 8)
+    AbcArpPattern pattern;
+} AbcArpConfig;
+
+// Called for each output note; return nonzero to stop
+typedef int (*AbcArpCallback)(void *user, uint8_t midi, uint8_t duration);
+
+// Expand the chords of src into dst, which is reset first (voice ID kept)
+// Single notes and rests are copied; a chord becomes steps of step_ticks,
+// the last step taking the remainder so the chord's duration is unchanged.
+// Returns 0 on success, -1 on invalid arguments, -2 if dst is full
+int abc_arpeggiate(const NotePool *src, NotePool *dst, const AbcArpConfig *config);
+
+// Same expansion as a stream of single notes (rests have midi 0)
+// callback may be NULL to only count the notes, e.g. to size dst
+// Returns the number of notes, -1 on invalid arguments, -3 if the callback stopped
+int32_t abc_arpeggiate_events(const NotePool *src, const AbcArpConfig *config,
+                              AbcArpCallback callback, void *user);
+
+// Bulk edits in place: tight passes that follow the notes' next_index links
+// directly (no per-note calls), so pools edited with abc_editor, whose arrays
+// keep spliced-out notes, are handled too. Read-only pools (capacity 0, e.g.
+// store views or embedded tunes) are rejected.
+
+typedef enum {
+    ABC_RANGE_CLAMP,            // Pitches outside the range stick to its edge
+    ABC_RANGE_FOLD              // Pitches outside the range move by octaves into it
+} AbcRangeMode;
+
+// Transpose every pitch by `semitones`, keeping results within [low, high]
+// Rests stay rests. Folding needs a range of at least an octave to always
+// land inside; anything still outside is clamped.
+// Returns how many pitches had to be clamped or folded, -1 on invalid arguments
+int32_t abc_pool_transpose(NotePool *pool, int8_t semitones, uint8_t low, uint8_t high, AbcRangeMode mode);
+
+// Multiply every duration by num/den (e.g. 4/5 plays 25% faster)
+// Rounding is carried from note to note, so total_ticks becomes exactly
+// total_ticks * num / den rounded, and note onsets stay within half a tick.
+// Returns 0 on success, -1 on invalid arguments, -2 if a note would exceed
+// 255 ticks (the pool is left unchanged)
+int abc_pool_scale_durations(NotePool *pool, uint16_t num, uint16_t den);
+
+#endif // ABC_TRANSFORM_H
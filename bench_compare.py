@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Compare bench_parser JSON results against a stored baseline.
+
+Usage: bench_compare.py BASELINE.json CURRENT.json [--threshold 0.10]
+
+Prints the change in median time per benchmark and exits with status 1 if
+any benchmark got slower by more than the threshold (default 10%), so it can
+gate CI. Benchmarks missing from either file are reported but do not fail.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="allowed slowdown of the median as a fraction (default 0.10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    print(f"{'benchmark':<16} {'baseline':>10} {'current':>10} {'change':>8}")
+    for name in sorted(set(baseline) | set(current)):
+        if name not in baseline or name not in current:
+            print(f"{name:<16} {'only in ' + ('current' if name in current else 'baseline'):>30}")
+            continue
+        old = baseline[name]["median"]
+        new = current[name]["median"]
+        change = (new - old) / old if old > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            flag = "  faster"
+        print(f"{name:<16} {old:>10.2f} {new:>10.2f} {change:>+7.1%}{flag}")
+
+    if regressions:
+        print(f"\n{regressions} benchmark(s) slower than the baseline by more than {args.threshold:.0%}")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
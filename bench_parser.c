@@ -0,0 +1,256 @@
+// bench_parser - microbenchmarks for the parser's hot paths
+//
+// Times each workload in isolation: after warmup, every repetition runs a
+// batch sized to take about two milliseconds and records nanoseconds per
+// item (note parsed, byte scanned, note visited or conversion made). Reports
+// the median, 90th and 99th percentile and minimum over the repetitions, and
+// writes them as JSON for bench_compare.py to check against a stored baseline.
+//
+// Usage: bench_parser [--reps N] [--warmup N] [--filter TEXT] [--json FILE]
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "abc_parser.h"
+
+#define BENCH_MAX_VOICES 2
+#define BENCH_MAX_NOTES 16384
+#define BENCH_MAX_REPS 1000
+#define BENCH_INPUT_SIZE 60000
+#define BENCH_BATCH_NS 2000000.0
+
+static NotePool g_pools[BENCH_MAX_VOICES];
+static struct note g_storage[BENCH_MAX_VOICES][BENCH_MAX_NOTES];
+static struct sheet g_sheet;
+static volatile uint32_t g_sink;  // Keeps results observable so loops are not optimized away
+
+static char g_tune[BENCH_INPUT_SIZE];
+static char g_pitches[BENCH_INPUT_SIZE];
+static char g_chords[BENCH_INPUT_SIZE];
+static char g_repeats[BENCH_INPUT_SIZE];
+
+// ============================================================================
+// Timing
+// ============================================================================
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const double *sorted, int count, int pct) {
+    int rank = (pct * count + 99) / 100;
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+// ============================================================================
+// Inputs
+// ============================================================================
+
+static size_t append(char *buf, size_t len, const char *text) {
+    size_t n = strlen(text);
+    if (len + n >= BENCH_INPUT_SIZE) return len;
+    memcpy(buf + len, text, n + 1);
+    return len + n;
+}
+
+// Repeat a bar of music until the input holds about `notes` notes per voice
+static void build_input(char *buf, const char *header, const char *bar, int notes_per_bar, int notes) {
+    size_t len = append(buf, 0, header);
+    for (int n = 0; n < notes; n += notes_per_bar) len = append(buf, len, bar);
+    append(buf, len, "|]\n");
+}
+
+static void build_inputs(void) {
+    // Typical two-voice tune: mixed lengths, accidentals, a tuplet and a repeat
+    size_t len = append(g_tune, 0, "X:1\nT:Bench\nM:4/4\nL:1/8\nQ:1/4=120\nK:G\n");
+    for (int voice = 1; voice <= 2; voice++) {
+        len = append(g_tune, len, voice == 1 ? "V:1\n" : "V:2\n");
+        for (int bars = 0; bars < 120; bars++) {
+            len = append(g_tune, len, voice == 1 ? "|: G2 AB c2 ^cd | (3efg f>e d2 z2 :| "
+                                                 : "G,4 D,4 | [G,B,D]2 z2 C2 D2 | ");
+            if (bars % 8 == 7) len = append(g_tune, len, "\n");
+        }
+        len = append(g_tune, len, "|]\n");
+    }
+
+    build_input(g_pitches, "L:1/16\nK:Eb\n", "^c' _B, =e d'' ^^f __a, =G c,, | ", 8, 6000);
+    build_input(g_chords, "L:1/8\nK:D\n", "[CEG]2 [DF^A] [E,G,B,d]2 [F_Ac]3 | ", 4, 6000);
+    build_input(g_repeats, "L:1/8\nK:C\n", "|: C D E F G A B c :| ", 8, 6000);
+}
+
+// ============================================================================
+// Workloads (each returns the number of items it processed)
+// ============================================================================
+
+static uint32_t parse_input(const char *abc) {
+    sheet_reset(&g_sheet);
+    if (abc_parse(&g_sheet, abc) < 0) return 0;
+    uint32_t notes = 0;
+    for (uint8_t v = 0; v < g_sheet.voice_count; v++) notes += g_pools[v].count;
+    return notes;
+}
+
+static uint32_t bench_parse_tune(void) { return parse_input(g_tune); }
+static uint32_t bench_parse_pitches(void) { return parse_input(g_pitches); }
+static uint32_t bench_parse_chords(void) { return parse_input(g_chords); }
+static uint32_t bench_parse_repeats(void) { return parse_input(g_repeats); }
+
+// Catalog scan of the same tune, per input byte
+static uint32_t bench_scan_tune(void) {
+    AbcHeaderScan scan;
+    if (abc_scan_header(g_tune, ABC_SCAN_VOICES, &scan) < 0) return 0;
+    g_sink += scan.voice_count;
+    return (uint32_t)strlen(g_tune);
+}
+
+static uint32_t bench_note_next(void) {
+    uint32_t notes = 0, ticks = 0;
+    for (uint8_t v = 0; v < g_sheet.voice_count; v++) {
+        for (struct note *n = pool_first_note(&g_pools[v]); n; n = note_next(&g_pools[v], n)) {
+            ticks += n->duration;
+            notes++;
+        }
+    }
+    g_sink += ticks;
+    return notes;
+}
+
+static uint32_t bench_ticks_to_ms(void) {
+    uint32_t ms = 0;
+    for (uint16_t bpm = 60; bpm < 188; bpm++) {
+        for (uint16_t ticks = 0; ticks < 256; ticks++) ms += ticks_to_ms((uint8_t)ticks, bpm);
+    }
+    g_sink += ms;
+    return 128 * 256;
+}
+
+typedef struct {
+    const char *name;
+    const char *item;           // What one item is, for the report
+    uint32_t (*run)(void);
+    uint32_t (*setup)(void);    // Optional, run once before timing
+} Bench;
+
+static const Bench benches[] = {
+    { "parse_tune",     "note",  bench_parse_tune,    NULL },
+    { "parse_pitches",  "note",  bench_parse_pitches, NULL },
+    { "parse_chords",   "note",  bench_parse_chords,  NULL },
+    { "parse_repeats",  "note",  bench_parse_repeats, NULL },  // Half the notes come from repeat copies
+    { "scan_tune",      "byte",  bench_scan_tune,     NULL },
+    { "note_next",      "note",  bench_note_next,     bench_parse_tune },
+    { "ticks_to_ms",    "call",  bench_ticks_to_ms,   NULL },
+};
+
+// ============================================================================
+// Runner
+// ============================================================================
+
+typedef struct {
+    double median, p90, p99, min;
+    uint32_t items;             // Items per call
+    uint32_t batch;             // Calls per repetition
+} BenchResult;
+
+static int run_bench(const Bench *b, int warmup, int reps, BenchResult *r) {
+    static double samples[BENCH_MAX_REPS];
+    if (b->setup) b->setup();
+
+    uint32_t items = b->run();
+    if (items == 0) return -1;  // Input failed to parse
+    for (int i = 0; i < warmup; i++) b->run();
+
+    // Size the batch so each sample is long enough to time reliably
+    double start = now_ns();
+    b->run();
+    double once = now_ns() - start;
+    uint32_t batch = once > 0 ? (uint32_t)(BENCH_BATCH_NS / once) : 1000;
+    if (batch < 1) batch = 1;
+
+    for (int rep = 0; rep < reps; rep++) {
+        start = now_ns();
+        for (uint32_t i = 0; i < batch; i++) b->run();
+        samples[rep] = (now_ns() - start) / ((double)batch * items);
+    }
+    qsort(samples, (size_t)reps, sizeof(double), compare_double);
+
+    r->median = percentile(samples, reps, 50);
+    r->p90 = percentile(samples, reps, 90);
+    r->p99 = percentile(samples, reps, 99);
+    r->min = samples[0];
+    r->items = items;
+    r->batch = batch;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int reps = 30, warmup = 3;
+    const char *filter = NULL, *json_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--reps") && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+        else if (!strcmp(argv[i], "--json") && i + 1 < argc) json_path = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--reps N] [--warmup N] [--filter TEXT] [--json FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (reps < 1) reps = 1;
+    if (reps > BENCH_MAX_REPS) reps = BENCH_MAX_REPS;
+    if (warmup < 0) warmup = 0;
+
+    for (int i = 0; i < BENCH_MAX_VOICES; i++) {
+        note_pool_init(&g_pools[i], g_storage[i], BENCH_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    sheet_init(&g_sheet, g_pools, BENCH_MAX_VOICES);
+    build_inputs();
+
+    FILE *json = NULL;
+    if (json_path) {
+        json = fopen(json_path, "w");
+        if (!json) {
+            fprintf(stderr, "bench_parser: cannot write %s\n", json_path);
+            return 1;
+        }
+        fprintf(json, "{\n  \"unit\": \"ns/item\",\n  \"reps\": %d,\n  \"benchmarks\": [", reps);
+    }
+
+    printf("%-16s %10s %10s %10s %10s %8s\n", "benchmark", "median", "p90", "p99", "min", "items");
+    int written = 0, failed = 0;
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        const Bench *b = &benches[i];
+        if (filter && !strstr(b->name, filter)) continue;
+
+        BenchResult r;
+        if (run_bench(b, warmup, reps, &r) < 0) {
+            fprintf(stderr, "bench_parser: %s: workload failed\n", b->name);
+            failed = 1;
+            continue;
+        }
+        printf("%-16s %10.2f %10.2f %10.2f %10.2f %8u ns/%s\n",
+               b->name, r.median, r.p90, r.p99, r.min, r.items, b->item);
+        if (json) {
+            fprintf(json, "%s\n    { \"name\": \"%s\", \"item\": \"%s\", \"median\": %.3f, \"p90\": %.3f, "
+                          "\"p99\": %.3f, \"min\": %.3f, \"items\": %u, \"batch\": %u }",
+                    written++ ? "," : "", b->name, b->item, r.median, r.p90, r.p99, r.min, r.items, r.batch);
+        }
+    }
+
+    if (json) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+    }
+    return failed;
+}
@@ -0,0 +1,270 @@
+// bench_scaling - parser throughput and memory across corpus sizes and shapes
+//
+// Generates deterministic corpora (abc_corpus) from 1 KB to 100 MB, sized
+// by bytes or by tune count. They sweep voices, tune length, chord density,
+// tuplets, accidentals, repeats and annotation noise. Each corpus is parsed
+// tune by tune. The report gives throughput
+// (MB/s and ns per note) and memory: the largest note pool any single tune
+// needed and the input bytes per note. The JSON output uses the same layout as
+// bench_parser, so bench_compare.py can check it against a baseline.
+//
+// Usage: bench_scaling [--max-mb N] [--reps N] [--filter TEXT] [--json FILE]
+//        bench_scaling --dump SCENARIO    (write that corpus to stdout)
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "abc_parser.h"
+#include "abc_corpus.h"
+
+#define SCALE_MAX_NOTES 4096    // Per voice; generated tunes stay well below
+#define SCALE_MAX_REPS 15
+#define SCALE_TUNE_MAX 0xFFFF   // Parser input limit
+
+static NotePool g_pools[ABC_CORPUS_MAX_VOICES];
+static struct note g_storage[ABC_CORPUS_MAX_VOICES][SCALE_MAX_NOTES];
+static struct sheet g_sheet;
+
+typedef struct {
+    const char *name;
+    uint32_t kilobytes;         // Corpus size to generate (0 = set by tunes)
+    uint32_t tunes;             // Tunes to generate (0 = set by kilobytes)
+    uint16_t bars;              // Bars per voice (0 = generator default)
+    uint8_t voices;
+    uint8_t chord_pct;
+    uint8_t tuplet_pct;
+    uint8_t accidental_pct;
+    uint8_t repeat_pct;
+    uint8_t repeat_bars;
+    uint8_t noise_pct;
+} Scenario;
+
+// Knob left at 0xFF keeps the generator default
+#define DEF 0xFF
+
+static const Scenario scenarios[] = {
+    { "1kb_1v",          1,      0,      0,  1,  DEF, DEF, DEF, DEF, DEF, DEF },
+    { "1mb_1v",          1024,   0,      0,  1,  DEF, DEF, DEF, DEF, DEF, DEF },
+    { "1mb_16v",         1024,   0,      0,  16, DEF, DEF, DEF, DEF, DEF, DEF },
+    { "1mb_chords",      1024,   0,      0,  1,  100, DEF, DEF, DEF, DEF, DEF },
+    { "1mb_tuplets",     1024,   0,      0,  1,  DEF, 60,  DEF, DEF, DEF, DEF },
+    { "1mb_accidentals", 1024,   0,      0,  1,  DEF, DEF, 80,  DEF, DEF, DEF },
+    { "1mb_repeats",     1024,   0,      0,  1,  DEF, DEF, DEF, 100, 16,  DEF },
+    { "1mb_noise",       1024,   0,      0,  1,  DEF, DEF, DEF, DEF, DEF, 60  },
+    { "10k_tunes_4bar",  0,      10000,  4,  1,  DEF, DEF, DEF, DEF, DEF, DEF },
+    { "100k_tunes_4bar", 0,      100000, 4,  1,  DEF, DEF, DEF, DEF, DEF, DEF },
+    { "100mb_1v",        102400, 0,      0,  1,  DEF, DEF, DEF, DEF, DEF, DEF },
+    { "100mb_16v",       102400, 0,      0,  16, DEF, DEF, DEF, DEF, DEF, DEF },
+};
+
+static void scenario_config(const Scenario *sc, AbcCorpusConfig *config) {
+    abc_corpus_defaults(config);
+    config->seed = 42;
+    config->tunes = sc->tunes;
+    config->voices = sc->voices;
+    if (sc->bars) config->bars = sc->bars;
+    if (sc->chord_pct != DEF) { config->chord_pct = sc->chord_pct; config->max_chord = 4; }
+    if (sc->tuplet_pct != DEF) config->tuplet_pct = sc->tuplet_pct;
+    if (sc->accidental_pct != DEF) config->accidental_pct = sc->accidental_pct;
+    if (sc->repeat_pct != DEF) config->repeat_pct = sc->repeat_pct;
+    if (sc->repeat_bars != DEF) config->repeat_bars = sc->repeat_bars;
+    if (sc->noise_pct != DEF) config->noise_pct = sc->noise_pct;
+}
+
+// ============================================================================
+// Corpus
+// ============================================================================
+
+typedef struct {
+    char *text;                 // Tunes back to back, each NUL-terminated
+    size_t bytes;               // Total tune bytes (without terminators)
+    uint32_t *offsets;
+    uint32_t tunes;
+} Corpus;
+
+static void corpus_free(Corpus *c) {
+    free(c->text);
+    free(c->offsets);
+}
+
+// Generate tunes until the corpus reaches the scenario's size or tune count
+static int corpus_build(const Scenario *sc, Corpus *c) {
+    AbcCorpusConfig config;
+    scenario_config(sc, &config);
+
+    size_t target = sc->kilobytes ? (size_t)sc->kilobytes * 1024 : SIZE_MAX;
+    size_t capacity = (sc->kilobytes ? target : 1024 * 1024) + SCALE_TUNE_MAX + 1;
+    uint32_t offset_capacity = 1024;
+    memset(c, 0, sizeof(*c));
+    c->text = malloc(capacity);
+    c->offsets = malloc(offset_capacity * sizeof(uint32_t));
+    if (!c->text || !c->offsets) return -1;
+
+    size_t used = 0;
+    for (uint32_t index = 0; c->bytes < target && (config.tunes == 0 || index < config.tunes); index++) {
+        if (used + SCALE_TUNE_MAX + 1 > capacity) {
+            capacity *= 2;
+            char *grown = realloc(c->text, capacity);
+            if (!grown) return -1;
+            c->text = grown;
+        }
+        int32_t len = abc_corpus_tune(&config, index, c->text + used, SCALE_TUNE_MAX);
+        if (len < 0) return -1;
+        if (c->tunes == offset_capacity) {
+            offset_capacity *= 2;
+            uint32_t *grown = realloc(c->offsets, offset_capacity * sizeof(uint32_t));
+            if (!grown) return -1;
+            c->offsets = grown;
+        }
+        c->offsets[c->tunes++] = (uint32_t)used;
+        used += (size_t)len + 1;
+        c->bytes += (size_t)len;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Measurement
+// ============================================================================
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples (as in bench_parser)
+static double percentile(const double *sorted, int count, int pct) {
+    int rank = (pct * count + 99) / 100;
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+typedef struct {
+    uint64_t notes;
+    uint32_t peak_notes;        // Most notes any one tune needed (all voices)
+    int failed;
+} ParseTotals;
+
+static void parse_corpus(const Corpus *c, ParseTotals *t) {
+    memset(t, 0, sizeof(*t));
+    for (uint32_t i = 0; i < c->tunes; i++) {
+        sheet_reset(&g_sheet);
+        if (abc_parse(&g_sheet, c->text + c->offsets[i]) < 0) t->failed++;
+        uint32_t notes = 0;
+        for (uint8_t v = 0; v < g_sheet.voice_count; v++) notes += g_pools[v].count;
+        t->notes += notes;
+        if (notes > t->peak_notes) t->peak_notes = notes;
+    }
+}
+
+int main(int argc, char **argv) {
+    int reps = 3;
+    uint32_t max_mb = 100;
+    const char *filter = NULL, *json_path = NULL, *dump = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--reps") && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--max-mb") && i + 1 < argc) max_mb = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+        else if (!strcmp(argv[i], "--json") && i + 1 < argc) json_path = argv[++i];
+        else if (!strcmp(argv[i], "--dump") && i + 1 < argc) dump = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--max-mb N] [--reps N] [--filter TEXT] [--json FILE] | --dump SCENARIO\n", argv[0]);
+            return 2;
+        }
+    }
+    if (reps < 1) reps = 1;
+    if (reps > SCALE_MAX_REPS) reps = SCALE_MAX_REPS;
+
+    for (int i = 0; i < ABC_CORPUS_MAX_VOICES; i++) {
+        note_pool_init(&g_pools[i], g_storage[i], SCALE_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    sheet_init(&g_sheet, g_pools, ABC_CORPUS_MAX_VOICES);
+
+    FILE *json = NULL;
+    if (json_path) {
+        json = fopen(json_path, "w");
+        if (!json) {
+            fprintf(stderr, "bench_scaling: cannot write %s\n", json_path);
+            return 1;
+        }
+        fprintf(json, "{\n  \"unit\": \"ns/item\",\n  \"reps\": %d,\n  \"benchmarks\": [", reps);
+    }
+
+    if (!dump) {
+        printf("%-16s %10s %7s %10s %9s %9s %12s %8s\n",
+               "scenario", "bytes", "tunes", "notes", "MB/s", "ns/note", "peak pool B", "B/note");
+    }
+    int written = 0, failed = 0;
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        const Scenario *sc = &scenarios[s];
+        if (dump ? strcmp(sc->name, dump) != 0 : (filter && !strstr(sc->name, filter))) continue;
+        if (!dump && sc->kilobytes > max_mb * 1024) continue;
+
+        Corpus corpus;
+        if (corpus_build(sc, &corpus) < 0) {
+            fprintf(stderr, "bench_scaling: %s: cannot generate corpus\n", sc->name);
+            corpus_free(&corpus);
+            return 1;
+        }
+        if (!dump && sc->kilobytes == 0 && corpus.bytes > (size_t)max_mb * 1024 * 1024) {
+            corpus_free(&corpus);       // Sized by tune count: only known once built
+            continue;
+        }
+        if (dump) {
+            for (uint32_t i = 0; i < corpus.tunes; i++) printf("%s\n", corpus.text + corpus.offsets[i]);
+            corpus_free(&corpus);
+            return 0;
+        }
+
+        // Warm up once, then time whole-corpus parses
+        ParseTotals totals;
+        parse_corpus(&corpus, &totals);
+        double samples[SCALE_MAX_REPS];
+        for (int r = 0; r < reps; r++) {
+            double start = now_ns();
+            parse_corpus(&corpus, &totals);
+            samples[r] = now_ns() - start;
+        }
+        qsort(samples, (size_t)reps, sizeof(double), compare_double);
+        if (totals.failed || totals.notes == 0) {
+            fprintf(stderr, "bench_scaling: %s: %d tunes failed to parse\n", sc->name, totals.failed);
+            failed = 1;
+        }
+
+        double notes = totals.notes ? (double)totals.notes : 1.0;
+        double median = percentile(samples, reps, 50);
+        double mb_per_s = (double)corpus.bytes / (median / 1e9) / (1024.0 * 1024.0);
+        uint32_t peak_bytes = totals.peak_notes * (uint32_t)sizeof(struct note);
+        printf("%-16s %10lu %7u %10llu %9.1f %9.2f %12u %8.2f\n",
+               sc->name, (unsigned long)corpus.bytes, corpus.tunes, (unsigned long long)totals.notes,
+               mb_per_s, median / notes, peak_bytes, (double)corpus.bytes / notes);
+        if (json) {
+            fprintf(json, "%s\n    { \"name\": \"%s\", \"item\": \"note\", \"median\": %.3f, \"p90\": %.3f, "
+                          "\"p99\": %.3f, \"min\": %.3f, \"items\": %llu, \"bytes\": %lu, \"tunes\": %u, "
+                          "\"mb_per_s\": %.2f, \"peak_pool_bytes\": %u }",
+                    written++ ? "," : "", sc->name, median / notes, percentile(samples, reps, 90) / notes,
+                    percentile(samples, reps, 99) / notes, samples[0] / notes, (unsigned long long)totals.notes,
+                    (unsigned long)corpus.bytes, corpus.tunes, mb_per_s, peak_bytes);
+        }
+        corpus_free(&corpus);
+    }
+
+    if (dump) {
+        fprintf(stderr, "bench_scaling: unknown scenario %s\n", dump);
+        return 2;
+    }
+    if (json) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+    }
+    return failed;
+}
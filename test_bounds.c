@@ -0,0 +1,264 @@
+// test_bounds - worst-case stack depth and work per input byte
+//
+// Built with the ABC_BOUNDS CMake option (GCC or Clang). Every parser entry
+// point runs on a set of adversarial inputs: long annotations, digit runs,
+// accidental and octave runs, unterminated chords, voice churn, header floods
+// and cross-voice repeats that double a pool on every few bytes.
+//
+// Stack: the test paints a region of stack, runs an entry point from the same
+// frame depth and finds the deepest byte it overwrote. The library's own frame
+// sizes are in the .su files that -fstack-usage writes next to its objects.
+//
+// Time: the parse is linear in work units (an input byte or a note copied by a
+// repeat, as in abc_parse_step). Each input checks that all of it was consumed
+// exactly once and that its time per unit stays within a fixed factor of an
+// ordinary tune's.
+//
+// The BOUND_* values below are the documented guarantees; the test fails if
+// any of them is exceeded.
+//
+// Usage: test_bounds [--reps N]
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "abc_parser.h"
+
+#define BOUND_STACK_BYTES 2048      // Deepest stack use of any entry point (x86-64, any -O level)
+#define BOUND_UNIT_RATIO 8.0        // Worst time per work unit / an ordinary tune's
+
+#define BOUNDS_VOICES ABC_EDIT_MAX_VOICES   // The editor's limit, so every entry point can run
+#define BOUNDS_NOTES 0x7FFF                 // Largest pool a note index can address
+#define BOUNDS_INPUT 60000
+#define PROBE_BYTES 65536
+
+#define NOINLINE __attribute__((noinline))
+
+static NotePool g_pools[BOUNDS_VOICES];
+static struct note g_storage[BOUNDS_VOICES][BOUNDS_NOTES];
+static struct sheet g_sheet;
+static char g_input[BOUNDS_INPUT + 1];
+static char g_edit_text[BOUNDS_INPUT + 64];
+static AbcCheckpoint g_checkpoints[64];
+
+// ============================================================================
+// Adversarial inputs
+// ============================================================================
+
+typedef struct {
+    const char *name;
+    const char *prefix;         // Written once
+    const char *unit;           // Repeated until the input is full
+} Input;
+
+static const Input inputs[] = {
+    { "ordinary",        "X:1\nM:4/4\nL:1/8\nK:D\n", "|: d2 fe dcBA | (3Bcd ^c2 [DFA]2 z2 :| \"G\"g>f e2 [Ace]4 | " },
+    { "unknown",         "K:C\n", "#" },
+    { "decorations",     "K:C\n", "!+~.-<>{})%" },
+    { "annotation",      "K:C\n\"", "x" },
+    { "accidentals",     "K:C\n", "^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^C" },
+    { "octaves",         "K:C\n", "c''''''''''''''''''''''''''''''''''''''''''''''''''" },
+    { "digits",          "K:C\n", "C99999999999999999999/00000000000000000000 " },
+    { "slashes",         "K:C\n", "C/////////////////////////////////////////////// " },
+    { "open_chord",      "K:C\n[", "#" },
+    { "wide_chords",     "K:C\n", "[CEGBdfac'e'g']3/2" },
+    { "tuplets",         "K:C\n", "(9(3(2" },
+    { "bars",            "K:C\n", "|" },
+    { "voices",          "K:C\n", "V:abcdefghijklmnop C V:abcdefghijklmnoq D V:1 E V:2 F V:3 G V:4 A V:5 B V:6 c V:7 d\n" },
+    { "header",          "", "T:A long title field, much longer than the title buffer will hold, repeated\n" },
+    { "repeats",         "K:C\n", "|: CDEF GABc :|: cBAG FEDC :| " },
+    { "voice_repeats",   "K:C\nV:1\nC\nV:2\nCDEFGABc\n", "V:1\n|: V:2\n:| " },
+};
+
+static void build_input(const Input *in) {
+    size_t len = strlen(in->prefix);
+    size_t unit = strlen(in->unit);
+    memcpy(g_input, in->prefix, len);
+    while (len + unit <= BOUNDS_INPUT) {
+        memcpy(g_input + len, in->unit, unit);
+        len += unit;
+    }
+    g_input[len] = '\0';
+}
+
+// ============================================================================
+// Stack painting
+// ============================================================================
+
+// Called twice from the same frame: once to paint, then (after the entry point
+// ran at the same depth) to find how deep it wrote. Reading what the previous
+// call left behind is the point, so silence GCC's uninitialized warning.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+static NOINLINE size_t stack_probe(int paint) {
+    volatile unsigned char area[PROBE_BYTES];
+    size_t i = 0;
+    if (paint) {
+        for (; i < PROBE_BYTES; i++) area[i] = 0xA5;
+        return 0;
+    }
+    while (i < PROBE_BYTES && area[i] == 0xA5) i++;
+    return PROBE_BYTES - i;
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+static int on_note(void *user, uint8_t voice, const uint8_t *midi, uint8_t chord_size, uint8_t duration) {
+    (void)voice; (void)midi; (void)chord_size;
+    *(uint32_t *)user += duration;
+    return 0;
+}
+
+typedef enum { RUN_PARSE, RUN_STATS, RUN_MEASURE, RUN_EVENTS, RUN_STEP, RUN_CURSOR, RUN_EDITOR, RUN_COUNT } Entry;
+
+static const char *const entry_names[RUN_COUNT] = {
+    "abc_parse", "abc_parse_stats", "abc_measure", "abc_parse_events",
+    "abc_parse_step", "abc_cursor_next", "abc_editor_edit"
+};
+
+static NOINLINE void run_entry(Entry entry) {
+    static AbcParseStats stats;
+    static AbcMeasureReport report;
+    static AbcStepParser step;
+    static AbcCursor cursor;
+    static AbcEditor editor;
+    static uint32_t ticks;
+    static const AbcEventCallbacks callbacks = { .note = on_note };
+    struct note note;
+
+    sheet_reset(&g_sheet);
+    switch (entry) {
+        case RUN_PARSE: abc_parse(&g_sheet, g_input); break;
+        case RUN_STATS: abc_parse_stats(&g_sheet, g_input, &stats); break;
+        case RUN_MEASURE: abc_measure(g_input, &report); break;
+        case RUN_EVENTS: abc_parse_events(g_input, &callbacks, &ticks); break;
+        case RUN_STEP:
+            abc_parse_begin(&step, &g_sheet, g_input);
+            while (abc_parse_step(&step, 64) == ABC_PARSE_IN_PROGRESS) {}
+            break;
+        case RUN_CURSOR:
+            abc_cursor_init(&cursor, g_input, 0);
+            while (abc_cursor_next(&cursor, &note) == 1) {}
+            break;
+        case RUN_EDITOR: {
+            size_t len = strlen(g_input);
+            memcpy(g_edit_text, g_input, len + 1);
+            if (abc_editor_init(&editor, &g_sheet, g_edit_text, sizeof(g_edit_text), g_checkpoints, 64) == 0) {
+                abc_editor_edit(&editor, (uint16_t)(len / 2), (uint16_t)(len / 2 + 1), "C", 1);
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+static size_t measure_stack(Entry entry) {
+    stack_probe(1);
+    run_entry(entry);
+    return stack_probe(0);
+}
+
+// ============================================================================
+// Timing
+// ============================================================================
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Fastest of reps parses (the least disturbed), in ns
+static double time_parse(int reps, AbcParseStats *stats) {
+    double best = 0;
+    for (int r = 0; r < reps; r++) {
+        sheet_reset(&g_sheet);
+        double start = now_ns();
+        abc_parse_stats(&g_sheet, g_input, stats);
+        double elapsed = now_ns() - start;
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int reps = 20;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--reps") && i + 1 < argc) reps = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--reps N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (reps < 1) reps = 1;
+
+    for (int v = 0; v < BOUNDS_VOICES; v++) {
+        note_pool_init(&g_pools[v], g_storage[v], BOUNDS_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    sheet_init(&g_sheet, g_pools, BOUNDS_VOICES);
+
+    // Warm up: lazily bound library calls resolve on first use, on a deep stack
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        build_input(&inputs[i]);
+        for (int e = 0; e < RUN_COUNT; e++) run_entry((Entry)e);
+    }
+
+    printf("%-14s %7s %9s %9s %9s %9s  %s\n", "input", "bytes", "units", "ns/byte", "ns/unit", "stack B", "deepest entry");
+    size_t worst_stack = 0;
+    double ordinary_unit = 0, worst_ratio = 0;
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        const Input *in = &inputs[i];
+        build_input(in);
+        uint32_t len = (uint32_t)strlen(g_input);
+
+        size_t stack = 0;
+        Entry deepest = RUN_PARSE;
+        for (int e = 0; e < RUN_COUNT; e++) {
+            size_t used = measure_stack((Entry)e);
+            if (used > stack) {
+                stack = used;
+                deepest = (Entry)e;
+            }
+        }
+        if (stack > worst_stack) worst_stack = stack;
+
+        AbcParseStats stats;
+        double ns = time_parse(reps, &stats);
+        uint32_t units = stats.bytes + stats.notes_copied;
+        double per_unit = ns / units;
+        if (i == 0) ordinary_unit = per_unit;
+        double ratio = per_unit / ordinary_unit;
+        if (ratio > worst_ratio) worst_ratio = ratio;
+
+        printf("%-14s %7lu %9lu %9.2f %9.2f %9lu  %s\n", in->name, (unsigned long)len, (unsigned long)units,
+               ns / len, per_unit, (unsigned long)stack, entry_names[deepest]);
+
+        // Every byte consumed once: no backtracking, no early stop short of a full pool
+        int pool_full = 0;
+        for (uint8_t v = 0; v < stats.voice_count; v++) pool_full |= stats.pool_peak[v] == BOUNDS_NOTES;
+        if (stats.bytes != len && !pool_full) {
+            printf("  FAIL: consumed %lu of %lu bytes\n", (unsigned long)stats.bytes, (unsigned long)len);
+            failed = 1;
+        }
+    }
+
+    printf("\nDeepest stack: %lu bytes (bound %d)\n", (unsigned long)worst_stack, BOUND_STACK_BYTES);
+    printf("Worst time per unit: %.1fx an ordinary tune (bound %.1fx)\n", worst_ratio, BOUND_UNIT_RATIO);
+    if (worst_stack > BOUND_STACK_BYTES) {
+        printf("FAIL: stack bound exceeded\n");
+        failed = 1;
+    }
+    if (worst_ratio > BOUND_UNIT_RATIO) {
+        printf("FAIL: time bound exceeded\n");
+        failed = 1;
+    }
+    printf("%s\n", failed ? "Bounds violated" : "All bounds hold");
+    return failed;
+}
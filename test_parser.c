@@ -2,6 +2,20 @@
 #include <string.h>
 #include <math.h>
 #include "abc_parser.h"
+#include "abc_image.h"
+#include "abc_arena.h"
+#include "abc_store.h"
+#include "abc_cache.h"
+#include "abc_sequencer.h"
+#include "abc_polyphony.h"
+#include "abc_transform.h"
+#include "abc_corpus.h"
+#include "abc_trace.h"
+#include "abc_index.h"
+#include "abc_search.h"
+#include "abc_fingerprint.h"
+#include "abc_analysis.h"
+#include "test_embed.h"  // Generated from tunes/test_embed.abc by abc_embed()
 
 // Test infrastructure
 static int tests_run = 0;
@@ -824,6 +838,2199 @@ TEST(voice_inline_whitespace) {
     return 1;
 }
 
+// ============================================================================
+// Binary Image Tests
+// ============================================================================
+
+// 8-byte aligned scratch buffer for images
+static uint64_t g_image_buf[512];
+
+// An allocator must never be handed memory inside an image
+static int g_image_grow_calls;
+static struct note *refuse_image_grow(void *ctx, struct note *old, uint16_t used,
+                                      uint16_t min_capacity, uint16_t *capacity) {
+    (void)ctx; (void)old; (void)used; (void)min_capacity; (void)capacity;
+    g_image_grow_calls++;
+    return NULL;
+}
+
+TEST(image_roundtrip) {
+    int result = abc_parse(&g_sheet, "T:Image\nM:3/4\nL:1/8\nQ:90\nK:G\nV:A\n|:F [CEG]2 z:|\nV:B\nC,4");
+    ASSERT_EQ(result, 0);
+
+    int32_t size = sheet_save_image(&g_sheet, NULL, 0);
+    ASSERT(size > 0 && size <= (int32_t)sizeof(g_image_buf));
+    ASSERT_EQ(sheet_save_image(&g_sheet, g_image_buf, sizeof(g_image_buf)), size);
+
+    NotePool pools[TEST_MAX_VOICES];
+    struct sheet loaded;
+    for (int i = 0; i < TEST_MAX_VOICES; i++) note_pool_init(&pools[i], NULL, 0, ABC_MAX_CHORD_NOTES);
+    sheet_init(&loaded, pools, TEST_MAX_VOICES);
+    ASSERT_EQ(abc_load_image(&loaded, g_image_buf, (uint32_t)size), 0);
+
+    ASSERT(strcmp(loaded.title, "Image") == 0);
+    ASSERT(strcmp(loaded.key, "G") == 0);
+    ASSERT_EQ(loaded.tempo_bpm, 90);
+    ASSERT_EQ(loaded.meter_num, 3);
+    ASSERT_EQ(loaded.voice_count, 2);
+    ASSERT(strcmp(pools[1].voice_id, "B") == 0);
+
+    for (int v = 0; v < 2; v++) {
+        ASSERT_EQ(pools[v].count, g_pools[v].count);
+        ASSERT_EQ(pools[v].total_ticks, g_pools[v].total_ticks);
+        // Notes are mapped in place, not copied
+        ASSERT((const uint8_t *)pools[v].notes > (const uint8_t *)g_image_buf);
+        ASSERT((const uint8_t *)pools[v].notes < (const uint8_t *)g_image_buf + size);
+        struct note *a = pool_first_note(&g_pools[v]);
+        struct note *b = pool_first_note(&pools[v]);
+        while (a) {
+            ASSERT(b != NULL);
+            ASSERT_EQ(a->duration, b->duration);
+            ASSERT_EQ(a->chord_size, b->chord_size);
+            ASSERT(memcmp(a->midi_note, b->midi_note, a->chord_size) == 0);
+            a = note_next(&g_pools[v], a);
+            b = note_next(&pools[v], b);
+        }
+        ASSERT(b == NULL);
+    }
+
+    // Loaded pools are read-only, even if they had an allocator
+    ASSERT_EQ(note_pool_available(&pools[0]), 0);
+    ASSERT_EQ(abc_parse(&loaded, "C"), -2);
+    static const AbcAllocator never = { refuse_image_grow, NULL };
+    for (int i = 0; i < TEST_MAX_VOICES; i++) note_pool_set_allocator(&pools[i], &never);
+    ASSERT_EQ(abc_load_image(&loaded, g_image_buf, (uint32_t)size), 0);
+    ASSERT(pools[0].allocator == NULL);
+    ASSERT_EQ(abc_parse(&loaded, "C"), -2);
+    ASSERT_EQ(g_image_grow_calls, 0);
+    return 1;
+}
+
+// Re-sign an image after editing it, as a crafted image would be
+static void put_image_checksum(uint8_t *bytes, int32_t size) {
+    uint32_t sum = abc_image_checksum(bytes + 16, (uint32_t)size - 16);
+    for (int i = 0; i < 4; i++) bytes[12 + i] = (uint8_t)(sum >> (8 * i));
+}
+
+TEST(image_rejects_corruption) {
+    ASSERT_EQ(abc_parse(&g_sheet, "K:C\nC D E"), 0);
+    int32_t size = sheet_save_image(&g_sheet, g_image_buf, sizeof(g_image_buf));
+    ASSERT(size > 0);
+    ASSERT_EQ(sheet_save_image(&g_sheet, g_image_buf, (uint32_t)size - 1), -2);
+
+    NotePool pool;
+    struct sheet loaded;
+    note_pool_init(&pool, NULL, 0, ABC_MAX_CHORD_NOTES);
+    sheet_init(&loaded, &pool, 1);
+
+    uint8_t *bytes = (uint8_t *)g_image_buf;
+    bytes[size - 4] ^= 0x40;  // Flip a bit in the last note
+    ASSERT_EQ(abc_load_image(&loaded, g_image_buf, (uint32_t)size), -3);
+    bytes[size - 4] ^= 0x40;
+    ASSERT_EQ(abc_load_image(&loaded, g_image_buf, (uint32_t)size - 8), -3);
+    ASSERT_EQ(abc_load_image(&loaded, g_image_buf, (uint32_t)size), 0);
+    ASSERT_EQ(pool.count, 3);
+
+    // Crafted images pass the checksum, so links and pitches are checked too
+    struct note *last = &pool.notes[2];
+    last->next_index = 0;                                   // Cycle back to the first note
+    put_image_checksum(bytes, size);
+    ASSERT_EQ(abc_load_image(&loaded, g_image_buf, (uint32_t)size), -3);
+    last->next_index = -1;
+    last->midi_note[0] = 200;                               // Past the 128-entry pitch tables
+    put_image_checksum(bytes, size);
+    ASSERT_EQ(abc_load_image(&loaded, g_image_buf, (uint32_t)size), -3);
+    return 1;
+}
+
+// ============================================================================
+// Build-time Embedding Tests
+// ============================================================================
+
+TEST(embedded_matches_runtime_parse) {
+    // Same text as tunes/test_embed.abc
+    const char *music =
+        "X:1\nT:Embed Test\nM:3/4\nL:1/8\nQ:1/4=90\nK:D\n"
+        "V:MELODY\n|:F A d2 [DFA]2:|\n"
+        "V:BASS\nD,4 A,,2 |\n";
+    ASSERT_EQ(abc_parse(&g_sheet, music), 0);
+
+    const struct sheet *e = &abc_tune_test_embed;
+    ASSERT(strcmp(e->title, g_sheet.title) == 0);
+    ASSERT(strcmp(e->key, "D") == 0);
+    ASSERT_EQ(e->tempo_bpm, 90);
+    ASSERT_EQ(e->voice_count, 2);
+    for (int v = 0; v < 2; v++) {
+        const NotePool *pool = &e->pools[v];
+        // Storage is sized exactly and read-only
+        ASSERT_EQ(pool->count, g_pools[v].count);
+        ASSERT_EQ(pool->capacity, 0);
+        ASSERT_EQ(pool->total_ticks, g_pools[v].total_ticks);
+        ASSERT(strcmp(pool->voice_id, g_pools[v].voice_id) == 0);
+        struct note *a = pool_first_note(&g_pools[v]);
+        struct note *b = pool_first_note(pool);
+        while (a) {
+            ASSERT(b != NULL);
+            ASSERT_EQ(a->duration, b->duration);
+            ASSERT_EQ(a->chord_size, b->chord_size);
+            ASSERT(memcmp(a->midi_note, b->midi_note, a->chord_size) == 0);
+            a = note_next(&g_pools[v], a);
+            b = note_next(pool, b);
+        }
+        ASSERT(b == NULL);
+    }
+    return 1;
+}
+
+// ============================================================================
+// Measure (Dry Run) Tests
+// ============================================================================
+
+TEST(measure_matches_parse) {
+    const char *music = "L:1/8\nK:C\nV:A\n|:C [CEG] (3DEF:| G4\nV:B\nC,8 |: z2 :: C2 :|";
+    AbcMeasureReport report;
+    ASSERT_EQ(abc_measure(music, &report), 0);
+    ASSERT_EQ(abc_parse(&g_sheet, music), 0);
+
+    ASSERT_EQ(report.voice_count, g_sheet.voice_count);
+    ASSERT_EQ(report.notes[0], g_pools[0].count);  // 5 notes, repeated, plus G
+    ASSERT_EQ(report.notes[1], g_pools[1].count);
+    ASSERT_EQ(report.total_notes, g_pools[0].count + g_pools[1].count);
+    ASSERT(strcmp(report.voice_id[0], "A") == 0);
+    ASSERT(strcmp(report.voice_id[1], "B") == 0);
+    ASSERT_EQ(report.max_chord_size, 3);
+    ASSERT_EQ(report.max_duration, 192);  // C,8 at L:1/8
+    return 1;
+}
+
+TEST(measure_sizes_pools_exactly) {
+    const char *music = "K:G\n|:F G A B:| c d";
+    AbcMeasureReport report;
+    ASSERT_EQ(abc_measure(music, &report), 0);
+    ASSERT_EQ(report.voice_count, 1);
+    ASSERT_EQ(report.notes[0], 10);
+    ASSERT(strcmp(report.voice_id[0], "default") == 0);
+
+    struct note storage[10];
+    NotePool pool;
+    struct sheet sheet;
+    note_pool_init(&pool, storage, report.notes[0], report.max_chord_size);
+    sheet_init(&sheet, &pool, report.voice_count);
+    ASSERT_EQ(abc_parse(&sheet, music), 0);
+    ASSERT_EQ(note_pool_available(&pool), 0);
+
+    // One slot short fails
+    note_pool_init(&pool, storage, report.notes[0] - 1, report.max_chord_size);
+    sheet_init(&sheet, &pool, report.voice_count);
+    ASSERT_EQ(abc_parse(&sheet, music), -2);
+    return 1;
+}
+
+TEST(measure_null_input) {
+    AbcMeasureReport report;
+    ASSERT_EQ(abc_measure(NULL, &report), -1);
+    ASSERT_EQ(abc_measure("C", NULL), -1);
+    return 1;
+}
+
+// ============================================================================
+// Allocator and Arena Tests
+// ============================================================================
+
+// Grow callback that hands out fixed 8-note steps from a static buffer
+static struct note g_grow_storage[64];
+static int g_grow_calls;
+
+static struct note *test_grow(void *ctx, struct note *old, uint16_t used,
+                              uint16_t min_capacity, uint16_t *capacity) {
+    (void)ctx;
+    g_grow_calls++;
+    uint16_t want = (uint16_t)((min_capacity + 7) & ~7);
+    if (want > 64) return NULL;
+    if (old != g_grow_storage && used > 0) memcpy(g_grow_storage, old, used * sizeof(struct note));
+    *capacity = want;
+    return g_grow_storage;
+}
+
+TEST(pool_grows_through_allocator) {
+    static const AbcAllocator alloc = { test_grow, NULL };
+    struct note small[2];
+    NotePool pool;
+    struct sheet sheet;
+    note_pool_init(&pool, small, 2, ABC_MAX_CHORD_NOTES);
+    note_pool_set_allocator(&pool, &alloc);
+    sheet_init(&sheet, &pool, 1);
+
+    g_grow_calls = 0;
+    ASSERT_EQ(abc_parse(&sheet, "K:C\n|:C D E F G A B c:|"), 0);
+    ASSERT_EQ(pool.count, 16);
+    ASSERT(g_grow_calls >= 2);
+    ASSERT(pool.notes == g_grow_storage);
+
+    // Links survive the moves
+    struct note *n = pool_first_note(&pool);
+    for (int i = 0; i < 8; i++) n = note_next(&pool, n);
+    ASSERT_EQ(n->midi_note[0], 60);  // Repeat starts again at C
+
+    // Growth failure still reports exhaustion
+    sheet_reset(&sheet);
+    char big[256] = "K:C\n";
+    for (int i = 0; i < 70; i++) strcat(big, "C ");
+    ASSERT_EQ(abc_parse(&sheet, big), -2);
+    return 1;
+}
+
+TEST(arena_serves_many_sheets) {
+    static uint8_t buffer[4096];
+    AbcArena arena;
+    abc_arena_init(&arena, buffer, sizeof(buffer));
+
+    for (int round = 0; round < 3; round++) {
+        struct sheet sheet;
+        ASSERT_EQ(abc_arena_sheet_init(&arena, &sheet, 2, ABC_MAX_CHORD_NOTES), 0);
+        ASSERT_EQ(abc_parse(&sheet, "K:C\nV:A\n|:C D E F:| G A B c\nV:B\nC,2 G,2 C,2 G,2"), 0);
+        ASSERT_EQ(sheet.voice_count, 2);
+        ASSERT_EQ(sheet.pools[0].count, 12);
+        ASSERT_EQ(sheet.pools[1].count, 4);
+        ASSERT(arena.used > 0 && arena.used <= sizeof(buffer));
+        abc_arena_reset(&arena);  // O(1) release of pools and notes
+        ASSERT_EQ(arena.used, 0);
+    }
+
+    // A full arena fails like an exhausted pool
+    AbcArena tiny;
+    abc_arena_init(&tiny, buffer, 256);
+    struct sheet sheet;
+    ASSERT_EQ(abc_arena_sheet_init(&tiny, &sheet, 1, ABC_MAX_CHORD_NOTES), 0);
+    char big[512] = "K:C\n";
+    for (int i = 0; i < 100; i++) strcat(big, "C ");
+    ASSERT_EQ(abc_parse(&sheet, big), -2);
+    return 1;
+}
+
+// ============================================================================
+// Sheet Store Tests
+// ============================================================================
+
+static uint8_t g_store_heap[8192];
+static AbcStoreEntry g_store_entries[16];
+static AbcStoreString g_store_strings[32];
+
+static int store_add_tune(AbcStore *store, AbcStoreHandle *h, const char *music) {
+    sheet_reset(&g_sheet);
+    if (abc_parse(&g_sheet, music) != 0) return 0;
+    *h = abc_store_add(store, &g_sheet);
+    return *h != ABC_STORE_INVALID;
+}
+
+TEST(store_add_and_view) {
+    AbcStore store;
+    ASSERT_EQ(abc_store_init(&store, g_store_heap, sizeof(g_store_heap), g_store_entries, 16, g_store_strings, 32), 0);
+
+    AbcStoreHandle a, b;
+    ASSERT(store_add_tune(&store, &a, "T:Reel\nC:Trad.\nK:D\nV:1\nF A d\nV:2\nD,2"));
+    ASSERT(store_add_tune(&store, &b, "T:Jig\nC:Trad.\nK:G\nV:1\n[GBd] c B"));
+    ASSERT_EQ(store.entry_count, 2);
+
+    // "Trad." and voice "1" are interned once
+    const AbcStoreEntry *ea = abc_store_entry(&store, a);
+    const AbcStoreEntry *eb = abc_store_entry(&store, b);
+    ASSERT(ea && eb);
+    ASSERT_EQ(ea->composer, eb->composer);
+    ASSERT_EQ(store.string_count, 7);  // Reel, Trad., D, 1, 2, Jig, G
+
+    NotePool pools[TEST_MAX_VOICES];
+    struct sheet view;
+    ASSERT_EQ(abc_store_view(&store, a, &view, pools, TEST_MAX_VOICES), 0);
+    ASSERT(strcmp(view.title, "Reel") == 0);
+    ASSERT(strcmp(view.composer, "Trad.") == 0);
+    ASSERT_EQ(view.voice_count, 2);
+    ASSERT(strcmp(pools[1].voice_id, "2") == 0);
+    ASSERT_EQ(pools[0].count, 3);
+    ASSERT_EQ(pools[0].capacity, 0);
+    struct note *n = pool_first_note(&pools[0]);
+    ASSERT_EQ(n->midi_note[0], 66);  // F# in D major
+    n = note_next(&pools[0], note_next(&pools[0], n));
+    ASSERT_EQ(n->midi_note[0], 74);
+    ASSERT(note_next(&pools[0], n) == NULL);
+
+    ASSERT_EQ(abc_store_view(&store, b, &view, pools, TEST_MAX_VOICES), 0);
+    ASSERT_EQ(pool_first_note(&pools[0])->chord_size, 3);
+
+    // A shared string at its reference limit fails the add instead of wrapping
+    AbcStoreHandle c;
+    uint16_t title_id = ea->title;
+    store.strings[eb->composer - 1].refs = UINT16_MAX;
+    ASSERT(!store_add_tune(&store, &c, "T:Reel\nC:Trad.\nK:A\nA"));
+    ASSERT_EQ(store.strings[eb->composer - 1].refs, UINT16_MAX);
+    ASSERT_EQ(store.strings[title_id - 1].refs, 1);      // Rolled back
+    ASSERT_EQ(store.entry_count, 2);
+    return 1;
+}
+
+TEST(store_remove_and_compact) {
+    AbcStore store;
+    ASSERT_EQ(abc_store_init(&store, g_store_heap, sizeof(g_store_heap), g_store_entries, 16, g_store_strings, 32), 0);
+
+    AbcStoreHandle h[3];
+    ASSERT(store_add_tune(&store, &h[0], "T:One\nK:C\nC D E F G A B c"));
+    ASSERT(store_add_tune(&store, &h[1], "T:Two\nK:C\nc B A G F E D C"));
+    ASSERT(store_add_tune(&store, &h[2], "T:Three\nK:C\nC E G c"));
+    uint32_t used = store.heap_used;
+
+    ASSERT_EQ(abc_store_remove(&store, h[1]), 0);
+    ASSERT_EQ(abc_store_remove(&store, h[1]), -1);  // Stale handle
+    ASSERT(abc_store_entry(&store, h[1]) == NULL);
+    ASSERT(store.heap_live < used);
+
+    abc_store_compact(&store);
+    ASSERT_EQ(store.heap_used, store.heap_live);
+
+    // Survivors are intact after their blocks moved
+    NotePool pools[TEST_MAX_VOICES];
+    struct sheet view;
+    ASSERT_EQ(abc_store_view(&store, h[2], &view, pools, TEST_MAX_VOICES), 0);
+    ASSERT(strcmp(view.title, "Three") == 0);
+    ASSERT_EQ(pools[0].count, 4);
+    ASSERT_EQ(note_get(&pools[0], 3)->midi_note[0], 72);
+
+    // Iteration visits live sheets only
+    int live = 0;
+    for (AbcStoreHandle it = abc_store_next(&store, ABC_STORE_INVALID); it; it = abc_store_next(&store, it)) live++;
+    ASSERT_EQ(live, 2);
+    return 1;
+}
+
+TEST(store_compacts_when_full) {
+    static uint8_t heap[512];
+    AbcStore store;
+    ASSERT_EQ(abc_store_init(&store, heap, sizeof(heap), g_store_entries, 16, g_store_strings, 32), 0);
+
+    // Fill with evict-and-add; holes are reclaimed automatically
+    AbcStoreHandle prev = ABC_STORE_INVALID;
+    for (int i = 0; i < 20; i++) {
+        AbcStoreHandle h;
+        ASSERT(store_add_tune(&store, &h, "T:Loop\nK:C\nC D E F G A B c d e f g"));
+        if (prev) ASSERT_EQ(abc_store_remove(&store, prev), 0);
+        prev = h;
+    }
+    ASSERT_EQ(store.entry_count, 1);
+    ASSERT(store.heap_used <= sizeof(heap));
+    return 1;
+}
+
+// ============================================================================
+// Parse Cache Tests
+// ============================================================================
+
+static AbcCacheEntry g_cache_entries[8];
+
+static int g_lock_depth = 0;
+static int g_lock_calls = 0;
+static void test_lock(void *ctx) { (void)ctx; g_lock_depth++; g_lock_calls++; }
+static void test_unlock(void *ctx) { (void)ctx; g_lock_depth--; }
+
+TEST(cache_hit_copies_result) {
+    AbcStore store;
+    AbcCache cache;
+    abc_store_init(&store, g_store_heap, sizeof(g_store_heap), g_store_entries, 16, g_store_strings, 32);
+    AbcCacheLock lock = { test_lock, test_unlock, NULL };
+    g_lock_calls = 0;
+    ASSERT_EQ(abc_cache_init(&cache, &store, g_cache_entries, 8, 0, &lock), 0);
+
+    const char *tune = "T:Cached\nK:D\nV:1\nF A [df]\nV:2\nD,4";
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, tune), 0);
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, tune), 0);
+
+    AbcCacheStats stats;
+    abc_cache_stats(&cache, &stats);
+    ASSERT_EQ(stats.misses, 1);
+    ASSERT_EQ(stats.hits, 1);
+    ASSERT_EQ(stats.entries, 1);
+    ASSERT(stats.bytes > 0);
+    ASSERT(g_lock_calls > 0);
+    ASSERT_EQ(g_lock_depth, 0);
+
+    // The copy is writable and matches a direct parse
+    ASSERT(strcmp(g_sheet.title, "Cached") == 0);
+    ASSERT_EQ(g_sheet.voice_count, 2);
+    ASSERT_EQ(g_pools[0].count, 3);
+    ASSERT_EQ(g_pools[0].capacity, TEST_MAX_NOTES);
+    ASSERT_EQ(pool_first_note(&g_pools[0])->midi_note[0], 66);
+    ASSERT_EQ(note_get(&g_pools[0], 2)->chord_size, 2);
+    ASSERT_EQ(g_pools[1].total_ticks, 96);
+
+    // A different tune (or different options) is a separate entry
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, "K:C\nC D E"), 0);
+    ASSERT_EQ(NOTE_COUNT(), 3);
+    abc_cache_stats(&cache, &stats);
+    ASSERT_EQ(stats.misses, 2);
+    ASSERT_EQ(stats.entries, 2);
+    return 1;
+}
+
+TEST(cache_evicts_lru_under_budget) {
+    AbcStore store;
+    AbcCache cache;
+    abc_store_init(&store, g_store_heap, sizeof(g_store_heap), g_store_entries, 16, g_store_strings, 32);
+
+    // Measure one entry, then allow room for two
+    ASSERT_EQ(abc_cache_init(&cache, &store, g_cache_entries, 8, 0, NULL), 0);
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, "K:C\nC D E F"), 0);
+    uint32_t one = cache.bytes;
+    abc_cache_clear(&cache);
+    ASSERT_EQ(cache.count, 0);
+    ASSERT_EQ(abc_cache_init(&cache, &store, g_cache_entries, 8, one * 2 + one / 2, NULL), 0);
+
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, "K:C\nC D E F"), 0);
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, "K:C\nG A B c"), 0);
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, "K:C\nC D E F"), 0);  // Touch: now most recent
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, "K:C\nc B A G"), 0);  // Evicts "G A B c"
+
+    AbcCacheStats stats;
+    abc_cache_stats(&cache, &stats);
+    ASSERT_EQ(stats.evictions, 1);
+    ASSERT_EQ(stats.entries, 2);
+    ASSERT(stats.bytes <= one * 2 + one / 2);
+
+    NotePool pools[TEST_MAX_VOICES];
+    struct sheet view;
+    int32_t token = abc_cache_acquire(&cache, "K:C\nC D E F", ABC_MAX_CHORD_NOTES, &view, pools, TEST_MAX_VOICES);
+    ASSERT(token > 0);
+    abc_cache_release(&cache, token);
+    ASSERT_EQ(abc_cache_acquire(&cache, "K:C\nG A B c", ABC_MAX_CHORD_NOTES, &view, pools, TEST_MAX_VOICES), -1);
+    return 1;
+}
+
+TEST(cache_acquire_pins_entry) {
+    AbcStore store;
+    AbcCache cache;
+    abc_store_init(&store, g_store_heap, sizeof(g_store_heap), g_store_entries, 16, g_store_strings, 32);
+    ASSERT_EQ(abc_cache_init(&cache, &store, g_cache_entries, 8, 0, NULL), 0);
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, "T:Pinned\nK:G\nG B d"), 0);
+
+    NotePool pools[TEST_MAX_VOICES];
+    struct sheet view;
+    int32_t token = abc_cache_acquire(&cache, "T:Pinned\nK:G\nG B d", ABC_MAX_CHORD_NOTES, &view, pools, TEST_MAX_VOICES);
+    ASSERT(token > 0);
+    ASSERT_EQ(pools[0].capacity, 0);
+    ASSERT(strcmp(view.title, "Pinned") == 0);
+    ASSERT_EQ(store.compact_locks, 1);
+
+    // Pinned entries survive clearing; released ones do not
+    abc_cache_clear(&cache);
+    ASSERT_EQ(cache.count, 1);
+    ASSERT_EQ(note_get(&pools[0], 2)->midi_note[0], 74);
+    abc_cache_release(&cache, token);
+    ASSERT_EQ(store.compact_locks, 0);
+    abc_cache_clear(&cache);
+    ASSERT_EQ(cache.count, 0);
+    ASSERT_EQ(store.entry_count, 0);
+    return 1;
+}
+
+TEST(cache_compares_input_text) {
+    AbcStore store;
+    AbcCache cache;
+    abc_store_init(&store, g_store_heap, sizeof(g_store_heap), g_store_entries, 16, g_store_strings, 32);
+    ASSERT_EQ(abc_cache_init(&cache, &store, g_cache_entries, 8, 0, NULL), 0);
+    const char *a = "K:C\nC D E F";
+    const char *b = "K:C\nG A B c";
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, a), 0);
+
+    // Forge a collision: re-key a's entry under b's hash (same length)
+    uint64_t hash = abc_hash64(b, (uint32_t)strlen(b), ((uint64_t)g_sheet.pool_count << 8) | ABC_MAX_CHORD_NOTES);
+    uint16_t slot = cache.lru_head;
+    for (uint16_t i = 0; i < 8; i++) g_cache_entries[i].bucket = 0xFFFF;
+    g_cache_entries[slot].hash = hash;
+    g_cache_entries[hash & 7].bucket = slot;
+
+    // The text differs, so b misses and parses to its own notes
+    NotePool pools[TEST_MAX_VOICES];
+    struct sheet view;
+    ASSERT_EQ(abc_cache_acquire(&cache, b, ABC_MAX_CHORD_NOTES, &view, pools, TEST_MAX_VOICES), -1);
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, b), 0);
+    ASSERT_EQ(pool_first_note(&g_pools[0])->midi_note[0], 67);
+    AbcCacheStats stats;
+    abc_cache_stats(&cache, &stats);
+    ASSERT_EQ(stats.hits, 0);
+    ASSERT_EQ(stats.entries, 2);
+
+    // Entries hold their text until dropped
+    ASSERT_EQ(abc_cache_parse(&cache, &g_sheet, b), 0);
+    abc_cache_stats(&cache, &stats);
+    ASSERT_EQ(stats.hits, 1);
+    abc_cache_clear(&cache);
+    ASSERT_EQ(store.string_count, 0);
+    return 1;
+}
+
+// ============================================================================
+// Incremental Editing Tests
+// ============================================================================
+
+static NotePool g_ref_pools[TEST_MAX_VOICES];
+static struct note g_ref_storage[TEST_MAX_VOICES][TEST_MAX_NOTES];
+static AbcCheckpoint g_checkpoints[16];
+static char g_edit_text[1024];
+
+// Editor result must equal a fresh parse of the edited text
+static int editor_matches_parse(const AbcEditor *ed) {
+    struct sheet ref;
+    for (int i = 0; i < TEST_MAX_VOICES; i++) {
+        note_pool_init(&g_ref_pools[i], g_ref_storage[i], TEST_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    sheet_init(&ref, g_ref_pools, TEST_MAX_VOICES);
+    if (abc_parse(&ref, ed->text) != 0) return 0;
+    if (ref.voice_count != ed->sheet->voice_count || strcmp(ref.title, ed->sheet->title) != 0) return 0;
+
+    for (uint8_t v = 0; v < ref.voice_count; v++) {
+        const NotePool *a = &ed->sheet->pools[v], *b = &ref.pools[v];
+        if (strcmp(a->voice_id, b->voice_id) != 0 || a->total_ticks != b->total_ticks) return 0;
+        struct note *na = pool_first_note(a), *nb = pool_first_note(b), *last = NULL;
+        while (na && nb) {
+            if (na->duration != nb->duration || na->chord_size != nb->chord_size ||
+                memcmp(na->midi_note, nb->midi_note, nb->chord_size) != 0) return 0;
+            last = na;
+            na = note_next(a, na);
+            nb = note_next(b, nb);
+        }
+        if (na || nb || last != note_get(a, a->tail_index)) return 0;
+    }
+    return 1;
+}
+
+static uint32_t g_edit_rng = 12345;
+static uint32_t edit_rand(uint32_t n) {
+    g_edit_rng = g_edit_rng * 1103515245u + 12345u;
+    return (g_edit_rng >> 16) % n;
+}
+
+TEST(editor_edit_matches_full_parse) {
+    static const char *tokens[] = { "C", "^F", "=f", "_B,", "z2", "d/", "[CEG]", "(3", "|", "|:", ":|",
+                                    ":|:", " ", "\n", "\"Am\"", "A3/2", "V:2\n" };
+    strcpy(g_edit_text, "X:1\nT:Edit\nM:4/4\nL:1/8\nK:D\nV:1\n"
+                        "|: F A d f | e d B A :| (3ABc d2 z2 |\n"
+                        "f2 ^g a b | a4 z4 |\n"
+                        "V:2\nD,4 A,4 | [DF]2 [EG]2 |: G B :| d4 |\n");
+    AbcEditor ed;
+    ASSERT_EQ(abc_editor_init(&ed, &g_sheet, g_edit_text, sizeof(g_edit_text), g_checkpoints, 16), 0);
+    ASSERT(editor_matches_parse(&ed));
+
+    // Pseudo-random insertions, deletions and replacements anywhere in the body
+    int partial = 0;
+    for (int i = 0; i < 400; i++) {
+        char repl[32] = "";
+        uint32_t parts = edit_rand(3);
+        for (uint32_t k = 0; k < parts; k++) strcat(repl, tokens[edit_rand(sizeof(tokens) / sizeof(tokens[0]))]);
+        uint16_t start = (uint16_t)(ed.body_start + edit_rand(ed.text_len - ed.body_start + 1u));
+        uint16_t end = (uint16_t)(start + edit_rand(6));
+        if (end > ed.text_len) end = ed.text_len;
+        if (ed.text_len - (end - start) + strlen(repl) > 600) end = ed.text_len;  // Keep the tune bounded
+
+        ASSERT_EQ(abc_editor_edit(&ed, start, end, repl, (uint16_t)strlen(repl)), 0);
+        if (!editor_matches_parse(&ed)) {
+            printf("mismatch after edit %d ", i);
+            return 0;
+        }
+        partial += !ed.last_full;
+    }
+    ASSERT(partial > 200);
+    return 1;
+}
+
+TEST(editor_reparses_locally) {
+    // Sixteen lines of bars; change one note in the middle
+    strcpy(g_edit_text, "T:Long\nK:G\nL:1/8\n");
+    for (int i = 0; i < 16; i++) strcat(g_edit_text, "G A B c | d e f g | g f e d | c B A G |\n");
+    AbcEditor ed;
+    ASSERT_EQ(abc_editor_init(&ed, &g_sheet, g_edit_text, sizeof(g_edit_text), g_checkpoints, 16), 0);
+    ASSERT(ed.checkpoint_count <= 16);
+
+    char *at = strstr(g_edit_text + 300, "d e f g");
+    ASSERT(at != NULL);
+    uint16_t pos = (uint16_t)(at - g_edit_text);
+    ASSERT_EQ(abc_editor_edit(&ed, pos, (uint16_t)(pos + 1), "^d2", 3), 0);
+    ASSERT_EQ(ed.last_full, 0);
+    ASSERT(ed.last_reparsed < ed.text_len / 4);
+    ASSERT(editor_matches_parse(&ed));
+
+    // Accidentals carry to the end of the bar, then the parse converges
+    ASSERT_EQ(abc_editor_edit(&ed, pos, (uint16_t)(pos + 3), "^e", 2), 0);
+    ASSERT_EQ(ed.last_full, 0);
+    ASSERT(editor_matches_parse(&ed));
+    return 1;
+}
+
+TEST(editor_falls_back_to_full_parse) {
+    strcpy(g_edit_text, "T:Voices\nK:C\nV:1\nC D E F |\nV:2\nC, D, E, F, |\n");
+    AbcEditor ed;
+    ASSERT_EQ(abc_editor_init(&ed, &g_sheet, g_edit_text, sizeof(g_edit_text), g_checkpoints, 16), 0);
+
+    // Header edit: new key changes every note
+    ASSERT_EQ(abc_editor_edit(&ed, 11, 12, "D", 1), 0);
+    ASSERT_EQ(ed.last_full, 1);
+    ASSERT(editor_matches_parse(&ed));
+    ASSERT_EQ(note_get(&g_pools[0], 0)->midi_note[0], 61);  // C# in D major
+
+    // Renaming a voice to an existing one merges them
+    char *v2 = strstr(g_edit_text, "V:2");
+    ASSERT_EQ(abc_editor_edit(&ed, (uint16_t)(v2 - g_edit_text), (uint16_t)(v2 - g_edit_text + 3), "V:1", 3), 0);
+    ASSERT_EQ(g_sheet.voice_count, 1);
+    ASSERT(editor_matches_parse(&ed));
+
+    // A new voice renumbers pools
+    ASSERT_EQ(abc_editor_edit(&ed, (uint16_t)(v2 - g_edit_text), (uint16_t)(v2 - g_edit_text + 3), "V:3", 3), 0);
+    ASSERT_EQ(ed.last_full, 1);
+    ASSERT_EQ(g_sheet.voice_count, 2);
+    ASSERT(editor_matches_parse(&ed));
+
+    // Invalid ranges and oversized text are rejected
+    ASSERT_EQ(abc_editor_edit(&ed, 5, 4, "", 0), -1);
+    ASSERT_EQ(abc_editor_edit(&ed, 0, (uint16_t)(ed.text_len + 1), "", 0), -1);
+    return 1;
+}
+
+// ============================================================================
+// Event Mode Tests
+// ============================================================================
+
+// Records events as a compact log: notes as MIDI/duration, bars and voices as markers
+typedef struct {
+    uint8_t midi[64];
+    uint8_t duration[64];
+    uint8_t voice[64];
+    uint8_t chord_size[64];
+    int notes;
+    AbcBarType bars[32];
+    int bar_count;
+    char voices[64];
+    char title[32];
+    int stop_after;             // Stop once this many notes were seen (0 = never)
+} EventLog;
+
+static int log_header(void *user, char field, const char *value, uint8_t len) {
+    EventLog *log = (EventLog *)user;
+    if (field == 'T' && len < sizeof(log->title)) {
+        memcpy(log->title, value, len);
+        log->title[len] = '\0';
+    }
+    return 0;
+}
+
+static int log_voice(void *user, uint8_t voice, const char *id) {
+    EventLog *log = (EventLog *)user;
+    (void)voice;
+    strncat(log->voices, id, sizeof(log->voices) - strlen(log->voices) - 2);
+    strcat(log->voices, ",");
+    return 0;
+}
+
+static int log_bar(void *user, AbcBarType type) {
+    EventLog *log = (EventLog *)user;
+    if (log->bar_count < 32) log->bars[log->bar_count++] = type;
+    return 0;
+}
+
+static int log_note(void *user, uint8_t voice, const uint8_t *midi, uint8_t chord_size, uint8_t duration) {
+    EventLog *log = (EventLog *)user;
+    if (log->notes < 64) {
+        log->midi[log->notes] = midi[0];
+        log->duration[log->notes] = duration;
+        log->voice[log->notes] = voice;
+        log->chord_size[log->notes] = chord_size;
+        log->notes++;
+    }
+    return log->stop_after > 0 && log->notes >= log->stop_after;
+}
+
+static const AbcEventCallbacks g_log_callbacks = { log_header, log_voice, log_bar, log_note };
+
+TEST(events_resolve_pitches) {
+    static EventLog log;
+    memset(&log, 0, sizeof(log));
+    ASSERT_EQ(abc_parse_events("T:Events\nL:1/8\nK:D\nF ^c c =F | F [CEG]2 z/ ||", &g_log_callbacks, &log), 0);
+
+    ASSERT(strcmp(log.title, "Events") == 0);
+    ASSERT(strcmp(log.voices, "default,") == 0);
+    ASSERT_EQ(log.notes, 7);
+    ASSERT_EQ(log.midi[0], 66);        // F# from the key
+    ASSERT_EQ(log.midi[1], 73);        // ^c
+    ASSERT_EQ(log.midi[2], 73);        // Bar accidental carries
+    ASSERT_EQ(log.midi[3], 65);        // =F
+    ASSERT_EQ(log.midi[4], 66);        // Bar line resets to the key
+    ASSERT_EQ(log.chord_size[5], 3);
+    ASSERT_EQ(log.midi[5], 61);        // C# from the key
+    ASSERT_EQ(log.duration[5], 48);
+    ASSERT_EQ(log.midi[6], 0);         // Rest
+    ASSERT_EQ(log.duration[6], 12);
+    ASSERT_EQ(log.bar_count, 2);
+    ASSERT_EQ(log.bars[0], ABC_BAR_SINGLE);
+    ASSERT_EQ(log.bars[1], ABC_BAR_DOUBLE);
+    return 1;
+}
+
+TEST(events_match_parse) {
+    const char *music = "L:1/4\nK:Bb\nV:S\n(3BcB A2 | [B,DF] e/f/ |]\nV:A\nD,2 _G, | z4\nV:S\nB4";
+    static EventLog log;
+    memset(&log, 0, sizeof(log));
+    ASSERT_EQ(abc_parse_events(music, &g_log_callbacks, &log), 0);
+    ASSERT_EQ(abc_parse(&g_sheet, music), 0);
+    ASSERT(strcmp(log.voices, "S,A,S,") == 0);
+
+    // Without repeats every note comes out exactly as stored, voice by voice
+    struct note *next[2] = { pool_first_note(&g_pools[0]), pool_first_note(&g_pools[1]) };
+    for (int i = 0; i < log.notes; i++) {
+        uint8_t v = log.voice[i];
+        ASSERT(next[v] != NULL);
+        ASSERT_EQ(log.midi[i], next[v]->midi_note[0]);
+        ASSERT_EQ(log.duration[i], next[v]->duration);
+        ASSERT_EQ(log.chord_size[i], next[v]->chord_size);
+        next[v] = note_next(&g_pools[v], next[v]);
+    }
+    ASSERT(next[0] == NULL && next[1] == NULL);
+    return 1;
+}
+
+TEST(events_report_repeats) {
+    static EventLog log;
+    memset(&log, 0, sizeof(log));
+    ASSERT_EQ(abc_parse_events("K:C\n|: C D :| E |: F :|: G :|", &g_log_callbacks, &log), 0);
+    ASSERT_EQ(log.notes, 5);           // Not unfolded
+    ASSERT_EQ(log.bar_count, 5);
+    ASSERT_EQ(log.bars[0], ABC_BAR_REPEAT_START);
+    ASSERT_EQ(log.bars[1], ABC_BAR_REPEAT_END);
+    ASSERT_EQ(log.bars[2], ABC_BAR_REPEAT_START);
+    ASSERT_EQ(log.bars[3], ABC_BAR_REPEAT_END_START);
+    ASSERT_EQ(log.bars[4], ABC_BAR_REPEAT_END);
+
+    // A callback can stop the parse early
+    memset(&log, 0, sizeof(log));
+    log.stop_after = 2;
+    ASSERT_EQ(abc_parse_events("K:C\nC D E F", &g_log_callbacks, &log), -3);
+    ASSERT_EQ(log.notes, 2);
+    ASSERT_EQ(abc_parse_events(NULL, &g_log_callbacks, &log), -1);
+    ASSERT_EQ(abc_parse_events("C", NULL, &log), -1);
+    return 1;
+}
+
+// ============================================================================
+// Cursor Tests
+// ============================================================================
+
+// Every voice read through a cursor must equal the pools abc_parse() fills
+static int cursor_matches_parse(const char *music) {
+    if (abc_parse(&g_sheet, music) != 0) return 0;
+    for (uint8_t v = 0; v < g_sheet.voice_count; v++) {
+        AbcCursor cursor;
+        struct note n;
+        if (abc_cursor_init(&cursor, music, v) != 0) return 0;
+        struct note *expect = pool_first_note(&g_pools[v]);
+        while (abc_cursor_next(&cursor, &n) == 1) {
+            if (!expect || n.duration != expect->duration || n.chord_size != expect->chord_size ||
+                memcmp(n.midi_note, expect->midi_note, n.chord_size) != 0) return 0;
+            expect = note_next(&g_pools[v], expect);
+        }
+        if (expect) return 0;
+    }
+    sheet_reset(&g_sheet);
+    return 1;
+}
+
+TEST(cursor_matches_parse) {
+    ASSERT(cursor_matches_parse("K:D\nF ^c c =F | F [CEG]2 z/ (3ABc d2"));
+    ASSERT(cursor_matches_parse("K:G\n|: F ^G A B :| c d |: e (3fga :|: b2 :| g"));
+    ASSERT(cursor_matches_parse("L:1/4\nK:Bb\nV:S\n|: B c :| d\nV:A\nD, |: E, F, :|\nV:S\ne f"));
+    ASSERT(cursor_matches_parse("K:C\nV:1\n|: C D V:2 E, F, V:1 G :| A"));
+    return 1;
+}
+
+TEST(cursor_parses_on_demand) {
+    static char music[2048];
+    strcpy(music, "T:Long\nK:C\n");
+    for (int i = 0; i < 64; i++) strcat(music, "C D E F | G A B c |\n");
+
+    AbcCursor cursor;
+    struct note n;
+    ASSERT_EQ(abc_cursor_init(&cursor, music, 0), 0);
+    ASSERT_EQ(abc_cursor_next(&cursor, &n), 1);
+    ASSERT_EQ(n.midi_note[0], 60);
+    ASSERT_EQ(n.next_index, -1);
+    ASSERT(cursor.state.pos < 20);     // Only the header and the first note read
+
+    int notes = 1;
+    while (abc_cursor_next(&cursor, &n) == 1) notes++;
+    ASSERT_EQ(notes, 512);
+    ASSERT_EQ(abc_cursor_next(&cursor, &n), 0);  // Stays at the end
+    return 1;
+}
+
+TEST(cursor_invalid_and_missing_voice) {
+    AbcCursor cursor;
+    struct note n;
+    ASSERT_EQ(abc_cursor_init(NULL, "C", 0), -1);
+    ASSERT_EQ(abc_cursor_init(&cursor, NULL, 0), -1);
+    ASSERT_EQ(abc_cursor_init(&cursor, "Q:1/4=90\nK:C\nV:1\nC D", 1), 0);
+    ASSERT_EQ(cursor.tempo_bpm, 90);
+    ASSERT_EQ(abc_cursor_next(&cursor, &n), 0);  // No second voice
+    ASSERT_EQ(abc_cursor_next(&cursor, NULL), -1);
+    return 1;
+}
+
+// ============================================================================
+// Step Parsing Tests
+// ============================================================================
+
+static NotePool g_step_pools[TEST_MAX_VOICES];
+static struct note g_step_storage[TEST_MAX_VOICES][TEST_MAX_NOTES];
+
+// Parse in steps of `budget` units into the step pools; returns the step count
+static int parse_in_steps(struct sheet *sheet, const char *music, uint16_t budget, int *result) {
+    for (int i = 0; i < TEST_MAX_VOICES; i++) {
+        note_pool_init(&g_step_pools[i], g_step_storage[i], TEST_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    sheet_init(sheet, g_step_pools, TEST_MAX_VOICES);
+
+    AbcStepParser parser;
+    if (abc_parse_begin(&parser, sheet, music) != 0) {
+        *result = -1;
+        return -1;
+    }
+    int steps = 0;
+    do {
+        *result = abc_parse_step(&parser, budget);
+        steps++;
+    } while (*result == ABC_PARSE_IN_PROGRESS);
+    return steps;
+}
+
+TEST(step_matches_parse) {
+    const char *music = "X:1\nT:Steps\nM:3/4\nL:1/8\nK:Bb\n"
+                        "V:1\n|: B c \"Gm7\" d2 (3efg :|: [B,DF] e/f/ :| ^A4 |]\n"
+                        "V:2\nD,2 _G, | z4 |: C, :|\nV:1\nB6 ||";
+    ASSERT_EQ(abc_parse(&g_sheet, music), 0);
+
+    static const uint16_t budgets[] = { 1, 2, 5, 16, 1000 };
+    for (int b = 0; b < 5; b++) {
+        struct sheet sheet;
+        int result;
+        int steps = parse_in_steps(&sheet, music, budgets[b], &result);
+        ASSERT_EQ(result, 0);
+        ASSERT(budgets[b] >= strlen(music) ? steps == 1 : steps > 1);
+        ASSERT(strcmp(sheet.title, g_sheet.title) == 0);
+        ASSERT_EQ(sheet.meter_num, 3);
+        ASSERT_EQ(sheet.voice_count, g_sheet.voice_count);
+        for (uint8_t v = 0; v < sheet.voice_count; v++) {
+            ASSERT_EQ(g_step_pools[v].count, g_pools[v].count);
+            ASSERT_EQ(g_step_pools[v].total_ticks, g_pools[v].total_ticks);
+            ASSERT_EQ(g_step_pools[v].tail_index, g_pools[v].tail_index);
+            ASSERT(memcmp(g_step_storage[v], g_note_storage[v], g_pools[v].count * sizeof(struct note)) == 0);
+        }
+    }
+    return 1;
+}
+
+TEST(step_bounds_work) {
+    // A long annotation and a long repeat copy are both spread over steps
+    static char music[1200];
+    strcpy(music, "K:C\n\"");
+    for (int i = 0; i < 300; i++) strcat(music, "x");
+    strcat(music, "\" |:");
+    for (int i = 0; i < 200; i++) strcat(music, "C");
+    strcat(music, ":| D");
+
+    for (int i = 0; i < TEST_MAX_VOICES; i++) {
+        note_pool_init(&g_step_pools[i], g_step_storage[i], TEST_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    struct sheet sheet;
+    sheet_init(&sheet, g_step_pools, TEST_MAX_VOICES);
+    AbcStepParser parser;
+    ASSERT_EQ(abc_parse_begin(&parser, &sheet, music), 0);
+
+    int result, steps = 0;
+    do {
+        uint16_t pos = parser.state.pos;
+        result = abc_parse_step(&parser, 16);
+        steps++;
+        // Units are input bytes plus copied notes; a step may finish one small token
+        ASSERT(parser.state.pos - pos + parser.copied <= 16 + 4);
+    } while (result == ABC_PARSE_IN_PROGRESS);
+    ASSERT_EQ(result, 0);
+    ASSERT_EQ(g_step_pools[0].count, 401);
+    ASSERT(steps >= (300 + 200 + 200) / 16);
+
+    // Long runs inside and between tokens: every step stays within one
+    // capped token of its budget, and the result still matches abc_parse
+    static const struct { const char *prefix, *unit, *suffix; } runs[] = {
+        { "K:C\n", " ", "C" },
+        { "", "\n", "K:C\nC" },
+        { "K:C\n[", "#", "]C" },
+        { "K:C\n[", " ", "C]" },
+        { "T:", "x", "\nK:C\nC" },
+        { "K:C\nV:", "a", " C" },
+        { "K:C\nV:", " ", "1 C" },
+        { "K:C\nC", "'", " D" },
+        { "K:C\n", "^", "C" },
+        { "K:C\nC", "9", " D" },
+        { "K:C\nC/", "3", " D" },
+        { "K:C\nC", "/", " D" },
+    };
+    for (size_t r = 0; r < sizeof(runs) / sizeof(runs[0]); r++) {
+        strcpy(music, runs[r].prefix);
+        size_t len = strlen(music);
+        memset(music + len, runs[r].unit[0], 1000);
+        strcpy(music + len + 1000, runs[r].suffix);
+
+        sheet_reset(&g_sheet);
+        int expected = abc_parse(&g_sheet, music);
+        for (int i = 0; i < TEST_MAX_VOICES; i++) {
+            note_pool_init(&g_step_pools[i], g_step_storage[i], TEST_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+        }
+        sheet_init(&sheet, g_step_pools, TEST_MAX_VOICES);
+        ASSERT_EQ(abc_parse_begin(&parser, &sheet, music), 0);
+        steps = 0;
+        do {
+            uint16_t pos = parser.state.pos;
+            result = abc_parse_step(&parser, 16);
+            steps++;
+            ASSERT(parser.state.pos - pos + parser.copied <= 16 + ABC_STEP_MAX_TOKEN);
+        } while (result == ABC_PARSE_IN_PROGRESS);
+        ASSERT_EQ(result, expected);
+        ASSERT(steps >= 1000 / (16 + ABC_STEP_MAX_TOKEN));
+        ASSERT_EQ(sheet.voice_count, g_sheet.voice_count);
+        for (uint8_t v = 0; v < sheet.voice_count; v++) {
+            ASSERT_EQ(g_step_pools[v].count, g_pools[v].count);
+            ASSERT_EQ(g_step_pools[v].total_ticks, g_pools[v].total_ticks);
+        }
+    }
+    return 1;
+}
+
+TEST(step_errors) {
+    struct note storage[4];
+    NotePool pool;
+    struct sheet sheet;
+    note_pool_init(&pool, storage, 4, 1);
+    sheet_init(&sheet, &pool, 1);
+
+    AbcStepParser parser;
+    ASSERT_EQ(abc_parse_begin(NULL, &sheet, "C"), -1);
+    ASSERT_EQ(abc_parse_begin(&parser, &sheet, NULL), -1);
+    ASSERT_EQ(abc_parse_step(NULL, 8), -1);
+
+    // Pool exhaustion ends the parse with abc_parse()'s code, and stays ended
+    ASSERT_EQ(abc_parse_begin(&parser, &sheet, "K:C\n|: C D E :|"), 0);
+    int result;
+    do { result = abc_parse_step(&parser, 2); } while (result == ABC_PARSE_IN_PROGRESS);
+    ASSERT_EQ(result, -2);
+    ASSERT_EQ(abc_parse_step(&parser, 2), -2);
+    return 1;
+}
+
+// ============================================================================
+// Publication Tests
+// ============================================================================
+
+TEST(reader_follows_step_parse) {
+    // Interleave a reader with a step parse, as a playback core would see it
+    const char *music = "K:G\nV:1\n|: G A B c :| d2 [GBd]2 |\nV:2\nG,4 |: D,2 :|\nV:1\ne f g a";
+    static struct note read[2][64];
+    int got[2] = { 0, 0 }, finished[2] = { 0, 0 }, waited = 0;
+
+    AbcPublication pub;
+    sheet_set_publication(&g_sheet, &pub);
+    AbcStepParser parser;
+    ASSERT_EQ(abc_parse_begin(&parser, &g_sheet, music), 0);
+    AbcReader readers[2];
+    abc_reader_init(&readers[0], &g_sheet, 0);
+    abc_reader_init(&readers[1], &g_sheet, 1);
+
+    int result = ABC_PARSE_IN_PROGRESS;
+    while (!finished[0] || !finished[1]) {
+        if (result == ABC_PARSE_IN_PROGRESS) result = abc_parse_step(&parser, 6);
+        for (int v = 0; v < 2; v++) {
+            int r;
+            while ((r = abc_reader_next(&readers[v], &read[v][got[v]])) == 1) got[v]++;
+            if (r == 0) waited++;
+            if (r < 0) finished[v] = 1;
+        }
+    }
+    ASSERT_EQ(result, 0);
+    ASSERT(waited > 2);                // Readers caught up with the parser along the way
+    ASSERT_EQ(pub.done, 1);
+    ASSERT_EQ(pub.result, 0);
+
+    for (int v = 0; v < 2; v++) {
+        ASSERT_EQ(got[v], g_pools[v].count);
+        struct note *n = pool_first_note(&g_pools[v]);
+        for (int i = 0; i < got[v]; i++, n = note_next(&g_pools[v], n)) {
+            ASSERT_EQ(read[v][i].duration, n->duration);
+            ASSERT_EQ(read[v][i].chord_size, n->chord_size);
+            ASSERT(memcmp(read[v][i].midi_note, n->midi_note, n->chord_size) == 0);
+            ASSERT_EQ(read[v][i].next_index, -1);
+        }
+    }
+    sheet_set_publication(&g_sheet, NULL);
+    return 1;
+}
+
+TEST(reader_after_full_parse) {
+    AbcPublication pub;
+    sheet_set_publication(&g_sheet, &pub);
+    AbcReader reader;
+    struct note n;
+    abc_reader_init(&reader, &g_sheet, 0);
+    ASSERT_EQ(abc_reader_next(&reader, &n), 0);  // Nothing parsed yet
+
+    ASSERT_EQ(abc_parse(&g_sheet, "K:C\nC D E"), 0);
+    ASSERT_EQ(pub.voice_count, 1);
+    ASSERT_EQ(pub.count[0], 3);
+    int notes = 0;
+    while (abc_reader_next(&reader, &n) == 1) notes++;
+    ASSERT_EQ(notes, 3);
+    ASSERT_EQ(abc_reader_next(&reader, &n), -1);
+    sheet_set_publication(&g_sheet, NULL);
+    return 1;
+}
+
+TEST(publication_rejects_movable_pools) {
+    static struct note storage[8];
+    NotePool pool;
+    struct sheet sheet;
+    AbcPublication pub;
+    AbcArena arena;
+    static uint8_t arena_mem[256];
+    abc_arena_init(&arena, arena_mem, sizeof(arena_mem));
+    note_pool_init(&pool, storage, 8, 1);
+    note_pool_set_allocator(&pool, &arena.allocator);
+    sheet_init(&sheet, &pool, 1);
+
+    // A growing pool could move its notes under the reader
+    sheet_set_publication(&sheet, &pub);
+    ASSERT_EQ(abc_parse(&sheet, "C"), -1);
+    sheet_set_publication(&sheet, NULL);
+    ASSERT_EQ(abc_parse(&sheet, "C"), 0);
+    return 1;
+}
+
+// ============================================================================
+// Sequencer Tests
+// ============================================================================
+
+typedef struct {
+    int count;
+    uint8_t on[32], voice[32], midi[32];
+    uint32_t time[32];
+} SeqLog;
+
+static void seq_log(SeqLog *log, int on, uint8_t voice, uint8_t midi, uint32_t time) {
+    if (log->count >= 32) return;
+    log->on[log->count] = (uint8_t)on;
+    log->voice[log->count] = voice;
+    log->midi[log->count] = midi;
+    log->time[log->count] = time;
+    log->count++;
+}
+
+static void seq_on(void *user, uint8_t voice, uint8_t midi, uint32_t time) {
+    seq_log((SeqLog *)user, 1, voice, midi, time);
+}
+
+static void seq_off(void *user, uint8_t voice, uint8_t midi, uint32_t time) {
+    seq_log((SeqLog *)user, 0, voice, midi, time);
+}
+
+static AbcSequencerConfig seq_config(SeqLog *log, uint32_t lookahead, uint8_t loop) {
+    AbcSequencerConfig config = { 1000, lookahead, 0, loop, { seq_on, seq_off }, log };
+    memset(log, 0, sizeof(*log));
+    return config;
+}
+
+TEST(sequencer_fires_events_in_order) {
+    // Quarter = 500 ms; offs fire before ons at the same time, rests are silent
+    ASSERT_EQ(abc_parse(&g_sheet, "L:1/4\nQ:1/4=120\nK:C\nV:1\nC D z [CE]\nV:2\nG,2 G,2"), 0);
+    SeqLog log;
+    AbcSequencerConfig config = seq_config(&log, 0, 0);
+    AbcSequencer seq;
+    ASSERT_EQ(abc_sequencer_init(&seq, &g_sheet, &config), 0);
+    for (uint32_t t = 0; t <= 2000; t += 100) abc_sequencer_advance(&seq, 7000 + t);  // Origin from first call
+
+    static const uint8_t on[] =    { 1,  1,  0,  1,  0,  0,  1,  1,  1,  0,  0,  0 };
+    static const uint8_t voice[] = { 0,  1,  0,  0,  0,  1,  1,  0,  0,  0,  0,  1 };
+    static const uint8_t midi[] =  { 60, 55, 60, 62, 62, 55, 55, 60, 64, 60, 64, 55 };
+    static const uint16_t ms[] =   { 0,  0,  500, 500, 1000, 1000, 1000, 1500, 1500, 2000, 2000, 2000 };
+    ASSERT_EQ(log.count, 12);
+    for (int i = 0; i < 12; i++) {
+        ASSERT_EQ(log.on[i], on[i]);
+        ASSERT_EQ(log.voice[i], voice[i]);
+        ASSERT_EQ(log.midi[i], midi[i]);
+        ASSERT_EQ(log.time[i], 7000u + ms[i]);
+    }
+    ASSERT(abc_sequencer_finished(&seq));
+    ASSERT_EQ(abc_sequencer_advance(NULL, 0), -1);
+    return 1;
+}
+
+TEST(sequencer_lookahead_and_tempo) {
+    ASSERT_EQ(abc_parse(&g_sheet, "L:1/4\nQ:1/8=240\nK:C\nC D E"), 0);  // Eighth = 240: quarter = 500 ms
+    SeqLog log;
+    AbcSequencerConfig config = seq_config(&log, 300, 0);
+    AbcSequencer seq;
+    ASSERT_EQ(abc_sequencer_init(&seq, &g_sheet, &config), 0);
+
+    ASSERT_EQ(abc_sequencer_advance(&seq, 0), 1);    // C on
+    ASSERT_EQ(abc_sequencer_advance(&seq, 250), 2);  // C off and D on, both due at 500
+    ASSERT_EQ(log.time[1], 500);
+    ASSERT_EQ(log.time[2], 500);
+    ASSERT_EQ(log.midi[2], 62);
+
+    // Double speed from here: E starts 250 ms after the D
+    abc_sequencer_set_tempo_scale(&seq, 2 * ABC_SEQ_SCALE_ONE);
+    ASSERT_EQ(abc_sequencer_advance(&seq, 500), 2);  // D off and E on, due at 625
+    ASSERT_EQ(log.time[3], 625);
+    ASSERT_EQ(log.time[4], 625);
+    ASSERT_EQ(abc_sequencer_position(&seq), ABC_PPQ + ABC_PPQ / 2);
+    return 1;
+}
+
+TEST(sequencer_loop_pause_seek) {
+    ASSERT_EQ(abc_parse(&g_sheet, "L:1/4\nQ:120\nK:C\nC D"), 0);
+    SeqLog log;
+    AbcSequencerConfig config = seq_config(&log, 0, 1);
+    AbcSequencer seq;
+    ASSERT_EQ(abc_sequencer_init(&seq, &g_sheet, &config), 0);
+
+    int ons = 0;
+    for (uint32_t t = 0; t <= 2500; t += 100) abc_sequencer_advance(&seq, t);
+    for (int i = 0; i < log.count; i++) ons += log.on[i];
+    ASSERT_EQ(ons, 6);                               // Looped twice and a half
+    ASSERT_EQ(abc_sequencer_position(&seq), ABC_PPQ);
+    ASSERT(!abc_sequencer_finished(&seq));
+
+    // Pause cuts the D; time spent paused does not count
+    abc_sequencer_advance(&seq, 2600);
+    abc_sequencer_pause(&seq);
+    ASSERT_EQ(log.on[log.count - 1], 0);
+    ASSERT_EQ(log.time[log.count - 1], 2600);
+    ASSERT_EQ(abc_sequencer_advance(&seq, 9000), 0);
+    abc_sequencer_resume(&seq, 9000);
+    abc_sequencer_advance(&seq, 9300);
+    ASSERT_EQ(log.on[log.count - 1], 0);             // Nothing new yet
+    abc_sequencer_advance(&seq, 9400);
+    ASSERT_EQ(log.on[log.count - 1], 1);
+    ASSERT_EQ(log.midi[log.count - 1], 60);
+    ASSERT_EQ(log.time[log.count - 1], 9400);
+
+    // Seek into the D (plus a whole loop): the C stops and the next C starts at the loop
+    int before = log.count;
+    abc_sequencer_seek(&seq, 3 * ABC_PPQ + 10);
+    ASSERT_EQ(log.count, before + 1);
+    ASSERT_EQ(abc_sequencer_advance(&seq, 9400), 0);
+    abc_sequencer_advance(&seq, 9800);
+    ASSERT_EQ(log.count, before + 2);
+    ASSERT_EQ(log.midi[before + 1], 60);
+
+    // Bounded work per call
+    config = seq_config(&log, 0, 0);
+    config.max_events = 1;
+    sheet_reset(&g_sheet);
+    ASSERT_EQ(abc_parse(&g_sheet, "K:C\nV:1\nC\nV:2\nE"), 0);  // Two note-ons at tick 0
+    ASSERT_EQ(abc_sequencer_init(&seq, &g_sheet, &config), 0);
+    ASSERT_EQ(abc_sequencer_advance(&seq, 0), 1);
+    ASSERT_EQ(abc_sequencer_advance(&seq, 0), 1);
+    ASSERT_EQ(abc_sequencer_advance(&seq, 0), 0);
+    return 1;
+}
+
+// ============================================================================
+// Polyphony Tests
+// ============================================================================
+
+static int poly_command_is(const AbcOscStream *stream, int i, uint8_t midi, uint16_t ticks) {
+    return i < stream->count && stream->commands[i].midi == midi && stream->commands[i].ticks == ticks;
+}
+
+TEST(poly_allocates_without_stealing) {
+    ASSERT_EQ(abc_parse(&g_sheet, "L:1/4\nK:C\nV:1\nC D z\nV:2\n[EG]2"), 0);
+    static AbcOscCommand commands[3][8];
+    AbcOscStream streams[3] = { { commands[0], 8, 0 }, { commands[1], 8, 0 }, { commands[2], 8, 0 } };
+    AbcPolyConfig config = { 3, ABC_STEAL_OLDEST, 0, NULL };
+    AbcPolyStats stats;
+    ASSERT_EQ(abc_polyphony_allocate(&g_sheet, &config, streams, &stats), 0);
+
+    ASSERT_EQ(stats.pitches, 4);
+    ASSERT_EQ(stats.stolen + stats.dropped, 0);
+    ASSERT_EQ(stats.total_ticks, 3 * ABC_PPQ);
+    ASSERT_EQ(streams[0].count, 3);
+    ASSERT(poly_command_is(&streams[0], 0, 60, ABC_PPQ));
+    ASSERT(poly_command_is(&streams[0], 1, 62, ABC_PPQ));
+    ASSERT(poly_command_is(&streams[0], 2, 0, ABC_PPQ));   // Rest pads to the end
+    ASSERT_EQ(streams[1].count, 2);
+    ASSERT(poly_command_is(&streams[1], 0, 67, 2 * ABC_PPQ));  // Top of the chord first
+    ASSERT(poly_command_is(&streams[1], 1, 0, ABC_PPQ));
+    ASSERT(poly_command_is(&streams[2], 0, 64, 2 * ABC_PPQ));
+    ASSERT_EQ(streams[2].commands[0].voice, 1);
+    return 1;
+}
+
+TEST(poly_steal_rules) {
+    // Two oscillators; the chord's C finds none, and the late G must cut something
+    static NotePool pools[3];
+    static struct note storage[3][8];
+    static const char *music = "L:1/4\nK:C\nV:1\nc4\nV:2\n[EC]4\nV:3\nz G3";
+    struct sheet sheet;
+    for (int v = 0; v < 3; v++) note_pool_init(&pools[v], storage[v], 8, ABC_MAX_CHORD_NOTES);
+    sheet_init(&sheet, pools, 3);
+    ASSERT_EQ(abc_parse(&sheet, music), 0);
+
+    static AbcOscCommand commands[2][8];
+    AbcOscStream streams[2] = { { commands[0], 8, 0 }, { commands[1], 8, 0 } };
+    AbcPolyStats stats;
+
+    AbcPolyConfig oldest = { 2, ABC_STEAL_OLDEST, 0, NULL };
+    ASSERT_EQ(abc_polyphony_allocate(&sheet, &oldest, streams, &stats), 0);
+    ASSERT_EQ(stats.pitches, 4);
+    ASSERT_EQ(stats.dropped, 1);
+    ASSERT_EQ(stats.stolen, 1);
+    ASSERT(poly_command_is(&streams[0], 0, 72, ABC_PPQ));  // Tie on age: first oscillator
+    ASSERT(poly_command_is(&streams[0], 1, 67, 3 * ABC_PPQ));
+    ASSERT(poly_command_is(&streams[1], 0, 64, 4 * ABC_PPQ));
+
+    AbcPolyConfig melody = { 2, ABC_STEAL_KEEP_MELODY, 0, NULL };
+    ASSERT_EQ(abc_polyphony_allocate(&sheet, &melody, streams, &stats), 0);
+    ASSERT_EQ(stats.stolen, 1);
+    ASSERT(poly_command_is(&streams[0], 0, 72, 4 * ABC_PPQ));
+    ASSERT(poly_command_is(&streams[1], 0, 64, ABC_PPQ));
+    ASSERT(poly_command_is(&streams[1], 1, 67, 3 * ABC_PPQ));
+
+    AbcPolyConfig priority = { 2, ABC_STEAL_LOWEST_PRIORITY, 0, NULL };
+    ASSERT_EQ(abc_polyphony_allocate(&sheet, &priority, streams, &stats), 0);
+    ASSERT_EQ(stats.stolen, 0);
+    ASSERT_EQ(stats.dropped, 2);                    // Voice 3 ranks below both
+    static const uint8_t ranks[3] = { 1, 0, 2 };
+    priority.priority = ranks;
+    ASSERT_EQ(abc_polyphony_allocate(&sheet, &priority, streams, &stats), 0);
+    ASSERT_EQ(stats.stolen, 1);
+    ASSERT(poly_command_is(&streams[0], 0, 72, 4 * ABC_PPQ));
+    ASSERT(poly_command_is(&streams[1], 1, 67, 3 * ABC_PPQ));
+    return 1;
+}
+
+TEST(poly_sizing_and_errors) {
+    ASSERT_EQ(abc_parse(&g_sheet, "L:1/4\nK:C\nC D E F"), 0);
+    AbcOscStream sizing[1] = { { NULL, 0, 0 } };
+    AbcPolyConfig config = { 1, ABC_STEAL_OLDEST, 0, NULL };
+    ASSERT_EQ(abc_polyphony_allocate(&g_sheet, &config, sizing, NULL), 0);
+    ASSERT_EQ(sizing[0].count, 4);
+
+    AbcOscCommand commands[3];
+    AbcOscStream small[1] = { { commands, 3, 0 } };
+    ASSERT_EQ(abc_polyphony_allocate(&g_sheet, &config, small, NULL), -2);
+
+    config.oscillators = 0;
+    ASSERT_EQ(abc_polyphony_allocate(&g_sheet, &config, sizing, NULL), -1);
+    ASSERT_EQ(abc_polyphony_allocate(NULL, &config, sizing, NULL), -1);
+    return 1;
+}
+
+// ============================================================================
+// Arpeggio Tests
+// ============================================================================
+
+static int arp_pool_is(const NotePool *pool, const uint8_t *midi, const uint8_t *ticks, int count) {
+    const struct note *n = pool_first_note(pool);
+    for (int i = 0; i < count; i++, n = note_next(pool, n)) {
+        if (!n || n->chord_size != 1 || n->midi_note[0] != midi[i] || n->duration != ticks[i]) return 0;
+    }
+    return n == NULL;
+}
+
+TEST(arpeggio_expands_chords) {
+    ASSERT_EQ(abc_parse(&g_sheet, "L:1/4\nK:C\n[CEG] z C [CEGc]2 [CE]"), 0);
+    static NotePool out;
+    static struct note storage[32];
+    note_pool_init(&out, storage, 32, 1);
+
+    AbcArpConfig up = { ABC_PPQ / 4, ABC_ARP_UP };
+    ASSERT_EQ(abc_arpeggiate(&g_pools[0], &out, &up), 0);
+    static const uint8_t up_midi[] =  { 60, 64, 67, 60, 0,  60, 60, 64, 67, 72, 60, 64, 67, 72, 60, 64, 60, 64 };
+    static const uint8_t up_ticks[] = { 12, 12, 12, 12, 48, 48, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12 };
+    ASSERT(arp_pool_is(&out, up_midi, up_ticks, 18));
+    ASSERT_EQ(out.total_ticks, g_pools[0].total_ticks);
+
+    AbcArpConfig updown = { 16, ABC_ARP_UP_DOWN };   // 48 ticks = 16 + 16 + 16, 96 = 6 steps
+    ASSERT_EQ(abc_arpeggiate(&g_pools[0], &out, &updown), 0);
+    static const uint8_t ud_midi[] =  { 60, 64, 67, 0,  60, 60, 64, 67, 72, 67, 64, 60, 64, 60 };
+    static const uint8_t ud_ticks[] = { 16, 16, 16, 48, 48, 16, 16, 16, 16, 16, 16, 16, 16, 16 };
+    ASSERT(arp_pool_is(&out, ud_midi, ud_ticks, 14));
+
+    AbcArpConfig down = { 10, ABC_ARP_DOWN };        // Last step takes the remainder: 10 10 10 18
+    sheet_reset(&g_sheet);
+    ASSERT_EQ(abc_parse(&g_sheet, "L:1/4\nK:C\n[CEG]"), 0);
+    ASSERT_EQ(abc_arpeggiate(&g_pools[0], &out, &down), 0);
+    ASSERT_EQ(out.count, 4);
+    const struct note *n = pool_first_note(&out);
+    ASSERT_EQ(n->midi_note[0], 67); ASSERT_EQ(n->duration, 10); n = note_next(&out, n);
+    ASSERT_EQ(n->midi_note[0], 64); ASSERT_EQ(n->duration, 10); n = note_next(&out, n);
+    ASSERT_EQ(n->midi_note[0], 60); ASSERT_EQ(n->duration, 10); n = note_next(&out, n);
+    ASSERT_EQ(n->midi_note[0], 67); ASSERT_EQ(n->duration, 18);
+    ASSERT_EQ(out.total_ticks, g_pools[0].total_ticks);
+    return 1;
+}
+
+static int arp_stop_after_two(void *user, uint8_t midi, uint8_t duration) {
+    (void)midi; (void)duration;
+    return ++*(int *)user >= 2;
+}
+
+TEST(arpeggio_events_and_limits) {
+    ASSERT_EQ(abc_parse(&g_sheet, "K:C\n(3[CE][DF][EG] [CEG]8"), 0);
+    AbcArpConfig config = { 6, ABC_ARP_UP };
+    int32_t notes = abc_arpeggiate_events(&g_pools[0], &config, NULL, NULL);
+    ASSERT_EQ(notes, 2 + 2 + 2 + 32);               // Triplet eighths are 16 ticks: 6 + 10
+
+    int calls = 0;
+    ASSERT_EQ(abc_arpeggiate_events(&g_pools[0], &config, arp_stop_after_two, &calls), -3);
+    ASSERT_EQ(calls, 2);
+
+    static NotePool out;
+    static struct note storage[16];
+    note_pool_init(&out, storage, 16, 1);
+    ASSERT_EQ(abc_arpeggiate(&g_pools[0], &out, &config), -2);
+    ASSERT_EQ(abc_arpeggiate(&g_pools[0], &g_pools[0], &config), -1);
+    config.step_ticks = 0;
+    ASSERT_EQ(abc_arpeggiate_events(&g_pools[0], &config, NULL, NULL), -1);
+    return 1;
+}
+
+// ============================================================================
+// Pool Transform Tests
+// ============================================================================
+
+TEST(transpose_clamps_and_folds) {
+    ASSERT_EQ(abc_parse(&g_sheet, "K:C\nC z [CEG] c'"), 0);   // 60, rest, 60/64/67, 84
+    ASSERT_EQ(abc_pool_transpose(&g_pools[0], 5, 1, 127, ABC_RANGE_CLAMP), 0);
+    struct note *n = pool_first_note(&g_pools[0]);
+    ASSERT_EQ(n->midi_note[0], 65); n = note_next(&g_pools[0], n);
+    ASSERT_EQ(n->midi_note[0], 0);  n = note_next(&g_pools[0], n);   // Rest stays a rest
+    ASSERT_EQ(n->midi_note[0], 65);
+    ASSERT_EQ(n->midi_note[1], 69);
+    ASSERT_EQ(n->midi_note[2], 72);
+    ASSERT_EQ(n->midi_note[3], 0);                                   // Unused slot untouched
+
+    // Into a singer's range 60..76: clamped to the edge, or folded by octaves
+    ASSERT_EQ(abc_pool_transpose(&g_pools[0], 0, 60, 76, ABC_RANGE_CLAMP), 1);
+    n = note_get(&g_pools[0], 3);
+    ASSERT_EQ(n->midi_note[0], 76);
+    ASSERT_EQ(abc_pool_transpose(&g_pools[0], -12, 60, 76, ABC_RANGE_FOLD), 3);   // 53, 53, 57 fold up
+    n = pool_first_note(&g_pools[0]);
+    ASSERT_EQ(n->midi_note[0], 65);  // 53 folds up an octave
+    n = note_get(&g_pools[0], 3);
+    ASSERT_EQ(n->midi_note[0], 64);
+    ASSERT_EQ(note_get(&g_pools[0], 1)->midi_note[0], 0);
+
+    ASSERT_EQ(abc_pool_transpose(&g_pools[0], 1, 0, 127, ABC_RANGE_CLAMP), -1);   // 0 is the rest value
+    ASSERT_EQ(abc_pool_transpose(&g_pools[0], 1, 80, 70, ABC_RANGE_CLAMP), -1);
+    return 1;
+}
+
+TEST(scale_durations_keeps_totals_exact) {
+    ASSERT_EQ(abc_parse(&g_sheet, "L:1/8\nK:C\n(3CDE F G A B"), 0);  // 16 16 16 24 24 24 24
+    ASSERT_EQ(g_pools[0].total_ticks, 144);
+    ASSERT_EQ(abc_pool_scale_durations(&g_pools[0], 2, 3), 0);
+    ASSERT_EQ(g_pools[0].total_ticks, 96);
+
+    // Each note ends where its original end lands, rounded
+    static const uint8_t expect[] = { 11, 10, 11, 16, 16, 16, 16 };
+    uint32_t sum = 0;
+    struct note *n = pool_first_note(&g_pools[0]);
+    for (int i = 0; i < 7; i++, n = note_next(&g_pools[0], n)) {
+        ASSERT_EQ(n->duration, expect[i]);
+        sum += n->duration;
+    }
+    ASSERT_EQ(sum, g_pools[0].total_ticks);
+
+    // Too long for 8-bit durations: rejected without touching the pool
+    ASSERT_EQ(abc_pool_scale_durations(&g_pools[0], 20, 1), -2);
+    ASSERT_EQ(pool_first_note(&g_pools[0])->duration, 11);
+    ASSERT_EQ(abc_pool_scale_durations(&g_pools[0], 1, 0), -1);
+    return 1;
+}
+
+TEST(transforms_follow_edited_list) {
+    // The edit leaves the old notes of the bar in the array, off the list
+    strcpy(g_edit_text, "K:C\nC D E F | G A B c | C D E F |\n");
+    AbcEditor ed;
+    ASSERT_EQ(abc_editor_init(&ed, &g_sheet, g_edit_text, sizeof(g_edit_text), g_checkpoints, 16), 0);
+    ASSERT_EQ(abc_editor_edit(&ed, 20, 21, "z8", 2), 0);
+    ASSERT_EQ(g_pools[0].total_ticks, 456);     // 11 eighths and a whole rest
+
+    // Only live notes move: 11 pitches clamped, the rest untouched
+    ASSERT_EQ(abc_pool_transpose(&g_pools[0], 70, 1, 127, ABC_RANGE_CLAMP), 11);
+    ASSERT_EQ(abc_pool_scale_durations(&g_pools[0], 1, 2), 0);
+    ASSERT_EQ(g_pools[0].total_ticks, 228);
+
+    uint32_t sum = 0, notes = 0;
+    for (struct note *n = pool_first_note(&g_pools[0]); n; n = note_next(&g_pools[0], n), notes++) {
+        ASSERT_EQ(n->midi_note[0], n->duration == 96 ? 0 : 127);
+        ASSERT(n->duration == 12 || n->duration == 96);
+        sum += n->duration;
+    }
+    ASSERT_EQ(notes, 12);
+    ASSERT_EQ(sum, 228);
+    return 1;
+}
+
+TEST(transforms_reject_read_only_pools) {
+    NotePool view = g_pools[0];
+    view.capacity = 0;               // Like a store view or an embedded tune
+    ASSERT_EQ(abc_pool_transpose(&view, 2, 1, 127, ABC_RANGE_CLAMP), -1);
+    ASSERT_EQ(abc_pool_scale_durations(&view, 1, 2), -1);
+    ASSERT_EQ(abc_pool_transpose(NULL, 2, 1, 127, ABC_RANGE_CLAMP), -1);
+    return 1;
+}
+
+// ============================================================================
+// Corpus Generator Tests
+// ============================================================================
+
+TEST(corpus_is_deterministic) {
+    static char a[8192], b[8192];
+    AbcCorpusConfig config;
+    abc_corpus_defaults(&config);
+    config.seed = 7;
+
+    int32_t len = abc_corpus_tune(&config, 3, a, sizeof(a));
+    ASSERT(len > 0);
+    ASSERT_EQ(abc_corpus_tune(&config, 3, b, sizeof(b)), len);
+    ASSERT(memcmp(a, b, (size_t)len + 1) == 0);     // Same seed and index: same tune
+
+    ASSERT(abc_corpus_tune(&config, 4, b, sizeof(b)) > 0);
+    ASSERT(strcmp(a, b) != 0);
+    config.seed = 8;
+    ASSERT(abc_corpus_tune(&config, 3, b, sizeof(b)) > 0);
+    ASSERT(strcmp(a, b) != 0);
+
+    ASSERT_EQ(abc_corpus_tune(&config, 3, b, 64), -2);
+    config.tunes = 4;                                // Indexes 0..3
+    ASSERT(abc_corpus_tune(&config, 3, b, sizeof(b)) > 0);
+    ASSERT_EQ(abc_corpus_tune(&config, 4, b, sizeof(b)), -1);
+    config.voices = 0;
+    ASSERT_EQ(abc_corpus_tune(&config, 3, b, sizeof(b)), -1);
+    return 1;
+}
+
+TEST(corpus_tunes_parse) {
+    // Every knob turned up, all voices: the parser must accept each tune
+    static char abc[0xFFFF];
+    static NotePool pools[ABC_CORPUS_MAX_VOICES];
+    static struct note storage[ABC_CORPUS_MAX_VOICES][1024];
+    struct sheet sheet;
+    for (int v = 0; v < ABC_CORPUS_MAX_VOICES; v++) {
+        note_pool_init(&pools[v], storage[v], 1024, ABC_MAX_CHORD_NOTES);
+    }
+    sheet_init(&sheet, pools, ABC_CORPUS_MAX_VOICES);
+
+    AbcCorpusConfig config;
+    abc_corpus_defaults(&config);
+    config.voices = ABC_CORPUS_MAX_VOICES;
+    config.bars = 16;
+    config.chord_pct = 40;
+    config.max_chord = 4;
+    config.tuplet_pct = 30;
+    config.accidental_pct = 50;
+    config.repeat_pct = 50;
+    config.repeat_bars = 8;
+    config.noise_pct = 40;
+
+    for (uint32_t i = 0; i < 8; i++) {
+        ASSERT(abc_corpus_tune(&config, i, abc, sizeof(abc)) > 0);
+        sheet_reset(&sheet);
+        ASSERT_EQ(abc_parse(&sheet, abc), 0);
+        ASSERT_EQ(sheet.voice_count, ABC_CORPUS_MAX_VOICES);
+        for (int v = 0; v < ABC_CORPUS_MAX_VOICES; v++) {
+            // 4/4 in eighths: each bar is 4 quarters, more with repeats
+            ASSERT(pools[v].total_ticks >= 16u * 4 * ABC_PPQ);
+            ASSERT_EQ(pools[v].total_ticks % (4 * ABC_PPQ), 0);
+        }
+    }
+    return 1;
+}
+
+// ============================================================================
+// Parse Statistics Tests
+// ============================================================================
+
+TEST(parse_stats_counts_work) {
+    const char *abc = "X:1\nL:1/8\nK:Xyz\n|: C D [CEG] z :| (3abc \"Am\" E ~F.G # * |]\n";
+    AbcParseStats stats;
+    ASSERT_EQ(abc_parse_stats(&g_sheet, abc, &stats), 0);
+
+    ASSERT_EQ(stats.bytes, strlen(abc));
+#if ABC_PARSE_STATS
+    ASSERT_EQ(stats.notes, 8);
+    ASSERT_EQ(stats.chords, 1);
+    ASSERT_EQ(stats.rests, 1);
+    ASSERT_EQ(stats.tuplets, 1);
+    ASSERT_EQ(stats.repeats, 1);
+    ASSERT_EQ(stats.notes_copied, 4);
+    ASSERT_EQ(stats.skipped_decoration, 6);     // "Am" plus ~ and .
+    ASSERT_EQ(stats.skipped_unknown, 2);        // # and *
+    ASSERT_EQ(stats.key_fallbacks, 1);
+#else
+    ASSERT_EQ(stats.notes, 0);                  // Counters compiled out
+#endif
+    ASSERT_EQ(stats.voice_count, 1);
+    ASSERT_EQ(stats.pool_peak[0], 14);
+    ASSERT_EQ(stats.pool_peak[0], NOTE_COUNT());
+    ASSERT_EQ(stats.pool_capacity[0], TEST_MAX_NOTES);
+    return 1;
+}
+
+TEST(parse_stats_match_plain_parse) {
+    const char *abc = "X:1\nL:1/8\nK:D\nV:1\n|: d e f g :| a4 |]\nV:2\nD,8 | F,8 |]\n";
+    ASSERT_EQ(abc_parse(&g_sheet, abc), 0);
+    uint16_t counts[2] = { g_pools[0].count, g_pools[1].count };
+    uint32_t ticks[2] = { g_pools[0].total_ticks, g_pools[1].total_ticks };
+
+    AbcParseStats stats;
+    sheet_reset(&g_sheet);
+    ASSERT_EQ(abc_parse_stats(&g_sheet, abc, &stats), 0);
+    ASSERT_EQ(stats.voice_count, 2);
+    ASSERT_EQ(stats.key_fallbacks, 0);
+    for (int v = 0; v < 2; v++) {
+        ASSERT_EQ(g_pools[v].count, counts[v]);
+        ASSERT_EQ(g_pools[v].total_ticks, ticks[v]);
+        ASSERT_EQ(stats.pool_peak[v], counts[v]);
+    }
+#if ABC_PARSE_STATS
+    ASSERT_EQ(stats.notes + stats.notes_copied, 9u + 2);
+#endif
+    ASSERT_EQ(abc_parse_stats(&g_sheet, abc, NULL), -1);
+    return 1;
+}
+
+TEST(parse_stats_report_full_pools) {
+    // The failing tune still reports how far it got
+    struct note storage[4];
+    NotePool pool;
+    struct sheet sheet;
+    note_pool_init(&pool, storage, 4, ABC_MAX_CHORD_NOTES);
+    sheet_init(&sheet, &pool, 1);
+
+    AbcParseStats stats;
+    ASSERT_EQ(abc_parse_stats(&sheet, "K:C\n|: C D E :|\n", &stats), -2);
+    ASSERT_EQ(stats.pool_peak[0], 4);
+    ASSERT_EQ(stats.pool_capacity[0], 4);
+#if ABC_PARSE_STATS
+    ASSERT_EQ(stats.notes, 3);
+    ASSERT_EQ(stats.notes_copied, 1);           // The copy ran out of room after one note
+#endif
+    ASSERT(stats.bytes < 17);
+    return 1;
+}
+
+// ============================================================================
+// Trace Tests
+// ============================================================================
+
+// Fake clock: every read is 10 units after the previous one
+static uint32_t g_trace_clock;
+static uint32_t trace_clock(void *user) {
+    (void)user;
+    return g_trace_clock += 10;
+}
+
+TEST(trace_accounts_nested_phases) {
+    AbcTraceSpan spans[2];
+    AbcTrace trace;
+    g_trace_clock = 0;
+    abc_trace_init(&trace, trace_clock, NULL, spans, 2);
+
+    abc_trace_enter(&trace, ABC_TRACE_BODY);        // Clock 20
+    abc_trace_enter(&trace, ABC_TRACE_NOTE);        // 30
+    abc_trace_enter(&trace, ABC_TRACE_APPEND);      // 40, no span left
+    abc_trace_exit(&trace);                         // 50
+    abc_trace_exit(&trace);                         // 60
+    abc_trace_exit(&trace);                         // 70
+    abc_trace_exit(&trace);                         // Unbalanced: ignored
+
+    ASSERT_EQ(trace.total[ABC_TRACE_BODY], 50);
+    ASSERT_EQ(trace.total[ABC_TRACE_NOTE], 30);
+    ASSERT_EQ(trace.total[ABC_TRACE_APPEND], 10);
+    ASSERT_EQ(trace.calls[ABC_TRACE_APPEND], 1);
+    ASSERT_EQ(trace.span_count, 2);
+    ASSERT_EQ(trace.spans_dropped, 1);
+
+    char buf[512];
+    ASSERT(abc_trace_export_folded(&trace, buf, sizeof(buf)) > 0);
+    ASSERT(strcmp(buf, "body;note;append 10\nbody;note 20\nbody 20\n") == 0);   // Self time
+
+    ASSERT(abc_trace_export_chrome(&trace, buf, sizeof(buf)) > 0);
+    ASSERT(strstr(buf, "\"name\":\"note\",\"cat\":\"abc\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":20,\"dur\":30") != NULL);
+    trace.clock_hz = 1000000;                       // One unit per microsecond
+    ASSERT(abc_trace_export_chrome(&trace, buf, sizeof(buf)) > 0);
+    ASSERT(strstr(buf, "\"ts\":10.000,\"dur\":50.000") != NULL);
+    ASSERT(strstr(buf, "\"spans_dropped\":1") != NULL);
+
+    ASSERT_EQ(abc_trace_export_chrome(&trace, buf, 40), -2);
+    ASSERT_EQ(abc_trace_export_folded(NULL, buf, sizeof(buf)), -1);
+    return 1;
+}
+
+#if ABC_TRACE
+TEST(trace_hooks_time_parse) {
+    AbcTrace trace;
+    abc_trace_init(&trace, trace_clock, NULL, NULL, 0);
+    sheet_set_trace(&g_sheet, &trace);
+    int result = abc_parse(&g_sheet, "X:1\nK:G\n|: G A [GBd] :| z2 |]\n");
+    sheet_set_trace(&g_sheet, NULL);
+    ASSERT_EQ(result, 0);
+
+    ASSERT_EQ(trace.calls[ABC_TRACE_HEADER], 1);
+    ASSERT_EQ(trace.calls[ABC_TRACE_BODY], 1);
+    ASSERT_EQ(trace.calls[ABC_TRACE_REPEAT], 1);
+    ASSERT_EQ(trace.calls[ABC_TRACE_APPEND], NOTE_COUNT());    // Parsed and copied notes
+    ASSERT(trace.calls[ABC_TRACE_NOTE] >= 4);
+    ASSERT_EQ(trace.depth, 0);
+    ASSERT(trace.total[ABC_TRACE_BODY] > trace.total[ABC_TRACE_NOTE] + trace.total[ABC_TRACE_REPEAT]);
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Adversarial Input Tests
+// ============================================================================
+
+TEST(zero_denominator_is_safe) {
+    // "/0" used to divide by zero
+    ASSERT_EQ(abc_parse(&g_sheet, "K:C\nC/0 [CE]/0 D\n"), 0);
+    ASSERT_EQ(NOTE_COUNT(), 3);
+    ASSERT_EQ(g_pools[0].notes[0].duration, ABC_PPQ / 2);   // As if no length were given
+    ASSERT_EQ(g_pools[0].notes[1].duration, ABC_PPQ / 2);
+    return 1;
+}
+
+TEST(long_numbers_saturate) {
+    // Digit and slash runs no longer overflow int; lengths clamp as before
+    ASSERT_EQ(abc_parse(&g_sheet, "X:1\nQ:1/4=99999999999999999999\nK:C\n"
+                                  "C99999999999999999999 D//////////////////////////////////////// E3/99999999999\n"), 0);
+    ASSERT_EQ(g_sheet.tempo_bpm, 9999);
+    ASSERT_EQ(NOTE_COUNT(), 3);
+    ASSERT_EQ(g_pools[0].notes[0].duration, 255);
+    ASSERT_EQ(g_pools[0].notes[1].duration, 0);
+    ASSERT_EQ(g_pools[0].notes[2].duration, 0);
+    return 1;
+}
+
+// ============================================================================
+// Header Scan Tests
+// ============================================================================
+
+static int span_is(const char *abc, AbcSpan span, const char *text) {
+    return span.len == strlen(text) && memcmp(abc + span.offset, text, span.len) == 0;
+}
+
+TEST(scan_header_returns_spans) {
+    const char *abc = "X:48213\nT:A title well beyond the thirty-two byte buffer  \nC: Trad.\n"
+                      "M:6/8\nL:1/8\nQ:3/8=120\nK:Ador\nABc d2e|\n";
+    AbcHeaderScan scan;
+    ASSERT_EQ(abc_scan_header(abc, 0, &scan), 0);
+    ASSERT(span_is(abc, scan.number, "48213"));
+    ASSERT(span_is(abc, scan.title, "A title well beyond the thirty-two byte buffer"));
+    ASSERT(span_is(abc, scan.composer, "Trad."));
+    ASSERT(span_is(abc, scan.meter, "6/8"));
+    ASSERT(span_is(abc, scan.length, "1/8"));
+    ASSERT(span_is(abc, scan.tempo, "3/8=120"));
+    ASSERT(span_is(abc, scan.key, "Ador"));
+    ASSERT(strcmp(abc + scan.body_start, "ABc d2e|\n") == 0);
+    ASSERT_EQ(scan.voice_count, 0);             // Body not read without ABC_SCAN_VOICES
+    ASSERT_EQ(scan.body_end, 0);
+
+    // The same fields abc_parse() keeps, untruncated
+    ASSERT_EQ(abc_parse(&g_sheet, abc), 0);
+    ASSERT(strncmp(abc + scan.title.offset, g_sheet.title, strlen(g_sheet.title)) == 0);
+    ASSERT(span_is(abc, scan.key, g_sheet.key));
+    ASSERT_EQ(abc_scan_header(NULL, 0, &scan), -1);
+    return 1;
+}
+
+TEST(scan_header_lists_voices) {
+    const char *abc = "X:1\nT:Two\nK:G\nV:S\nabc \"V:fake\" [V:no] V: A\ndef|V:S ga\n \nX:2\nV:Other\n";
+    AbcHeaderScan scan;
+    ASSERT_EQ(abc_scan_header(abc, ABC_SCAN_VOICES, &scan), 0);
+    ASSERT_EQ(scan.voice_count, 2);
+    ASSERT(span_is(abc, scan.voices[0], "S"));
+    ASSERT(span_is(abc, scan.voices[1], "A"));
+    ASSERT_EQ(scan.voices_truncated, 0);
+    ASSERT_EQ(abc[scan.body_end], '\n');        // Stopped at the blank line before X:2
+    ASSERT(strncmp(abc + scan.body_end, "\n \nX:2", 6) == 0);
+
+    // A V: line ends the header, as in abc_parse()
+    ASSERT_EQ(abc_scan_header("X:1\nV:1\nK:C\nC\n", ABC_SCAN_VOICES, &scan), 0);
+    ASSERT_EQ(scan.key.len, 0);
+    ASSERT_EQ(scan.body_start, 4);
+    ASSERT_EQ(scan.voice_count, 1);
+    return 1;
+}
+
+TEST(scan_header_truncates_voice_list) {
+    char abc[512];
+    size_t len = 0;
+    len += (size_t)sprintf(abc, "K:C\n");
+    for (int v = 0; v < ABC_SCAN_MAX_VOICES + 2; v++) len += (size_t)sprintf(abc + len, "V:v%d C\n", v);
+    len += (size_t)sprintf(abc + len, "V:v0 D\n");
+
+    AbcHeaderScan scan;
+    ASSERT_EQ(abc_scan_header(abc, ABC_SCAN_VOICES, &scan), 0);
+    ASSERT_EQ(scan.voice_count, ABC_SCAN_MAX_VOICES);
+    ASSERT_EQ(scan.voices_truncated, 1);
+    ASSERT(span_is(abc, scan.voices[ABC_SCAN_MAX_VOICES - 1], "v15"));
+    ASSERT_EQ(scan.body_end, len);
+    return 1;
+}
+
+// ============================================================================
+// Songbook Index Tests
+// ============================================================================
+
+static const char index_collection[] =
+    "%abc-2.1\n% Session tunes\n\n"
+    "X:12\nT:The Kesh\nM:6/8\nL:1/8\nK:G\nGAG GAB|ABA ABd|\n\n"
+    "X:3\nT:Morrison's Jig\nM:6/8\nK:Edor\n|:E2B B2A:|\n"
+    "X:12\nT:Si Bheag Si Mhor\nM:3/4\nK:D\nV:1\nd2 B2 A2|\nV:2\nD6|\n  \n";
+
+static char g_index_scratch[ABC_INDEX_SCRATCH];
+
+TEST(index_scan_splits_collection) {
+    AbcIndexRecord rec[3];
+    const char *text = index_collection;
+    ASSERT_EQ(abc_index_scan(text, sizeof(index_collection) - 1, 4, rec, 3, g_index_scratch), 3);
+
+    ASSERT_EQ(rec[0].offset, strstr(text, "X:12") - text);
+    ASSERT(strncmp(text + rec[0].offset + rec[0].length - 4, "ABd|", 4) == 0);
+    ASSERT_EQ(rec[0].number, 12);
+    ASSERT_EQ(rec[0].title_hash, abc_index_title_hash("the kesh", 8));
+    ASSERT(memcmp(rec[0].key, "G\0\0\0\0\0\0\0", ABC_INDEX_KEY_LEN) == 0);
+    ASSERT_EQ(rec[0].meter_num, 6);
+    ASSERT_EQ(rec[0].meter_den, 8);
+    ASSERT_EQ(rec[0].note_count, 12);
+    ASSERT_EQ(rec[0].file_id, 4);
+
+    // Ends at the next X: line without a blank line in between
+    ASSERT_EQ(rec[1].number, 3);
+    ASSERT(strncmp(rec[1].key, "Edor", 5) == 0);
+    ASSERT_EQ(rec[1].note_count, 8);            // Repeat unfolded
+    ASSERT_EQ(text[rec[1].offset + rec[1].length], '\n');
+    ASSERT_EQ(rec[2].offset, rec[1].offset + rec[1].length + 1);
+    ASSERT_EQ(rec[2].voice_count, 2);
+    ASSERT_EQ(rec[2].note_count, 4);
+    ASSERT_EQ(rec[2].meter_num, 3);
+    ASSERT_EQ(rec[2].offset + rec[2].length, sizeof(index_collection) - 5);   // Trailing blank trimmed
+
+    ASSERT_EQ(abc_index_scan(text, sizeof(index_collection) - 1, 4, rec, 2, g_index_scratch), -2);
+    ASSERT_EQ(abc_index_scan("K:C\nCDE\n", 8, 0, rec, 3, g_index_scratch), 1);   // No X: lines: one tune
+    ASSERT_EQ(rec[0].note_count, 3);
+    ASSERT_EQ(abc_index_scan(NULL, 0, 0, rec, 3, g_index_scratch), -1);
+    return 1;
+}
+
+TEST(index_write_open_find) {
+    static const char second[] = "X:7\nT:THE KESH\nK:G\nB\n";
+    AbcIndexRecord rec[4];
+    static uint32_t image[64];
+    int32_t n = abc_index_scan(index_collection, sizeof(index_collection) - 1, 0, rec, 4, g_index_scratch);
+    ASSERT_EQ(n, 3);
+    ASSERT_EQ(abc_index_scan(second, sizeof(second) - 1, 1, rec + 3, 1, g_index_scratch), 1);
+
+    int32_t size = abc_index_write(rec, 4, NULL, 0);
+    ASSERT(size > 0 && (uint32_t)size <= sizeof(image));
+    ASSERT_EQ(abc_index_write(rec, 4, image, (uint32_t)size - 1), -2);
+    ASSERT_EQ(abc_index_write(rec, 4, image, sizeof(image)), size);
+
+    AbcIndex index;
+    ASSERT_EQ(abc_index_open(&index, image, (uint32_t)size), 0);
+    ASSERT_EQ(index.count, 4);
+    ASSERT_EQ(index.records[0].number, 3);      // Sorted by number, then file and offset
+    ASSERT_EQ(index.records[1].number, 7);
+
+    uint32_t found[4];
+    ASSERT_EQ(abc_index_find_number(&index, 12, found, 4), 2);
+    ASSERT_EQ(found[0], 2);
+    ASSERT(index.records[2].offset < index.records[3].offset);
+    ASSERT_EQ(abc_index_find_number(&index, 99, found, 4), 0);
+    ASSERT_EQ(abc_index_find_title(&index, "The Kesh", found, 4), 2);      // Either case
+    ASSERT_EQ(found[0], 1);
+    ASSERT_EQ(found[1], 2);
+    ASSERT_EQ(abc_index_find_key(&index, "G", found, 1), 2);               // Total, one written
+    ASSERT_EQ(found[0], 1);
+    ASSERT_EQ(abc_index_find_key(&index, "Edor", found, 4), 1);
+    ASSERT_EQ(index.records[found[0]].number, 3);
+
+    // Any flipped byte fails the checksum
+    ((uint8_t *)image)[ABC_INDEX_HEADER_SIZE + 9] ^= 1;
+    ASSERT_EQ(abc_index_open(&index, image, (uint32_t)size), -3);
+    ((uint8_t *)image)[ABC_INDEX_HEADER_SIZE + 9] ^= 1;
+    ASSERT_EQ(abc_index_open(&index, image, (uint32_t)size - 1), -3);
+    ASSERT_EQ(abc_index_open(&index, image, (uint32_t)size), 0);
+    return 1;
+}
+
+TEST(index_parse_at_offset) {
+    AbcIndexRecord rec[3];
+    uint32_t size = sizeof(index_collection) - 1;
+    ASSERT_EQ(abc_index_scan(index_collection, size, 0, rec, 3, g_index_scratch), 3);
+
+    // Only the tune's bytes are parsed, not the tunes after it
+    ASSERT_EQ(abc_index_parse(&rec[1], index_collection, size, &g_sheet), 0);
+    ASSERT(strcmp(g_sheet.title, "Morrison's Jig") == 0);
+    ASSERT_EQ(NOTE_COUNT(), rec[1].note_count);
+
+    // Edited or truncated source files are caught before parsing
+    static char edited[sizeof(index_collection)];
+    memcpy(edited, index_collection, sizeof(index_collection));
+    edited[rec[1].offset + rec[1].length - 3] = 'G';
+    ASSERT_EQ(abc_index_parse(&rec[1], edited, size, &g_sheet), -3);
+    ASSERT_EQ(abc_index_parse(&rec[2], index_collection, rec[2].offset + 4, &g_sheet), -3);
+
+    sheet_reset(&g_sheet);
+    ASSERT_EQ(abc_parse_len(&g_sheet, "X:1\nK:C\nCDEF", 9), 0);
+    ASSERT_EQ(NOTE_COUNT(), 1);
+    return 1;
+}
+
+// ============================================================================
+// Melody Search Tests
+// ============================================================================
+
+static const char *const search_tunes[] = {
+    "K:C\nCDEF GABc|cBAG FEDC|\n",              // Major scale up and down
+    "K:C\nEGEG cGEC|DFDF BFDB|\n",              // Arpeggios
+    "K:G\nz2 GA Bc d2|[GBd]2 z ed BG|\n",       // Scale fragment after a rest, chord
+    "K:D\nDEFG ABcd|\n",                        // Major scale in D
+};
+#define SEARCH_TUNES 4
+
+static uint32_t g_search_offsets[ABC_SEARCH_GRAMS + 1];
+static uint32_t g_search_last[ABC_SEARCH_GRAMS];
+static uint8_t g_search_postings[256];
+
+static int search_pass(AbcSearchIndex *index, int tunes) {
+    for (int i = 0; i < tunes; i++) {
+        sheet_reset(&g_sheet);
+        if (abc_parse(&g_sheet, search_tunes[i]) != 0) return 0;
+        if (abc_search_add(index, &g_pools[0]) != i) return 0;
+    }
+    return 1;
+}
+
+static int search_build(AbcSearchIndex *index) {
+    return abc_search_init(index, g_search_offsets, g_search_last) == 0 && search_pass(index, SEARCH_TUNES) &&
+           abc_search_layout(index, g_search_postings, sizeof(g_search_postings)) == 0 &&
+           search_pass(index, SEARCH_TUNES) && abc_search_finish(index) == 0;
+}
+
+TEST(search_melody_skips_rests_and_takes_top_note) {
+    ASSERT_EQ(abc_parse(&g_sheet, "K:C\nC z [CEG] D [B,D] z2\n"), 0);
+    uint8_t midi[8];
+    ASSERT_EQ(abc_search_melody(&g_pools[0], midi, 8), 4);
+    ASSERT_EQ(midi[0], 60);
+    ASSERT_EQ(midi[1], 67);
+    ASSERT_EQ(midi[2], 62);
+    ASSERT_EQ(midi[3], 62);
+    ASSERT_EQ(abc_search_melody(&g_pools[0], midi, 2), 2);
+    return 1;
+}
+
+TEST(search_finds_transposed_fragment) {
+    AbcSearchIndex index;
+    ASSERT(search_build(&index));
+    ASSERT_EQ(index.tune_count, SEARCH_TUNES);
+    ASSERT(index.postings_size > 0 && index.postings_size <= sizeof(g_search_postings));
+
+    // The second tune's opening, up a minor third
+    uint32_t scores[SEARCH_TUNES];
+    AbcSearchHit hits[SEARCH_TUNES];
+    const uint8_t arpeggio[] = { 67, 70, 67, 70, 75, 70, 67, 63 };
+    ASSERT_EQ(abc_search_query(&index, arpeggio, 8, scores, hits, SEARCH_TUNES), 1);
+    ASSERT_EQ(hits[0].tune, 1);
+    ASSERT_EQ(hits[0].matched, 4);              // Every n-gram of the fragment
+
+    // A rising major scale in E, with a rest: three tunes share it
+    const uint8_t scale[] = { 64, 66, 0, 68, 69, 71, 73 };
+    ASSERT_EQ(abc_search_query(&index, scale, 7, scores, hits, SEARCH_TUNES), 3);
+    ASSERT_EQ(hits[0].tune, 0);                 // Both n-grams; ties rank the lower id first
+    ASSERT_EQ(hits[0].matched, 2);
+    ASSERT_EQ(hits[1].tune, 3);
+    ASSERT_EQ(hits[1].matched, 2);
+    ASSERT_EQ(hits[2].tune, 2);                 // Only the first
+    ASSERT(hits[1].score > hits[2].score);
+    ASSERT_EQ(abc_search_query(&index, scale, 7, scores, hits, 1), 1);
+    ASSERT_EQ(hits[0].tune, 0);
+    ASSERT_EQ(abc_search_query(&index, scale, 4, scores, hits, SEARCH_TUNES), 0);   // Too short for an n-gram
+    return 1;
+}
+
+TEST(search_passes_must_match) {
+    AbcSearchIndex index;
+    uint32_t scores[SEARCH_TUNES];
+    AbcSearchHit hits[1];
+    ASSERT_EQ(abc_search_init(&index, g_search_offsets, g_search_last), 0);
+    ASSERT(search_pass(&index, SEARCH_TUNES));
+    ASSERT_EQ(abc_search_layout(&index, g_search_postings, index.postings_size - 1), -2);
+    ASSERT_EQ(abc_search_query(&index, NULL, 0, scores, hits, 1), -1);     // Not finished
+
+    ASSERT_EQ(abc_search_layout(&index, g_search_postings, sizeof(g_search_postings)), 0);
+    ASSERT(search_pass(&index, SEARCH_TUNES - 1));
+    ASSERT_EQ(abc_search_finish(&index), -1);   // One tune missing
+    ASSERT_EQ(index.phase, ABC_SEARCH_FAILED);
+    ASSERT_EQ(abc_search_add(&index, &g_pools[0]), -1);
+    ASSERT_EQ(abc_search_init(NULL, g_search_offsets, g_search_last), -1);
+    return 1;
+}
+
+// ============================================================================
+// Fingerprint Tests
+// ============================================================================
+
+// Fingerprint generated tune `index`, transposed and with a few notes changed
+static int fingerprint_tune(uint32_t index, int8_t transpose, int changes, AbcFingerprint *fp) {
+    static char abc[8192];
+    AbcCorpusConfig config;
+    abc_corpus_defaults(&config);
+    config.bars = 16;
+    config.repeat_pct = 0;
+    if (abc_corpus_tune(&config, index, abc, sizeof(abc)) < 0) return 0;
+    sheet_reset(&g_sheet);
+    if (abc_parse(&g_sheet, abc) != 0) return 0;
+    if (transpose) abc_pool_transpose(&g_pools[0], transpose, 0, 127, ABC_RANGE_CLAMP);
+
+    uint16_t i = 0;
+    for (struct note *n = pool_first_note(&g_pools[0]); n && changes > 0; n = note_next(&g_pools[0], n), i++) {
+        if (i % 37 == 20 && n->midi_note[0]) {
+            n->midi_note[0] = (uint8_t)(n->midi_note[0] + 3);
+            changes--;
+        }
+    }
+    return abc_fingerprint(&g_pools[0], fp) > 0;
+}
+
+TEST(fingerprint_ignores_key_and_tempo) {
+    AbcFingerprint a, b;
+    ASSERT(abc_parse(&g_sheet, "L:1/8\nK:C\nCDEF G2AB|c2BA G4|FEDC D4|\n") == 0);
+    ASSERT_EQ(abc_fingerprint(&g_pools[0], &a), 11);    // 16 notes: 15 tokens, 11 shingles
+
+    // Same tune a fifth up in half-length notes
+    sheet_reset(&g_sheet);
+    ASSERT(abc_parse(&g_sheet, "L:1/16\nK:G\nGABc d2ef|g2fe d4|cBAG A4|\n") == 0);
+    ASSERT_EQ(abc_fingerprint(&g_pools[0], &b), 11);
+    ASSERT(memcmp(a.min, b.min, sizeof(a.min)) == 0);
+    ASSERT_FLOAT_EQ(abc_fingerprint_similarity(&a, &b), 1.0, 0.001);
+
+    // A different rhythm is a different tune
+    sheet_reset(&g_sheet);
+    ASSERT(abc_parse(&g_sheet, "L:1/8\nK:C\nC2DE FGAB|c2BA G4|FEDC D4|\n") == 0);
+    ASSERT_EQ(abc_fingerprint(&g_pools[0], &b), 11);
+    ASSERT(abc_fingerprint_similarity(&a, &b) < 1.0f);
+
+    sheet_reset(&g_sheet);
+    ASSERT(abc_parse(&g_sheet, "K:C\nC z D E\n") == 0);
+    ASSERT_EQ(abc_fingerprint(&g_pools[0], &b), 0);     // Too short to compare
+    ASSERT_FLOAT_EQ(abc_fingerprint_similarity(&a, &b), 0.0, 0.001);
+    ASSERT_EQ(abc_fingerprint(NULL, &b), -1);
+    return 1;
+}
+
+TEST(fingerprint_variants_are_similar) {
+    AbcFingerprint a, variant, other;
+    ASSERT(fingerprint_tune(0, 0, 0, &a));
+    ASSERT(fingerprint_tune(0, -5, 2, &variant));
+    ASSERT(fingerprint_tune(1, 0, 0, &other));
+    ASSERT(abc_fingerprint_similarity(&a, &variant) > 0.6f);
+    ASSERT(abc_fingerprint_similarity(&a, &other) < 0.2f);
+    return 1;
+}
+
+TEST(fingerprint_cluster_groups_duplicates) {
+    // Tunes 0 and 3 have two settings each, tune 1 three; the rest are unique
+    static AbcFingerprint fps[8];
+    static const struct { uint32_t tune; int8_t transpose; int changes; } settings[8] = {
+        { 0, 0, 0 }, { 1, 0, 0 }, { 2, 0, 0 }, { 0, 7, 1 },
+        { 1, -2, 0 }, { 3, 0, 0 }, { 1, 5, 2 }, { 3, 12, 1 },
+    };
+    for (int i = 0; i < 8; i++) {
+        ASSERT(fingerprint_tune(settings[i].tune, settings[i].transpose, settings[i].changes, &fps[i]));
+    }
+
+    uint64_t scratch[8];
+    uint32_t cluster[8];
+    ASSERT_EQ(abc_fingerprint_cluster(fps, 8, 0.5f, scratch, cluster), 4);
+    ASSERT_EQ(cluster[0], 0);
+    ASSERT_EQ(cluster[3], 0);
+    ASSERT_EQ(cluster[1], 1);
+    ASSERT_EQ(cluster[4], 1);
+    ASSERT_EQ(cluster[6], 1);
+    ASSERT_EQ(cluster[2], 2);
+    ASSERT_EQ(cluster[5], 5);
+    ASSERT_EQ(cluster[7], 5);
+
+    // Nothing joins at an impossible threshold
+    ASSERT_EQ(abc_fingerprint_cluster(fps, 8, 1.01f, scratch, cluster), 0);
+    ASSERT_EQ(abc_fingerprint_cluster(fps, 8, 0.5f, NULL, cluster), -1);
+    return 1;
+}
+
+TEST(fingerprint_cluster_compares_whole_bucket) {
+    // Four tunes share band 0. Tunes 1 and 3 also agree on 3 of 4 entries of
+    // every other band (similarity 49/64) but share no other whole band, so
+    // only the band 0 bucket can bring them together; 0 and 2 are unrelated.
+    static AbcFingerprint fps[4];
+    for (uint32_t t = 0; t < 4; t++) {
+        fps[t].shingles = 10;
+        for (uint32_t k = 0; k < ABC_FP_HASHES; k++) {
+            uint32_t related = 1000 + k + ((k % 4 == 3) ? t * 100000 : 0);
+            fps[t].min[k] = k < 4 ? k : (t % 2 ? related : 5000000 * (t + 1) + k);
+        }
+    }
+    ASSERT_FLOAT_EQ(abc_fingerprint_similarity(&fps[1], &fps[3]), 49.0 / 64, 0.001);
+
+    uint64_t scratch[4];
+    uint32_t cluster[4];
+    ASSERT_EQ(abc_fingerprint_cluster(fps, 4, 0.5f, scratch, cluster), 1);
+    ASSERT_EQ(cluster[3], 1);
+    ASSERT_EQ(cluster[2], 2);
+    ASSERT_EQ(cluster[0], 0);
+    return 1;
+}
+
+TEST(fingerprint_cluster_large_bucket) {
+    // 4000 tunes share band 0 (a stock phrase). Every fourth is a copy of tune
+    // 0; from 2001 on, every fourth is a copy of tune 2001, which first shows
+    // up long after the bucket's representatives ran out. The rest are
+    // unrelated, with nothing else in common.
+    static AbcFingerprint fps[4000];
+    for (uint32_t t = 0; t < 4000; t++) {
+        uint32_t source = t % 4 == 0 ? 0 : (t >= 2001 && t % 4 == 1 ? 2001 : t);
+        fps[t].shingles = 10;
+        for (uint32_t k = 0; k < ABC_FP_HASHES; k++) {
+            fps[t].min[k] = k < 4 ? k : 100 * source + k;
+        }
+    }
+    static uint64_t scratch[4000];
+    static uint32_t cluster[4000];
+    ASSERT_EQ(abc_fingerprint_cluster(fps, 4000, 0.5f, scratch, cluster), 999 + 499);
+    for (uint32_t t = 0; t < 4000; t++) {
+        uint32_t expected = t % 4 == 0 ? 0 : (t >= 2001 && t % 4 == 1 ? 2001 : t);
+        ASSERT_EQ(cluster[t], expected);
+    }
+    return 1;
+}
+
+// ============================================================================
+// Analysis Tests
+// ============================================================================
+
+TEST(analysis_pitch_stats) {
+    // Stale pitches in unused chord slots must not count
+    memset(g_note_storage[0], 0x55, sizeof(g_note_storage[0]));
+    ASSERT(abc_parse(&g_sheet, "L:1/8\nK:C\nC2 [EG] z A, c'\n") == 0);
+
+    AbcPitchStats stats;
+    abc_pitch_stats_clear(&stats);
+    ASSERT_EQ(abc_pitch_stats_add(&stats, &g_pools[0]), 0);
+    ASSERT_EQ(stats.notes, 4);
+    ASSERT_EQ(stats.rests, 1);
+    ASSERT_EQ(stats.ticks, 144);
+    ASSERT_EQ(stats.pc_ticks[0], 72);       // C2 and c'
+    ASSERT_EQ(stats.pc_ticks[4], 24);
+    ASSERT_EQ(stats.pc_ticks[7], 24);
+    ASSERT_EQ(stats.pc_ticks[9], 24);
+    ASSERT_EQ(stats.pc_notes[0], 2);
+    ASSERT_EQ(stats.pc_notes[5], 0);
+    ASSERT_EQ(stats.lowest, 57);            // A,
+    ASSERT_EQ(stats.highest, 84);           // c'
+
+    // Adding again accumulates
+    ASSERT_EQ(abc_pitch_stats_add(&stats, &g_pools[0]), 0);
+    ASSERT_EQ(stats.notes, 8);
+    ASSERT_EQ(stats.pc_ticks[0], 144);
+    ASSERT_EQ(stats.lowest, 57);
+    ASSERT_EQ(abc_pitch_stats_add(&stats, NULL), -1);
+    return 1;
+}
+
+TEST(analysis_note_density) {
+    ASSERT(abc_parse(&g_sheet, "L:1/4\nK:C\nCDEF|[CE]4|z2 C/C/C/C/|\n") == 0);
+
+    // Half-note windows; the chord is one onset and the rest none
+    static const uint16_t expected[6] = { 2, 2, 1, 0, 0, 4 };
+    uint16_t curve[8];
+    ASSERT_EQ(abc_note_density(&g_pools[0], 96, curve, 8), 6);
+    for (int i = 0; i < 6; i++) ASSERT_EQ(curve[i], expected[i]);
+
+    // A short curve keeps the first windows
+    curve[3] = 99;
+    ASSERT_EQ(abc_note_density(&g_pools[0], 96, curve, 3), 6);
+    ASSERT_EQ(curve[0], 2);
+    ASSERT_EQ(curve[2], 1);
+    ASSERT_EQ(curve[3], 99);
+    ASSERT_EQ(abc_note_density(&g_pools[0], 0, curve, 3), -1);
+
+    // Edited pools: only notes on the list count, in play order
+    strcpy(g_edit_text, "K:C\nC D E F | G A B c | C D E F |\n");
+    AbcEditor ed;
+    ASSERT_EQ(abc_editor_init(&ed, &g_sheet, g_edit_text, sizeof(g_edit_text), g_checkpoints, 16), 0);
+    ASSERT_EQ(abc_editor_edit(&ed, 20, 21, "z8", 2), 0);
+    AbcPitchStats stats;
+    abc_pitch_stats_clear(&stats);
+    ASSERT_EQ(abc_pitch_stats_add(&stats, &g_pools[0]), 0);
+    ASSERT_EQ(stats.notes, 11);
+    ASSERT_EQ(stats.rests, 1);
+    ASSERT_EQ(stats.ticks, 456);
+    ASSERT_EQ(stats.pc_notes[7], 1);        // G once
+    static const uint16_t edited[5] = { 4, 3, 0, 1, 3 };     // The rest starts at tick 168
+    ASSERT_EQ(abc_note_density(&g_pools[0], 96, curve, 8), 5);
+    for (int i = 0; i < 5; i++) ASSERT_EQ(curve[i], edited[i]);
+    return 1;
+}
+
+TEST(analysis_estimates_key) {
+    // A tune in G major and one in A minor, analyzed as a batch
+    struct sheet sheets[2];
+    for (int i = 0; i < TEST_MAX_VOICES; i++) {
+        note_pool_init(&g_ref_pools[i], g_ref_storage[i], TEST_MAX_NOTES, ABC_MAX_CHORD_NOTES);
+    }
+    sheet_init(&sheets[1], g_ref_pools, TEST_MAX_VOICES);
+    ASSERT(abc_parse(&g_sheet, "L:1/8\nK:G\nG2B2 d2B2|c2A2 F2A2|G2B2 d2g2|f2d2 G4|\n") == 0);
+    ASSERT(abc_parse(&sheets[1], "L:1/8\nK:Am\nA2c2 e2c2|d2B2 ^G2B2|A2c2 e2a2|e2^G2 A4|\n") == 0);
+    sheets[0] = g_sheet;
+
+    AbcPitchStats stats[2];
+    AbcKeyEstimate keys[2];
+    ASSERT_EQ(abc_analyze_sheets(sheets, 2, stats, keys), 0);
+    for (int i = 0; i < 2; i++) {
+        uint8_t tonic, minor;
+        ASSERT_EQ(abc_key_parse(sheets[i].key, &tonic, &minor), 0);
+        ASSERT_EQ(keys[i].tonic, tonic);
+        ASSERT_EQ(keys[i].minor, minor);
+        ASSERT(keys[i].correlation > 0.7f && keys[i].margin > 0.0f);
+    }
+    ASSERT(strcmp(abc_key_name(keys[0].tonic, keys[0].minor), "G") == 0);
+    ASSERT(strcmp(abc_key_name(keys[1].tonic, keys[1].minor), "Am") == 0);
+
+    // K: spellings
+    uint8_t tonic, minor;
+    ASSERT(abc_key_parse("F#", &tonic, &minor) == 0 && tonic == 6 && minor == 0);
+    ASSERT(abc_key_parse("Bbm", &tonic, &minor) == 0 && tonic == 10 && minor == 1);
+    ASSERT(abc_key_parse("E dor", &tonic, &minor) == 0 && tonic == 4 && minor == 1);
+    ASSERT(abc_key_parse("Dmix", &tonic, &minor) == 0 && tonic == 2 && minor == 0);
+    ASSERT_EQ(abc_key_parse("HP", &tonic, &minor), -1);
+
+    uint32_t empty[12] = { 0 };
+    ASSERT_EQ(abc_estimate_key(empty, &keys[0]), -1);
+    return 1;
+}
+
 // ============================================================================
 // Main
 // ============================================================================
@@ -942,6 +3149,124 @@ int main(void) {
     RUN_TEST(voice_without_key);
     RUN_TEST(voice_inline_whitespace);
 
+    printf("\nBinary Image Tests:\n");
+    RUN_TEST(image_roundtrip);
+    RUN_TEST(image_rejects_corruption);
+
+    printf("\nBuild-time Embedding Tests:\n");
+    RUN_TEST(embedded_matches_runtime_parse);
+
+    printf("\nMeasure Tests:\n");
+    RUN_TEST(measure_matches_parse);
+    RUN_TEST(measure_sizes_pools_exactly);
+    RUN_TEST(measure_null_input);
+
+    printf("\nAllocator Tests:\n");
+    RUN_TEST(pool_grows_through_allocator);
+    RUN_TEST(arena_serves_many_sheets);
+
+    printf("\nSheet Store Tests:\n");
+    RUN_TEST(store_add_and_view);
+    RUN_TEST(store_remove_and_compact);
+    RUN_TEST(store_compacts_when_full);
+
+    printf("\nParse Cache Tests:\n");
+    RUN_TEST(cache_hit_copies_result);
+    RUN_TEST(cache_evicts_lru_under_budget);
+    RUN_TEST(cache_acquire_pins_entry);
+    RUN_TEST(cache_compares_input_text);
+
+    printf("\nIncremental Editing Tests:\n");
+    RUN_TEST(editor_edit_matches_full_parse);
+    RUN_TEST(editor_reparses_locally);
+    RUN_TEST(editor_falls_back_to_full_parse);
+
+    printf("\nEvent Mode Tests:\n");
+    RUN_TEST(events_resolve_pitches);
+    RUN_TEST(events_match_parse);
+    RUN_TEST(events_report_repeats);
+
+    printf("\nCursor Tests:\n");
+    RUN_TEST(cursor_matches_parse);
+    RUN_TEST(cursor_parses_on_demand);
+    RUN_TEST(cursor_invalid_and_missing_voice);
+
+    printf("\nStep Parsing Tests:\n");
+    RUN_TEST(step_matches_parse);
+    RUN_TEST(step_bounds_work);
+    RUN_TEST(step_errors);
+
+    printf("\nPublication Tests:\n");
+    RUN_TEST(reader_follows_step_parse);
+    RUN_TEST(reader_after_full_parse);
+    RUN_TEST(publication_rejects_movable_pools);
+
+    printf("\nSequencer Tests:\n");
+    RUN_TEST(sequencer_fires_events_in_order);
+    RUN_TEST(sequencer_lookahead_and_tempo);
+    RUN_TEST(sequencer_loop_pause_seek);
+
+    printf("\nPolyphony Tests:\n");
+    RUN_TEST(poly_allocates_without_stealing);
+    RUN_TEST(poly_steal_rules);
+    RUN_TEST(poly_sizing_and_errors);
+
+    printf("\nArpeggio Tests:\n");
+    RUN_TEST(arpeggio_expands_chords);
+    RUN_TEST(arpeggio_events_and_limits);
+
+    printf("\nPool Transform Tests:\n");
+    RUN_TEST(transpose_clamps_and_folds);
+    RUN_TEST(scale_durations_keeps_totals_exact);
+    RUN_TEST(transforms_follow_edited_list);
+    RUN_TEST(transforms_reject_read_only_pools);
+
+    printf("\nCorpus Generator Tests:\n");
+    RUN_TEST(corpus_is_deterministic);
+    RUN_TEST(corpus_tunes_parse);
+
+    printf("\nParse Statistics Tests:\n");
+    RUN_TEST(parse_stats_counts_work);
+    RUN_TEST(parse_stats_match_plain_parse);
+    RUN_TEST(parse_stats_report_full_pools);
+
+    printf("\nTrace Tests:\n");
+    RUN_TEST(trace_accounts_nested_phases);
+#if ABC_TRACE
+    RUN_TEST(trace_hooks_time_parse);
+#endif
+
+    printf("\nAdversarial Input Tests:\n");
+    RUN_TEST(zero_denominator_is_safe);
+    RUN_TEST(long_numbers_saturate);
+
+    printf("\nHeader Scan Tests:\n");
+    RUN_TEST(scan_header_returns_spans);
+    RUN_TEST(scan_header_lists_voices);
+    RUN_TEST(scan_header_truncates_voice_list);
+
+    printf("\nSongbook Index Tests:\n");
+    RUN_TEST(index_scan_splits_collection);
+    RUN_TEST(index_write_open_find);
+    RUN_TEST(index_parse_at_offset);
+
+    printf("\nMelody Search Tests:\n");
+    RUN_TEST(search_melody_skips_rests_and_takes_top_note);
+    RUN_TEST(search_finds_transposed_fragment);
+    RUN_TEST(search_passes_must_match);
+
+    printf("\nFingerprint Tests:\n");
+    RUN_TEST(fingerprint_ignores_key_and_tempo);
+    RUN_TEST(fingerprint_variants_are_similar);
+    RUN_TEST(fingerprint_cluster_groups_duplicates);
+    RUN_TEST(fingerprint_cluster_compares_whole_bucket);
+    RUN_TEST(fingerprint_cluster_large_bucket);
+
+    printf("\nAnalysis Tests:\n");
+    RUN_TEST(analysis_pitch_stats);
+    RUN_TEST(analysis_note_density);
+    RUN_TEST(analysis_estimates_key);
+
     printf("\n=====================\n");
     printf("Results: %d/%d tests passed\n", tests_passed, tests_run);
 